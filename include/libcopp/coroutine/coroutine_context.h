@@ -6,6 +6,17 @@
 
 #include "coroutine_context_base.h"
 
+#include "libcopp/utils/gsl/span.h"
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <memory>
+#include <type_traits>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
 #ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
 #  define COROUTINE_CONTEXT_BASE_USING_BASE_SEGMENTED_STACKS(base_type) using base_type::caller_stack_;
 #else
@@ -56,8 +67,9 @@ class coroutine_context : public coroutine_context_base {
   friend struct libcopp_internal_api_set;
 
  protected:
-  fcontext::fcontext_t caller_; /** caller runtime context **/
-  fcontext::fcontext_t callee_; /** callee runtime context **/
+  // caller_ and callee_ are stored in coroutine_context_base to keep all hot switch state in one cache line
+  using coroutine_context_base::callee_; /** callee runtime context **/
+  using coroutine_context_base::caller_; /** caller runtime context **/
 
   stack_context callee_stack_; /** callee stack context **/
 #ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
@@ -133,12 +145,129 @@ class coroutine_context : public coroutine_context_base {
   LIBCOPP_COPP_API int resume(std::exception_ptr &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT;
 #endif
 
+  /**
+   * @brief resume a batch of coroutines one by one
+   * @note the current coroutine and the caller state are resolved only once for the whole batch, and the header and
+   *       the saved context of the next coroutine are prefetched while the current one is running
+   * @param contexts coroutines to resume, nullptr will get COPP_EC_ARGS_ERROR
+   * @param ret_codes return codes of each coroutine, only the first min(contexts.size(), ret_codes.size()) ones are
+   *        resumed
+   * @param priv_data private data, will be passed to runner operator() or return to yield
+   * @exception if exception is enabled, it will throw the first unhandled exception after the whole batch resumed
+   * @return count of coroutines resumed successfully
+   */
+  static LIBCOPP_COPP_API size_t resume_batch(gsl::span<coroutine_context *const> contexts, gsl::span<int> ret_codes,
+                                              void *priv_data = nullptr);
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  /**
+   * @brief resume a batch of coroutines one by one
+   * @see resume_batch
+   * @param unhandled set exception_ptr of unhandled exception of each coroutine if it's exists, if it has only one
+   *        element, the first unhandled exception will be kept, otherwise the exceptions out of range will be dropped
+   * @param contexts coroutines to resume, nullptr will get COPP_EC_ARGS_ERROR
+   * @param ret_codes return codes of each coroutine
+   * @param priv_data private data, will be passed to runner operator() or return to yield
+   * @return count of coroutines resumed successfully
+   */
+  static LIBCOPP_COPP_API size_t resume_batch(gsl::span<std::exception_ptr> unhandled,
+                                              gsl::span<coroutine_context *const> contexts, gsl::span<int> ret_codes,
+                                              void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT;
+#endif
+
+  /**
+   * @brief resume coroutine and receive the data passed to yield_transfer(yield_data, ...)
+   * @param priv_data private data, will be passed to runner operator() or return to yield
+   * @param yield_data if not nullptr, will get the yield_data of yield_transfer(...), or nullptr if the coroutine is
+   *        yielded by yield(...) or finished
+   * @exception if exception is enabled, it will throw all unhandled exception after resumed
+   * @return COPP_EC_SUCCESS or error code
+   */
+  LIBCOPP_COPP_API int resume_transfer(void *priv_data, void **yield_data);
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  /**
+   * @brief resume coroutine and receive the data passed to yield_transfer(yield_data, ...)
+   * @param unhandled set exception_ptr of unhandled exception if it's exists
+   * @param priv_data private data, will be passed to runner operator() or return to yield
+   * @param yield_data if not nullptr, will get the yield_data of yield_transfer(...)
+   * @return COPP_EC_SUCCESS or error code
+   */
+  LIBCOPP_COPP_API int resume_transfer(std::exception_ptr &unhandled, void *priv_data,
+                                       void **yield_data) LIBCOPP_MACRO_NOEXCEPT;
+#endif
+
   /**
    * @brief yield coroutine
    * @param priv_data private data, if not nullptr, will get the value from start(priv_data) or resume(priv_data)
    * @return COPP_EC_SUCCESS or error code
    */
   LIBCOPP_COPP_API int yield(void **priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief yield coroutine and pass data to the caller of resume_transfer(...)
+   * @param yield_data data passed to the caller
+   * @param priv_data private data, if not nullptr, will get the value from start(priv_data) or resume(priv_data)
+   * @return COPP_EC_SUCCESS or error code
+   */
+  LIBCOPP_COPP_API int yield_transfer(void *yield_data, void **priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief resume coroutine with a typed value, the value is never copied
+   * @note the coroutine get the address of value from yield_receive<TSend>() or yield_with(...), and it's only
+   *       available before the coroutine yield again, so it should be moved if the coroutine want to keep it.
+   * @param value value passed to coroutine
+   * @param yield_value if not nullptr, will get the address of value passed to yield_with(...), which is available
+   *        until the coroutine is resumed again
+   * @exception if exception is enabled, it will throw all unhandled exception after resumed
+   * @return COPP_EC_SUCCESS or error code
+   */
+  template <typename TRecv = void, typename TSend>
+  LIBCOPP_COPP_API_HEAD_ONLY int resume_with(TSend &&value, TRecv **yield_value = nullptr) {
+    void *recv = nullptr;
+    int ret = resume_transfer(get_transfer_address(value), nullptr == yield_value ? nullptr : &recv);
+    if (nullptr != yield_value) {
+      *yield_value = static_cast<TRecv *>(recv);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief yield coroutine with a typed value, the value is never copied
+   * @note the caller get the address of value from resume_with(...) or resume_transfer(...), and it's only available
+   *       before the coroutine is resumed again.
+   * @param value value passed to the caller
+   * @param resume_value if not nullptr, will get the address of value passed to resume_with(...) when resumed
+   * @return COPP_EC_SUCCESS or error code
+   */
+  template <typename TRecv = void, typename TSend>
+  LIBCOPP_COPP_API_HEAD_ONLY int yield_with(TSend &&value, TRecv **resume_value = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    void *recv = nullptr;
+    int ret = yield_transfer(get_transfer_address(value), nullptr == resume_value ? nullptr : &recv);
+    if (nullptr != resume_value) {
+      *resume_value = static_cast<TRecv *>(recv);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief yield coroutine and get the value passed by resume_with(...)
+   * @return address of value passed to resume_with(...), or nullptr if it's resumed without data or failed to yield
+   */
+  template <typename TRecv>
+  LIBCOPP_COPP_API_HEAD_ONLY TRecv *yield_receive() LIBCOPP_MACRO_NOEXCEPT {
+    void *recv = nullptr;
+    if (COPP_EC_SUCCESS != yield(&recv)) {
+      return nullptr;
+    }
+    return static_cast<TRecv *>(recv);
+  }
+
+ private:
+  template <typename TValue>
+  UTIL_FORCEINLINE static void *get_transfer_address(TValue &value) LIBCOPP_MACRO_NOEXCEPT {
+    return const_cast<void *>(static_cast<const volatile void *>(std::addressof(value)));
+  }
 };
 
 namespace this_coroutine {
@@ -166,5 +295,35 @@ LIBCOPP_COPP_API_HEAD_ONLY Tc *get() {
  * @return 0 or error code
  */
 LIBCOPP_COPP_API int yield(void **priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT;
+
+/**
+ * @brief yield current coroutine with a typed value
+ * @see coroutine_context::yield_with
+ * @return 0 or error code
+ */
+template <typename TRecv = void, typename TSend>
+LIBCOPP_COPP_API_HEAD_ONLY int yield_with(TSend &&value, TRecv **resume_value = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+  coroutine_context *pco = get_coroutine();
+  COPP_LIKELY_IF (nullptr != pco) {
+    return pco->yield_with(std::forward<TSend>(value), resume_value);
+  }
+
+  return COPP_EC_NOT_RUNNING;
+}
+
+/**
+ * @brief yield current coroutine and get the value passed by resume_with(...)
+ * @see coroutine_context::yield_receive
+ * @return address of value passed to resume_with(...), or nullptr if it's resumed without data or not in coroutine
+ */
+template <typename TRecv>
+LIBCOPP_COPP_API_HEAD_ONLY TRecv *yield_receive() LIBCOPP_MACRO_NOEXCEPT {
+  coroutine_context *pco = get_coroutine();
+  COPP_LIKELY_IF (nullptr != pco) {
+    return pco->yield_receive<TRecv>();
+  }
+
+  return nullptr;
+}
 }  // namespace this_coroutine
 LIBCOPP_COPP_NAMESPACE_END
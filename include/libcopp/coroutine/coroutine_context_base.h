@@ -14,11 +14,25 @@
 #include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
 // clang-format on
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
 #  include <exception>
 #endif
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+#  include <stdint.h>
+#  if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64))
+#    include <intrin.h>
+#  elif !(defined(__GNUC__) || defined(__clang__)) || \
+      !(defined(__i386__) || defined(__x86_64__) || defined(__aarch64__))
+#    if defined(LIBCOPP_MACRO_SYS_POSIX) && LIBCOPP_MACRO_SYS_POSIX
+#      include <time.h>
+#    else
+#      include <chrono>
+#    endif
+#  endif
+#endif
 // clang-format off
 #include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
 // clang-format on
@@ -60,6 +74,11 @@ struct LIBCOPP_COPP_API_HEAD_ONLY align_helper {
 #define COROUTINE_CONTEXT_STACK_ALIGN_UNIT_SIZE \
   LIBCOPP_COPP_NAMESPACE_ID::details::align_helper<COROUTINE_CONTEXT_BASE_ALIGN_UNIT_SIZE, 64>::value
 
+// Most of the mainstream architectures use 64 bytes cache line, the object of coroutine context will be aligned to it
+#ifndef COROUTINE_CONTEXT_CACHE_LINE_SIZE
+#  define COROUTINE_CONTEXT_CACHE_LINE_SIZE 64
+#endif
+
 static_assert(COROUTINE_CONTEXT_BASE_ALIGN_UNIT_SIZE >= 16 && 0 == COROUTINE_CONTEXT_BASE_ALIGN_UNIT_SIZE % 16,
               "COROUTINE_CONTEXT_BASE_ALIGN_UNIT_SIZE");
 static_assert(COROUTINE_CONTEXT_STACK_ALIGN_UNIT_SIZE >= 16 && 0 == COROUTINE_CONTEXT_STACK_ALIGN_UNIT_SIZE % 16,
@@ -100,24 +119,71 @@ class coroutine_context_base {
   using status_t = status_type;
   using flag_t = flag_type;
 
- protected:
-  int runner_ret_code_;  /** coroutine return code **/
-  int flags_;            /** flags **/
-  callback_type runner_; /** coroutine runner **/
-  void *priv_data_;
-  size_t private_buffer_size_;
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  /**
+   * @brief hook function of switching
+   * @param from coroutine switched from, nullptr if it's not in a coroutine
+   * @param to coroutine switched to, nullptr if it's not in a coroutine
+   * @param user_data user_data of switch_hook_type
+   */
+  using switch_hook_fn_type = void (*)(coroutine_context_base *from, coroutine_context_base *to, void *user_data);
 
+  /**
+   * @brief thread-local hooks of switching
+   * @note on_switch_in is called by the caller just before jumping into a coroutine
+   * @note on_switch_out is called after a coroutine yield or finished, in the caller and before the caller continue
+   */
+  struct LIBCOPP_COPP_API_HEAD_ONLY switch_hook_type {
+    switch_hook_fn_type on_switch_in;
+    switch_hook_fn_type on_switch_out;
+    void *user_data;
+  };
+#endif
+
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  /**
+   * @brief run time and switch accounting of coroutine context
+   * @note ticks are got from get_accounting_tick(), it's CPU cycles when rdtsc or cntvct_el0 is available, or
+   *       nanoseconds of monotonic clock
+   * @note time spent in coroutines resumed by this one is not counted into this one
+   */
+  struct LIBCOPP_COPP_API_HEAD_ONLY accounting_type {
+    uint64_t run_ticks;         /** total ticks of running **/
+    uint64_t longest_run_ticks; /** longest ticks of uninterrupted running **/
+    uint64_t switch_in_count;   /** how many times switched into this coroutine **/
+    uint64_t switch_out_count;  /** how many times switched out from this coroutine **/
+    uint64_t last_switch_in;    /** tick of last switching in, 0 when not running **/
+  };
+#endif
+
+ protected:
+  // Hot switch state, keep them at the beginning and in one cache line.
+  // The object of coroutine context is aligned to COROUTINE_CONTEXT_CACHE_LINE_SIZE by the containers.
 #if defined(LIBCOPP_DISABLE_ATOMIC_LOCK) && LIBCOPP_DISABLE_ATOMIC_LOCK
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<int> >
       status_; /** status **/
 #else
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<int> status_; /** status **/
 #endif
+  int flags_;    /** flags **/
+  void *caller_; /** caller runtime context, fcontext_t or fiber handle **/
+  void *callee_; /** callee runtime context, fcontext_t or fiber handle **/
+
+  void *priv_data_;
+  size_t private_buffer_size_;
+  int runner_ret_code_; /** coroutine return code **/
+
+  // Cold fields
+  callback_type runner_; /** coroutine runner **/
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   std::exception_ptr unhandle_exception_;
 #endif
 
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  accounting_type accounting_;
+#endif
+
  protected:
   LIBCOPP_COPP_API coroutine_context_base() LIBCOPP_MACRO_NOEXCEPT;
 
@@ -232,6 +298,108 @@ class coroutine_context_base {
     return sz;
   }
 
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  /**
+   * @brief get run time and switch accounting
+   */
+  UTIL_FORCEINLINE const accounting_type &get_accounting() const LIBCOPP_MACRO_NOEXCEPT { return accounting_; }
+
+  /**
+   * @brief reset run time and switch accounting, the current running slice will be kept
+   */
+  UTIL_FORCEINLINE void reset_accounting() LIBCOPP_MACRO_NOEXCEPT {
+    uint64_t last_switch_in = accounting_.last_switch_in;
+    accounting_ = accounting_type();
+    accounting_.last_switch_in = last_switch_in;
+  }
+
+  /**
+   * @brief get tick used by accounting
+   * @return CPU cycles if rdtsc or cntvct_el0 is available, or nanoseconds of monotonic clock
+   */
+  UTIL_FORCEINLINE static uint64_t get_accounting_tick() LIBCOPP_MACRO_NOEXCEPT {
+#  if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64))
+    return static_cast<uint64_t>(__rdtsc());
+#  elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+    return static_cast<uint64_t>(__builtin_ia32_rdtsc());
+#  elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    uint64_t ret;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ret));
+    return ret;
+#  elif defined(LIBCOPP_MACRO_SYS_POSIX) && LIBCOPP_MACRO_SYS_POSIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#  else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#  endif
+  }
+
+ protected:
+  /**
+   * @brief accounting before the caller jump into to_co
+   * @param from_co caller coroutine, nullptr if it's not in a coroutine
+   * @param to_co coroutine to be resumed
+   */
+  UTIL_FORCEINLINE static void accounting_before_resume(coroutine_context_base *from_co,
+                                                        coroutine_context_base &to_co) LIBCOPP_MACRO_NOEXCEPT {
+    uint64_t now = get_accounting_tick();
+    if (nullptr != from_co) {
+      from_co->accounting_switch_out(now);
+    }
+    to_co.accounting_switch_in(now);
+  }
+
+  /**
+   * @brief accounting after to_co yield or finished and jump back to the caller
+   * @param from_co caller coroutine, nullptr if it's not in a coroutine
+   * @param to_co coroutine which is just switched out
+   */
+  UTIL_FORCEINLINE static void accounting_after_resume(coroutine_context_base *from_co,
+                                                       coroutine_context_base &to_co) LIBCOPP_MACRO_NOEXCEPT {
+    uint64_t now = get_accounting_tick();
+    to_co.accounting_switch_out(now);
+    if (nullptr != from_co) {
+      from_co->accounting_switch_in(now);
+    }
+  }
+
+ private:
+  UTIL_FORCEINLINE void accounting_switch_in(uint64_t now) LIBCOPP_MACRO_NOEXCEPT {
+    ++accounting_.switch_in_count;
+    accounting_.last_switch_in = now;
+  }
+
+  UTIL_FORCEINLINE void accounting_switch_out(uint64_t now) LIBCOPP_MACRO_NOEXCEPT {
+    COPP_UNLIKELY_IF (0 == accounting_.last_switch_in) {
+      return;
+    }
+
+    // tick of some clock may be not synchronized between CPU cores
+    uint64_t run_ticks = now > accounting_.last_switch_in ? now - accounting_.last_switch_in : 0;
+    ++accounting_.switch_out_count;
+    accounting_.last_switch_in = 0;
+    accounting_.run_ticks += run_ticks;
+    if (run_ticks > accounting_.longest_run_ticks) {
+      accounting_.longest_run_ticks = run_ticks;
+    }
+  }
+
+ public:
+#endif
+
+  /**
+   * @brief align address of coroutine context object down to cache line
+   * @note containers should reserve COROUTINE_CONTEXT_CACHE_LINE_SIZE more bytes for this padding
+   */
+  static inline unsigned char *align_cache_line_address(unsigned char *addr) {
+    constexpr const uintptr_t align_mask = COROUTINE_CONTEXT_CACHE_LINE_SIZE - 1;
+
+    return reinterpret_cast<unsigned char *>(reinterpret_cast<uintptr_t>(addr) & ~align_mask);
+  }
+
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   static inline void maybe_rethrow(std::exception_ptr &inout) {
     COPP_UNLIKELY_IF (inout) {
@@ -257,5 +425,48 @@ class coroutine_context_base {
    * @param ctx pointer of current coroutine, if not in coroutine, set nullptr
    */
   static LIBCOPP_COPP_API void set_this_coroutine_base(coroutine_context_base *ctx) LIBCOPP_MACRO_NOEXCEPT;
+
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  /**
+   * @brief set switch hooks of current thread
+   * @param hook hooks, it must be available until it's replaced, nullptr to remove hooks
+   * @return previous hooks of current thread
+   */
+  static LIBCOPP_COPP_API const switch_hook_type *set_switch_hook(const switch_hook_type *hook) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief get switch hooks of current thread
+   * @return hooks of current thread or nullptr
+   */
+  static LIBCOPP_COPP_API const switch_hook_type *get_switch_hook() LIBCOPP_MACRO_NOEXCEPT;
+
+ protected:
+  UTIL_FORCEINLINE static void invoke_switch_in_hook(const switch_hook_type *hook, coroutine_context_base *from,
+                                                     coroutine_context_base *to) {
+    COPP_UNLIKELY_IF (nullptr != hook && nullptr != hook->on_switch_in) {
+      hook->on_switch_in(from, to, hook->user_data);
+    }
+  }
+
+  UTIL_FORCEINLINE static void invoke_switch_out_hook(const switch_hook_type *hook, coroutine_context_base *from,
+                                                      coroutine_context_base *to) {
+    COPP_UNLIKELY_IF (nullptr != hook && nullptr != hook->on_switch_out) {
+      hook->on_switch_out(from, to, hook->user_data);
+    }
+  }
+#endif
 };
+
+// Size budget of coroutine context header, the hot switch state is in the first cache line and other fields should not
+// take more than one more cache line besides the runner.
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+static_assert(sizeof(coroutine_context_base) <= COROUTINE_CONTEXT_CACHE_LINE_SIZE +
+                                                     sizeof(coroutine_context_base::callback_type) +
+                                                     2 * sizeof(void *) + sizeof(coroutine_context_base::accounting_type),
+              "size budget of coroutine_context_base");
+#else
+static_assert(sizeof(coroutine_context_base) <= COROUTINE_CONTEXT_CACHE_LINE_SIZE +
+                                                     sizeof(coroutine_context_base::callback_type) + 2 * sizeof(void *),
+              "size budget of coroutine_context_base");
+#endif
 LIBCOPP_COPP_NAMESPACE_END
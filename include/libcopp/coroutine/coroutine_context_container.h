@@ -8,11 +8,13 @@
 #include <libcopp/stack/stack_allocator.h>
 #include <libcopp/stack/stack_traits.h>
 #include <libcopp/utils/errno.h>
+#include <libcopp/utils/gsl/span.h>
 
 // clang-format off
 #include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
 // clang-format on
 #include <cstddef>
+#include <vector>
 // clang-format off
 #include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
 // clang-format on
@@ -70,46 +72,60 @@ class coroutine_context_container : public coroutine_context {
    */
   static ptr_type create(callback_type &&runner, allocator_type &alloc, size_t stack_sz = 0,
                          size_t private_buffer_size = 0, size_t coroutine_size = 0) LIBCOPP_MACRO_NOEXCEPT {
-    ptr_type ret;
     if (0 == stack_sz) {
       stack_sz = stack_traits::default_size();
     }
 
-    // padding to sizeof size_t
-    coroutine_size = align_address_size(coroutine_size);
-    const size_t this_align_size = align_address_size(sizeof(this_type));
-    coroutine_size += this_align_size;
-    private_buffer_size = coroutine_context::align_private_data_size(private_buffer_size);
-
-    if (stack_sz <= coroutine_size + private_buffer_size) {
-      return ret;
+    if (stack_sz <= get_reserved_size(private_buffer_size, coroutine_size)) {
+      return ptr_type();
     }
 
     stack_context callee_stack;
     alloc.allocate(callee_stack, stack_sz);
 
-    if (nullptr == callee_stack.sp) {
-      return ret;
+    return create_with_stack(std::move(runner), alloc, callee_stack, private_buffer_size, coroutine_size);
+  }
+
+  /**
+   * @brief create a batch of coroutines without runner, and the runner can be set by set_runner(...) later
+   * @note stacks are allocated at once if allocator has allocate(gsl::span<stack_context>, size_t)
+   * @param output created coroutines, at most output.size() coroutines are created
+   * @param alloc stack allocator, every coroutine has a copy of it
+   * @param stack_sz stack size
+   * @param private_buffer_size private buffer size
+   * @param coroutine_size extend buffer before coroutine
+   * @return count of coroutines created, they are at the front of output
+   */
+  static size_t create_many(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<ptr_type> output, const allocator_type &alloc,
+                            size_t stack_sz = 0, size_t private_buffer_size = 0,
+                            size_t coroutine_size = 0) LIBCOPP_MACRO_NOEXCEPT {
+    if (0 == stack_sz) {
+      stack_sz = stack_traits::default_size();
     }
 
-    // placement new
-    unsigned char *this_addr = reinterpret_cast<unsigned char *>(callee_stack.sp);
-    // stack down
-    this_addr -= private_buffer_size + this_align_size;
-    ret.reset(new (reinterpret_cast<void *>(this_addr)) this_type(std::move(alloc)));
+    if (output.empty() || stack_sz <= get_reserved_size(private_buffer_size, coroutine_size)) {
+      return 0;
+    }
 
-    // callee_stack and alloc unavailable any more.
-    if (ret) {
-      ret->callee_stack_ = std::move(callee_stack);
-    } else {
-      alloc.deallocate(callee_stack);
-      return ret;
+    allocator_type batch_alloc(alloc);
+    std::vector<stack_context> stacks;
+    stacks.resize(output.size());
+    size_t stack_count = allocate_stacks(
+        batch_alloc, LIBCOPP_COPP_NAMESPACE_ID::gsl::span<stack_context>(stacks.data(), stacks.size()), stack_sz, 0);
+
+    size_t ret = 0;
+    for (; ret < stack_count; ++ret) {
+      allocator_type coroutine_alloc(alloc);
+      output[ret] =
+          create_with_stack(callback_type(), coroutine_alloc, stacks[ret], private_buffer_size, coroutine_size);
+      if (!output[ret]) {
+        break;
+      }
     }
 
-    // after this call runner will be unavailable
-    if (coroutine_context::create(ret.get(), std::move(runner), ret->callee_stack_, coroutine_size,
-                                  private_buffer_size) < 0) {
-      ret.reset();
+    // recycle stacks not used, the failed one is already recycled
+    for (size_t i = ret + 1; i < stack_count; ++i) {
+      batch_alloc.deallocate(stacks[i]);
     }
 
     return ret;
@@ -158,6 +174,76 @@ class coroutine_context_container : public coroutine_context {
  private:
   coroutine_context_container(const coroutine_context_container &) = delete;
 
+  static inline size_t get_reserved_size(size_t private_buffer_size, size_t coroutine_size) LIBCOPP_MACRO_NOEXCEPT {
+    return align_address_size(coroutine_size) + align_address_size(sizeof(this_type)) +
+           COROUTINE_CONTEXT_CACHE_LINE_SIZE + coroutine_context::align_private_data_size(private_buffer_size);
+  }
+
+  // allocator with batch allocation
+  template <typename TALLOCATOR>
+  static inline auto allocate_stacks(TALLOCATOR &alloc, LIBCOPP_COPP_NAMESPACE_ID::gsl::span<stack_context> ctxs,
+                                     size_t stack_sz, int) LIBCOPP_MACRO_NOEXCEPT
+      -> decltype(static_cast<size_t>(alloc.allocate(ctxs, stack_sz))) {
+    return static_cast<size_t>(alloc.allocate(ctxs, stack_sz));
+  }
+
+  template <typename TALLOCATOR>
+  static inline size_t allocate_stacks(TALLOCATOR &alloc, LIBCOPP_COPP_NAMESPACE_ID::gsl::span<stack_context> ctxs,
+                                       size_t stack_sz, long) LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (; ret < ctxs.size(); ++ret) {
+      alloc.allocate(ctxs[ret], stack_sz);
+      if (nullptr == ctxs[ret].sp) {
+        break;
+      }
+    }
+    return ret;
+  }
+
+  // callee_stack is owned by coroutine, or deallocated if failed
+  static ptr_type create_with_stack(callback_type &&runner, allocator_type &alloc, stack_context &callee_stack,
+                                    size_t private_buffer_size, size_t coroutine_size) LIBCOPP_MACRO_NOEXCEPT {
+    ptr_type ret;
+    if (nullptr == callee_stack.sp) {
+      return ret;
+    }
+
+    if (callee_stack.size <= get_reserved_size(private_buffer_size, coroutine_size)) {
+      alloc.deallocate(callee_stack);
+      return ret;
+    }
+
+    // padding to sizeof size_t
+    coroutine_size = align_address_size(coroutine_size);
+    const size_t this_align_size = align_address_size(sizeof(this_type));
+    // reserve padding to align this object to cache line, so the hot switch state will not cross cache lines
+    coroutine_size += this_align_size + COROUTINE_CONTEXT_CACHE_LINE_SIZE;
+    private_buffer_size = coroutine_context::align_private_data_size(private_buffer_size);
+
+    // placement new
+    unsigned char *this_addr = reinterpret_cast<unsigned char *>(callee_stack.sp);
+    // stack down
+    this_addr -= private_buffer_size + this_align_size;
+    this_addr = align_cache_line_address(this_addr);
+    ret.reset(new (reinterpret_cast<void *>(this_addr)) this_type(std::move(alloc)));
+
+    // callee_stack and alloc unavailable any more.
+    if (ret) {
+      ret->callee_stack_ = std::move(callee_stack);
+    } else {
+      alloc.deallocate(callee_stack);
+      return ret;
+    }
+
+    // after this call runner will be unavailable
+    if (coroutine_context::create(ret.get(), std::move(runner), ret->callee_stack_, coroutine_size,
+                                  private_buffer_size) < 0) {
+      ret.reset();
+    }
+
+    return ret;
+  }
+
  private:
   friend void intrusive_ptr_add_ref(this_type *p) {
     if (p == nullptr) {
@@ -63,8 +63,9 @@ class coroutine_context_fiber : public coroutine_context_base {
   friend struct LIBCOPP_COPP_API_HEAD_ONLY fiber_context_tls_data_t;
 
  protected:
-  LPVOID caller_; /** caller runtime context **/
-  LPVOID callee_; /** callee runtime context **/
+  // caller_ and callee_ are stored in coroutine_context_base to keep all hot switch state in one cache line
+  using coroutine_context_base::callee_; /** callee runtime context **/
+  using coroutine_context_base::caller_; /** caller runtime context **/
 
   stack_context callee_stack_; /** callee stack context **/
 
@@ -8,6 +8,7 @@
 #include <libcopp/stack/stack_allocator.h>
 #include <libcopp/stack/stack_traits.h>
 #include <libcopp/utils/errno.h>
+#include <libcopp/utils/gsl/span.h>
 
 // clang-format off
 #include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
@@ -80,7 +81,8 @@ class coroutine_context_fiber_container : public coroutine_context_fiber {
     // padding to sizeof size_t
     coroutine_size = align_address_size(coroutine_size);
     const size_t this_align_size = align_address_size(sizeof(this_type));
-    coroutine_size += this_align_size;
+    // reserve padding to align this object to cache line, so the hot switch state will not cross cache lines
+    coroutine_size += this_align_size + COROUTINE_CONTEXT_CACHE_LINE_SIZE;
     private_buffer_size = coroutine_context_fiber::align_private_data_size(private_buffer_size);
 
     // stack allocator is just used for allocate coroutine and private data
@@ -95,6 +97,7 @@ class coroutine_context_fiber_container : public coroutine_context_fiber {
     unsigned char *this_addr = reinterpret_cast<unsigned char *>(callee_stack.sp);
     // stack down
     this_addr -= private_buffer_size + this_align_size;
+    this_addr = align_cache_line_address(this_addr);
     ret.reset(new (reinterpret_cast<void *>(this_addr)) this_type(std::move(alloc)));
 
     // callee_stack and alloc unavailable any more.
@@ -115,6 +118,31 @@ class coroutine_context_fiber_container : public coroutine_context_fiber {
     return ret;
   }
 
+  /**
+   * @brief create a batch of coroutines without runner, and the runner can be set by set_runner(...) later
+   * @note stacks of fiber are allocated by system, so they are created one by one
+   * @param output created coroutines, at most output.size() coroutines are created
+   * @param alloc stack allocator, every coroutine has a copy of it
+   * @param stack_sz stack size
+   * @param private_buffer_size private buffer size
+   * @param coroutine_size extend buffer before coroutine
+   * @return count of coroutines created, they are at the front of output
+   */
+  static size_t create_many(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<ptr_type> output, const allocator_type &alloc,
+                            size_t stack_sz = 0, size_t private_buffer_size = 0,
+                            size_t coroutine_size = 0) LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (; ret < output.size(); ++ret) {
+      allocator_type coroutine_alloc(alloc);
+      output[ret] = create(callback_type(), coroutine_alloc, stack_sz, private_buffer_size, coroutine_size);
+      if (!output[ret]) {
+        break;
+      }
+    }
+
+    return ret;
+  }
+
   template <class TRunner>
   static inline ptr_type create(TRunner *runner, allocator_type &alloc, size_t stack_size = 0,
                                 size_t private_buffer_size = 0, size_t coroutine_size = 0) LIBCOPP_MACRO_NOEXCEPT {
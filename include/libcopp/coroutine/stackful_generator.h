@@ -0,0 +1,216 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/coroutine/coroutine_context_container.h>
+#include <libcopp/stack/stack_allocator.h>
+#include <libcopp/utils/errno.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COPP_NAMESPACE_BEGIN
+
+/**
+ * @brief stackful generator based on coroutine_context
+ * @note values are passed by address with coroutine_context::yield_with(...), they are never copied or allocated.
+ *       The value referenced by iterator is only available before the generator is resumed again.
+ * @note usage:
+ *       stackful_generator<int> gen([](stackful_generator<int>::sink_type &sink) {
+ *         for (int i = 0; i < 3; ++i) sink(i);
+ *       });
+ *       for (int &v : gen) { ... }
+ */
+template <typename TVALUE, typename TALLOC = allocator::default_statck_allocator>
+class LIBCOPP_COPP_API_HEAD_ONLY stackful_generator {
+ public:
+  using value_type = TVALUE;
+  using allocator_type = TALLOC;
+  using self_type = stackful_generator<value_type, allocator_type>;
+  using coroutine_type = coroutine_context_container<allocator_type>;
+  using coroutine_ptr_type = typename coroutine_type::ptr_type;
+
+  /**
+   * @brief sink to yield values from generator body
+   */
+  class LIBCOPP_COPP_API_HEAD_ONLY sink_type {
+   public:
+    explicit sink_type(coroutine_context *co) LIBCOPP_MACRO_NOEXCEPT : coroutine_(co) {}
+
+    /**
+     * @brief yield a value to the reader of generator
+     * @note the address of value is passed to reader, so temporary values are also available until resumed
+     * @return COPP_EC_SUCCESS or error code
+     */
+    inline int operator()(value_type &value) LIBCOPP_MACRO_NOEXCEPT { return yield_value(value); }
+
+    inline int operator()(value_type &&value) LIBCOPP_MACRO_NOEXCEPT { return yield_value(value); }
+
+    inline int operator()(const value_type &value) {
+      // the reader can move from the value, so we must not pass the address of a const value
+      value_type copy_value(value);
+      return yield_value(copy_value);
+    }
+
+   private:
+    inline int yield_value(value_type &value) LIBCOPP_MACRO_NOEXCEPT {
+      if (nullptr == coroutine_) {
+        return COPP_EC_NOT_RUNNING;
+      }
+
+      return coroutine_->yield_with(value);
+    }
+
+   private:
+    coroutine_context *coroutine_;
+  };
+
+  class LIBCOPP_COPP_API_HEAD_ONLY iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = typename self_type::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+
+    iterator() LIBCOPP_MACRO_NOEXCEPT : owner_(nullptr) {}
+    explicit iterator(self_type *owner) LIBCOPP_MACRO_NOEXCEPT : owner_(owner) {}
+
+    inline reference operator*() const LIBCOPP_MACRO_NOEXCEPT { return *owner_->current_; }
+    inline pointer operator->() const LIBCOPP_MACRO_NOEXCEPT { return owner_->current_; }
+
+    inline iterator &operator++() {
+      if (nullptr != owner_) {
+        owner_->next();
+        if (nullptr == owner_->current_) {
+          owner_ = nullptr;
+        }
+      }
+      return *this;
+    }
+
+    inline void operator++(int) { ++(*this); }
+
+    friend inline bool operator==(const iterator &l, const iterator &r) LIBCOPP_MACRO_NOEXCEPT {
+      return l.owner_ == r.owner_;
+    }
+
+    friend inline bool operator!=(const iterator &l, const iterator &r) LIBCOPP_MACRO_NOEXCEPT {
+      return l.owner_ != r.owner_;
+    }
+
+   private:
+    self_type *owner_;
+  };
+
+ public:
+  template <typename TFN, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<TFN>::type, self_type>::value>::type>
+  explicit stackful_generator(TFN &&fn, size_t stack_size = 0) : current_(nullptr), started_(false) {
+    allocator_type alloc;
+    init(std::forward<TFN>(fn), alloc, stack_size);
+  }
+
+  template <typename TFN>
+  stackful_generator(TFN &&fn, allocator_type &alloc, size_t stack_size = 0) : current_(nullptr), started_(false) {
+    init(std::forward<TFN>(fn), alloc, stack_size);
+  }
+
+  stackful_generator(self_type &&other) LIBCOPP_MACRO_NOEXCEPT : coroutine_(std::move(other.coroutine_)),
+                                                                 current_(other.current_),
+                                                                 started_(other.started_) {
+    other.current_ = nullptr;
+  }
+
+  self_type &operator=(self_type &&other) LIBCOPP_MACRO_NOEXCEPT {
+    coroutine_ = std::move(other.coroutine_);
+    current_ = other.current_;
+    started_ = other.started_;
+    other.current_ = nullptr;
+    return *this;
+  }
+
+  /**
+   * @brief start the generator if it's not started and get the iterator of current value
+   * @exception if exception is enabled, it will throw the unhandled exception of generator body
+   */
+  inline iterator begin() {
+    if (!started_) {
+      next();
+    }
+
+    if (nullptr == current_) {
+      return iterator();
+    }
+    return iterator(this);
+  }
+
+  inline iterator end() LIBCOPP_MACRO_NOEXCEPT { return iterator(); }
+
+  /**
+   * @brief resume generator body to get next value
+   * @exception if exception is enabled, it will throw the unhandled exception of generator body
+   * @return COPP_EC_SUCCESS or error code
+   */
+  inline int next() {
+    current_ = nullptr;
+    if (!coroutine_) {
+      return COPP_EC_NOT_INITED;
+    }
+
+    started_ = true;
+    void *recv = nullptr;
+    int ret = coroutine_->resume_transfer(nullptr, &recv);
+    current_ = static_cast<value_type *>(recv);
+    return ret;
+  }
+
+  /**
+   * @brief get address of current value
+   * @return address of current value, nullptr if generator is not started or finished
+   */
+  inline value_type *get_current() const LIBCOPP_MACRO_NOEXCEPT { return current_; }
+
+  inline bool is_finished() const LIBCOPP_MACRO_NOEXCEPT { return !coroutine_ || coroutine_->is_finished(); }
+
+  inline const coroutine_ptr_type &get_coroutine_context() const LIBCOPP_MACRO_NOEXCEPT { return coroutine_; }
+
+ private:
+  stackful_generator(const stackful_generator &) = delete;
+  stackful_generator &operator=(const stackful_generator &) = delete;
+
+  template <typename TFN>
+  struct runner_type {
+    TFN fn;
+
+    int operator()(void *) {
+      sink_type sink(this_coroutine::get_coroutine());
+      fn(sink);
+      return COPP_EC_SUCCESS;
+    }
+  };
+
+  template <typename TFN>
+  void init(TFN &&fn, allocator_type &alloc, size_t stack_size) {
+    using fn_type = typename std::decay<TFN>::type;
+    coroutine_ = coroutine_type::create(
+        typename coroutine_type::callback_type(runner_type<fn_type>{std::forward<TFN>(fn)}), alloc, stack_size);
+  }
+
+ private:
+  coroutine_ptr_type coroutine_;
+  value_type *current_;
+  bool started_;
+};
+
+LIBCOPP_COPP_NAMESPACE_END
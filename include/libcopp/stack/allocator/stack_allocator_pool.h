@@ -5,6 +5,7 @@
 #include <libcopp/utils/config/libcopp_build_features.h>
 
 #include <libcopp/utils/features.h>
+#include <libcopp/utils/gsl/span.h>
 
 #include <assert.h>
 #include <cstddef>
@@ -57,6 +58,21 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_allocator_pool {
     }
   }
 
+  /**
+   * allocate a batch of stacks by one lock of pool
+   * @param ctxs stack contexts
+   * @param size ignored
+   * @return count of stacks allocated
+   */
+  size_t allocate(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<stack_context> ctxs, std::size_t) LIBCOPP_MACRO_NOEXCEPT {
+    assert(pool_);
+    if (pool_) {
+      return pool_->allocate(ctxs);
+    }
+
+    return 0;
+  }
+
   /**
    * deallocate memory from stack context [standard function]
    * @param ctx stack context
@@ -5,6 +5,7 @@
 #include <libcopp/utils/config/libcopp_build_features.h>
 
 #include <libcopp/utils/features.h>
+#include <libcopp/utils/gsl/span.h>
 #include <libcopp/utils/lock_holder.h>
 #include <libcopp/utils/spin_lock.h>
 
@@ -16,13 +17,20 @@
 // clang-format on
 #include <assert.h>
 #include <cstring>
-#include <list>
 #include <memory>
+#include <new>
+#include <utility>
 // clang-format off
 #include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
 // clang-format on
 
 LIBCOPP_COPP_NAMESPACE_BEGIN
+/**
+ * @brief pool of stacks with the same size
+ * @note Free stacks are kept in an intrusive list whose nodes are stored at the top of the free stacks, so recycling a
+ *       stack never allocates memory. allocate(...) takes the most recently released stack, whose top is likely still
+ *       in cache, and gc() releases the oldest ones first.
+ */
 template <typename TAlloc>
 class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
  public:
@@ -54,13 +62,20 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
  private:
   struct constructor_delegator {};
 
+  // stored at the top of a free stack
+  struct free_node_type {
+    free_node_type *prev;
+    free_node_type *next;
+    stack_context stack;
+  };
+
   stack_pool() = delete;
   stack_pool(const stack_pool &) = delete;
 
  public:
   static ptr_type create() { return std::make_shared<stack_pool>(constructor_delegator()); }
 
-  stack_pool(constructor_delegator) {
+  stack_pool(constructor_delegator) : free_head_(nullptr), free_tail_(nullptr) {
     memset(&limits_, 0, sizeof(limits_));
     memset(&conf_, 0, sizeof(conf_));
     conf_.stack_size = LIBCOPP_COPP_NAMESPACE_ID::stack_traits::default_size();
@@ -119,61 +134,33 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
     LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
         action_lock_);
 #endif
-    // check limit
-    if (0 != conf_.max_stack_number && limits_.used_stack_number >= conf_.max_stack_number) {
-      ctx.sp = nullptr;
-      ctx.size = 0;
-      return;
-    }
-
-    if (0 != conf_.max_stack_size && limits_.used_stack_size + conf_.stack_size > conf_.max_stack_size) {
-      ctx.sp = nullptr;
-      ctx.size = 0;
-      return;
-    }
-
-    // get from pool, in order to max reuse cache, we use FILO to allocate stack
-    if (!free_list_.empty()) {
-      typename std::list<stack_context>::reverse_iterator iter = free_list_.rbegin();
-      assert(iter != free_list_.rend());
-
-      // free limit
-      COPP_LIKELY_IF (limits_.free_stack_number > 0) {
-        --limits_.free_stack_number;
-      } else {
-        limits_.free_stack_number = free_list_.size() - 1;
-      }
-
-      COPP_LIKELY_IF (limits_.free_stack_size >= (*iter).size) {
-        limits_.free_stack_size -= (*iter).size;
-      } else {
-        limits_.free_stack_size = 0;
-      }
-
-      // make sure the stack must be greater or equal than configure after reset
-      COPP_LIKELY_IF (iter->size >= conf_.stack_size) {
-        ctx = *iter;
-        free_list_.pop_back();
+    allocate_without_lock(ctx);
+  }
 
-        // used limit
-        ++limits_.used_stack_number;
-        limits_.used_stack_size += ctx.size;
-        return;
-      } else {
-        // just pop cache
-        free_list_.pop_back();
+  /**
+   * allocate a batch of stacks with only one lock
+   * @param ctxs stack contexts
+   * @return count of stacks allocated, stacks are allocated in order and the left ones are set to empty
+   */
+  size_t allocate(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<stack_context> ctxs) LIBCOPP_MACRO_NOEXCEPT {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+        action_lock_);
+#endif
+    size_t ret = 0;
+    for (; ret < ctxs.size(); ++ret) {
+      allocate_without_lock(ctxs[ret]);
+      if (nullptr == ctxs[ret].sp) {
+        break;
       }
     }
 
-    // get from origin allocator
-    alloc_.allocate(ctx, conf_.stack_size);
-    if (nullptr != ctx.sp && ctx.size > 0) {
-      // used limit
-      ++limits_.used_stack_number;
-      limits_.used_stack_size += ctx.size;
-
-      conf_.stack_offset = ctx.size - conf_.stack_size;
+    for (size_t i = ret; i < ctxs.size(); ++i) {
+      ctxs[i].sp = nullptr;
+      ctxs[i].size = 0;
     }
+
+    return ret;
   }
 
   /**
@@ -210,7 +197,7 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
       }
 
       // push to free list
-      free_list_.push_back(ctx);
+      push_free_back(ctx);
 
       // limits
       ++limits_.free_stack_number;
@@ -250,29 +237,24 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
     size_t keep_number = limits_.free_stack_number >> 1;
     size_t left_gc = conf_.gc_number;
     while (limits_.free_stack_size > keep_size || limits_.free_stack_number > keep_number) {
-      if (free_list_.empty()) {
+      stack_context stack;
+      if (!pop_free_front(stack)) {
         limits_.free_stack_size = 0;
         limits_.free_stack_number = 0;
         break;
       }
 
-      typename std::list<stack_context>::iterator iter = free_list_.begin();
-      assert(iter != free_list_.end());
-
       COPP_LIKELY_IF (limits_.free_stack_number > 0) {
         --limits_.free_stack_number;
-      } else {
-        limits_.free_stack_number = free_list_.size() - 1;
       }
 
-      COPP_LIKELY_IF (limits_.free_stack_size >= (*iter).size) {
-        limits_.free_stack_size -= (*iter).size;
+      COPP_LIKELY_IF (limits_.free_stack_size >= stack.size) {
+        limits_.free_stack_size -= stack.size;
       } else {
         limits_.free_stack_size = 0;
       }
 
-      alloc_.deallocate(*iter);
-      free_list_.pop_front();
+      alloc_.deallocate(stack);
       ++ret;
 
       // gc max stacks once
@@ -298,13 +280,126 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
     limits_.free_stack_size = 0;
     limits_.free_stack_number = 0;
 
-    for (typename std::list<stack_context>::iterator iter = free_list_.begin(); iter != free_list_.end(); ++iter) {
-      alloc_.deallocate(*iter);
+    stack_context stack;
+    while (pop_free_front(stack)) {
+      alloc_.deallocate(stack);
     }
 
     LIBCOPP_UTIL_LOCK_ATOMIC_THREAD_FENCE(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
   }
 
+ private:
+  void allocate_without_lock(stack_context &ctx) LIBCOPP_MACRO_NOEXCEPT {
+    // check limit
+    if (0 != conf_.max_stack_number && limits_.used_stack_number >= conf_.max_stack_number) {
+      ctx.sp = nullptr;
+      ctx.size = 0;
+      return;
+    }
+
+    if (0 != conf_.max_stack_size && limits_.used_stack_size + conf_.stack_size > conf_.max_stack_size) {
+      ctx.sp = nullptr;
+      ctx.size = 0;
+      return;
+    }
+
+    // get from pool, in order to max reuse cache, we use FILO to allocate stack
+    stack_context stack;
+    if (pop_free_back(stack)) {
+      // free limit
+      COPP_LIKELY_IF (limits_.free_stack_number > 0) {
+        --limits_.free_stack_number;
+      }
+
+      COPP_LIKELY_IF (limits_.free_stack_size >= stack.size) {
+        limits_.free_stack_size -= stack.size;
+      } else {
+        limits_.free_stack_size = 0;
+      }
+
+      // make sure the stack must be greater or equal than configure after reset
+      COPP_LIKELY_IF (stack.size >= conf_.stack_size) {
+        ctx = std::move(stack);
+
+        // used limit
+        ++limits_.used_stack_number;
+        limits_.used_stack_size += ctx.size;
+        return;
+      } else {
+        // just release cache
+        alloc_.deallocate(stack);
+      }
+    }
+
+    // get from origin allocator
+    alloc_.allocate(ctx, conf_.stack_size);
+    if (nullptr != ctx.sp && ctx.size > 0) {
+      // used limit
+      ++limits_.used_stack_number;
+      limits_.used_stack_size += ctx.size;
+
+      conf_.stack_offset = ctx.size - conf_.stack_size;
+    }
+  }
+
+  static inline free_node_type *get_free_node(const stack_context &ctx) LIBCOPP_MACRO_NOEXCEPT {
+    // stack down, the node is put at the same place as the coroutine context
+    size_t addr = reinterpret_cast<size_t>(ctx.sp) - sizeof(free_node_type);
+    addr &= ~(static_cast<size_t>(alignof(free_node_type)) - 1);
+    return reinterpret_cast<free_node_type *>(addr);
+  }
+
+  void push_free_back(stack_context &ctx) LIBCOPP_MACRO_NOEXCEPT {
+    free_node_type *node = new (get_free_node(ctx)) free_node_type();
+    node->stack = ctx;
+    node->prev = free_tail_;
+    node->next = nullptr;
+    if (nullptr == free_tail_) {
+      free_head_ = node;
+    } else {
+      free_tail_->next = node;
+    }
+    free_tail_ = node;
+  }
+
+  bool pop_free_back(stack_context &ctx) LIBCOPP_MACRO_NOEXCEPT {
+    free_node_type *node = free_tail_;
+    if (nullptr == node) {
+      return false;
+    }
+
+    free_tail_ = node->prev;
+    if (nullptr == free_tail_) {
+      free_head_ = nullptr;
+    } else {
+      free_tail_->next = nullptr;
+    }
+
+    // the node is in the stack, move it out before the stack is used or released
+    ctx = std::move(node->stack);
+    node->~free_node_type();
+    return true;
+  }
+
+  bool pop_free_front(stack_context &ctx) LIBCOPP_MACRO_NOEXCEPT {
+    free_node_type *node = free_head_;
+    if (nullptr == node) {
+      return false;
+    }
+
+    free_head_ = node->next;
+    if (nullptr == free_head_) {
+      free_tail_ = nullptr;
+    } else {
+      free_head_->prev = nullptr;
+    }
+
+    // the node is in the stack, move it out before the stack is used or released
+    ctx = std::move(node->stack);
+    node->~free_node_type();
+    return true;
+  }
+
  private:
   limit_t limits_;
   configure_t conf_;
@@ -312,6 +407,7 @@ class LIBCOPP_COPP_API_HEAD_ONLY stack_pool {
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock action_lock_;
 #endif
-  std::list<stack_context> free_list_;
+  free_node_type *free_head_;  // oldest free stack, released first by gc()
+  free_node_type *free_tail_;  // newest free stack, reused first by allocate(...)
 };
 LIBCOPP_COPP_NAMESPACE_END
@@ -30,6 +30,7 @@ enum copp_error_code {
   COPP_EC_ARGS_ERROR = -1010,              //!< COPP_EC_ARGS_ERROR
   COPP_EC_CAST_FAILED = -1011,             //!< COPP_EC_CAST_FAILED
   COPP_EC_HAS_UNHANDLE_EXCEPTION = -1012,  //!< COPP_EC_CAST_FAILED
+  COPP_EC_QUEUE_FULL = -1013,              //!< COPP_EC_QUEUE_FULL
 
   COPP_EC_FCONTEXT_MAKE_FAILED = -2001,                  //!< COPP_EC_FCONTEXT_MAKE_FAILED
   COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER = -2002,  //!< COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER
@@ -40,5 +41,6 @@ enum copp_error_code {
   COPP_EC_TASK_NOT_IN_ACTION = -3004,               //!< COPP_EC_TASK_NOT_IN_ACTION
   COPP_EC_TASK_ALREADY_IN_ANOTHER_MANAGER = -3005,  //!< COPP_EC_TASK_ALREADY_IN_ANOTHER_MANAGER
   COPP_EC_TASK_IS_KILLED = -3006,                   //!< COPP_EC_TASK_IS_KILLED
+  COPP_EC_TASK_DAG_HAS_CYCLE = -3007,               //!< COPP_EC_TASK_DAG_HAS_CYCLE
 };
 LIBCOPP_COPP_NAMESPACE_END
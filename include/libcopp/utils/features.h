@@ -119,6 +119,19 @@
 
 // ---------------- branch prediction information ----------------
 
+// ================ prefetch ================
+#if !defined(COPP_MACRO_PREFETCH)
+#  if defined(__clang__) || defined(__GNUC__)
+#    define COPP_MACRO_PREFETCH(addr) __builtin_prefetch(reinterpret_cast<const void *>(addr))
+#  elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64))
+#    include <intrin.h>
+#    define COPP_MACRO_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char *>(addr), _MM_HINT_T0)
+#  else
+#    define COPP_MACRO_PREFETCH(addr)
+#  endif
+#endif
+// ---------------- prefetch ----------------
+
 #if !defined(COPP_NORETURN_ATTR) && defined(__has_cpp_attribute)
 #  if __has_cpp_attribute(noreturn)
 #    define COPP_NORETURN_ATTR [[noreturn]]
@@ -0,0 +1,51 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <cstddef>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COPP_NAMESPACE_BEGIN
+namespace util {
+/**
+ * @brief id allocator which encode a reusable slot index into id
+ * @note id is GENERATION:32|INDEX:32, index is reused after deallocate(...) and generation is increased to make sure
+ *       the old id will not be equal to the new one. Index of all living ids are always less than the count of living
+ *       ids at peak plus the free indexes cached by threads, so it can be used as index of a dense array.
+ * @note Every thread caches a few released indexes, and allocate(...) and deallocate(...) only take the shared lock
+ *       when the cache is empty or full.
+ */
+class LIBCOPP_COPP_API uint64_slot_id_allocator {
+ public:
+  using value_type = uint64_t;
+
+  static constexpr const value_type npos = 0; /** invalid key **/
+  static constexpr const uint32_t index_bits = 32;
+
+  static value_type allocate() LIBCOPP_MACRO_NOEXCEPT;
+  static void deallocate(value_type) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief get count of slot indexes which are ever allocated
+   * @return all allocated index is less than this value
+   */
+  static size_t get_capacity() LIBCOPP_MACRO_NOEXCEPT;
+
+  static inline uint32_t get_index(value_type id) LIBCOPP_MACRO_NOEXCEPT {
+    return static_cast<uint32_t>(id & ((static_cast<value_type>(1) << index_bits) - 1));
+  }
+
+  static inline uint32_t get_generation(value_type id) LIBCOPP_MACRO_NOEXCEPT {
+    return static_cast<uint32_t>(id >> index_bits);
+  }
+};
+}  // namespace util
+LIBCOPP_COPP_NAMESPACE_END
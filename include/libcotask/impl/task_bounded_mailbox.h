@@ -0,0 +1,150 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * @brief bounded lock-free mailbox, any thread can push and pop
+ * @note It's the bounded MPMC queue of Dmitry Vyukov, every cell has a sequence number, so producers and consumers
+ *       only contend on their own position. Mailboxes of cores and remote resume queues of task_manager have
+ *       only one consumer, the owner thread.
+ * @see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+template <class T>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_bounded_mailbox {
+ private:
+  struct cell_type {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  // keep producer and consumer positions in different cache lines
+  enum { CACHE_LINE_SIZE = 64 };
+
+  struct position_type {
+    char padding[CACHE_LINE_SIZE];
+    std::atomic<size_t> value;
+  };
+
+ public:
+  using value_type = T;
+
+  /**
+   * @param capacity capacity of mailbox, it will be rounded up to the power of 2
+   */
+  explicit task_bounded_mailbox(size_t capacity = 1024) : mask_(0) {
+    enqueue_pos_.value.store(0, std::memory_order_relaxed);
+    dequeue_pos_.value.store(0, std::memory_order_relaxed);
+    size_t real_capacity = 2;
+    while (real_capacity < capacity) {
+      real_capacity <<= 1;
+    }
+
+    cells_.reset(new cell_type[real_capacity]);
+    for (size_t i = 0; i < real_capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = real_capacity - 1;
+  }
+
+  /**
+   * @brief push a value
+   * @return false if it's full
+   */
+  bool try_push(T &&value) {
+    cell_type *cell;
+    size_t pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (0 == diff) {
+        if (enqueue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief pop a value
+   * @return false if it's empty
+   */
+  bool try_pop(T &value) {
+    cell_type *cell;
+    size_t pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (0 == diff) {
+        if (dequeue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->data);
+    cell->data = T();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @return approximate size, it may be changed by other threads at any time
+   */
+  size_t size() const LIBCOPP_MACRO_NOEXCEPT {
+    size_t enqueue_pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+    size_t dequeue_pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+  inline bool empty() const LIBCOPP_MACRO_NOEXCEPT { return 0 == size(); }
+
+  inline size_t capacity() const LIBCOPP_MACRO_NOEXCEPT { return mask_ + 1; }
+
+ private:
+  task_bounded_mailbox(const task_bounded_mailbox &) = delete;
+  task_bounded_mailbox &operator=(const task_bounded_mailbox &) = delete;
+
+ private:
+  std::unique_ptr<cell_type[]> cells_;
+  size_t mask_;
+  position_type enqueue_pos_;
+  position_type dequeue_pos_;
+};
+
+}  // namespace detail
+
+LIBCOPP_COTASK_NAMESPACE_END
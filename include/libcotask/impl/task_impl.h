@@ -7,10 +7,12 @@
 #include <libcopp/utils/atomic_int_type.h>
 
 #include <libcopp/utils/uint64_id_allocator.h>
+#include <libcopp/utils/uint64_slot_id_allocator.h>
 
 #include <libcopp/utils/lock_holder.h>
 #include <libcopp/utils/spin_lock.h>
 
+#include <libcotask/impl/task_unhandled_exception_list.h>
 #include <libcotask/task_actions.h>
 
 // clang-format off
@@ -35,12 +37,19 @@ enum EN_TASK_STATUS {
   EN_TS_TIMEOUT,
 };
 
+class task_arena;
+
 namespace impl {
 
 class UTIL_SYMBOL_VISIBLE task_impl {
  public:
+#if defined(LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY) && LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY
+  using id_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_slot_id_allocator::value_type;
+  using id_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_slot_id_allocator;
+#else
   using id_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_id_allocator::value_type;
   using id_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_id_allocator;
+#endif
 
   // Compability with libcopp-1.x
   using id_t = id_type;
@@ -131,13 +140,57 @@ class UTIL_SYMBOL_VISIBLE task_impl {
    */
   UTIL_FORCEINLINE action_ptr_type get_raw_action() const LIBCOPP_MACRO_NOEXCEPT { return action_; }
 
+  /**
+   * @brief get arena of this task, it's created when it's called for the first time
+   * @note all memory allocated from the arena is released when the task is finished, and the arena is recycled after
+   *       the action and the private data are destroyed
+   * @return arena of this task, or nullptr if failed to allocate memory
+   */
+  LIBCOPP_COTASK_API task_arena *get_arena() LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief get buffer size to reserve for private data of type TPRIVATE_DATA, including padding for alignment
+   * @note private buffer is aligned to pointer at least, so padding is only needed for over-aligned types
+   */
+  template <typename TPRIVATE_DATA>
+  static constexpr size_t get_private_data_reserve_size() LIBCOPP_MACRO_NOEXCEPT {
+    return sizeof(TPRIVATE_DATA) +
+           (alignof(TPRIVATE_DATA) > sizeof(void *) ? alignof(TPRIVATE_DATA) - sizeof(void *) : 0);
+  }
+
+  /**
+   * @brief get address of private data of type TPRIVATE_DATA in private buffer
+   * @param buffer private buffer
+   * @param buffer_size private buffer size
+   * @return address of private data, or nullptr if buffer is too small
+   */
+  template <typename TPRIVATE_DATA>
+  static TPRIVATE_DATA *get_private_data_address(void *buffer, size_t buffer_size) LIBCOPP_MACRO_NOEXCEPT {
+    if (nullptr == buffer) {
+      return nullptr;
+    }
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(buffer);
+    uintptr_t addr = (begin + alignof(TPRIVATE_DATA) - 1) & ~static_cast<uintptr_t>(alignof(TPRIVATE_DATA) - 1);
+    if (addr - begin + sizeof(TPRIVATE_DATA) > buffer_size) {
+      return nullptr;
+    }
+
+    return reinterpret_cast<TPRIVATE_DATA *>(addr);
+  }
+
  protected:
   LIBCOPP_COTASK_API void _set_action(action_ptr_type action);
   LIBCOPP_COTASK_API action_ptr_type _get_action();
 
   LIBCOPP_COTASK_API bool _cas_status(EN_TASK_STATUS &expected, EN_TASK_STATUS desired);
 
+  // take the ownership of arena, it's used to destroy the arena after the private data
+  LIBCOPP_COTASK_API task_arena *_detach_arena() LIBCOPP_MACRO_NOEXCEPT;
+
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  LIBCOPP_COTASK_API int _notify_finished(unhandled_exception_list &unhandled, void *priv_data);
+  // compatible with std::list<std::exception_ptr> of old versions
   LIBCOPP_COTASK_API int _notify_finished(std::list<std::exception_ptr> &unhandled, void *priv_data);
 #else
   LIBCOPP_COTASK_API int _notify_finished(void *priv_data);
@@ -146,6 +199,7 @@ class UTIL_SYMBOL_VISIBLE task_impl {
  private:
   action_ptr_type action_;
   id_type id_;
+  task_arena *arena_;
 
  protected:
   void *finish_priv_data_;
@@ -0,0 +1,251 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+#include <libcopp/utils/uint64_slot_id_allocator.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * @brief task registry indexed by slot index of ids allocated by uint64_slot_id_allocator
+ * @note it has the same interfaces as std::unordered_map which are used by task_manager, except that erase(iterator)
+ *       returns nothing. find(...) is just an indexed load and a compare of id. Slots are allocated by pages, so the
+ *       address of values will never change until they are erased.
+ */
+template <class TKEY, class TVALUE>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_slot_map {
+ public:
+  using key_type = TKEY;
+  using mapped_type = TVALUE;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = size_t;
+  using id_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_slot_id_allocator;
+  using self_type = task_slot_map<key_type, mapped_type>;
+
+ private:
+  enum { PAGE_BITS = 10 };
+
+  struct slot_type {
+    bool has_value;
+    alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+    inline value_type *get() LIBCOPP_MACRO_NOEXCEPT { return reinterpret_cast<value_type *>(storage); }
+  };
+
+  template <class TOWNER, class TVAL>
+  class LIBCOPP_COTASK_API_HEAD_ONLY basic_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = TVAL;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+
+    basic_iterator() LIBCOPP_MACRO_NOEXCEPT : owner_(nullptr), index_(0) {}
+    basic_iterator(TOWNER *owner, size_t index) LIBCOPP_MACRO_NOEXCEPT : owner_(owner), index_(index) {}
+
+    template <class TOTHER_OWNER, class TOTHER_VAL>
+    basic_iterator(const basic_iterator<TOTHER_OWNER, TOTHER_VAL> &other) LIBCOPP_MACRO_NOEXCEPT
+        : owner_(other.owner_),
+          index_(other.index_) {}
+
+    inline reference operator*() const LIBCOPP_MACRO_NOEXCEPT { return *owner_->get_slot(index_)->get(); }
+    inline pointer operator->() const LIBCOPP_MACRO_NOEXCEPT { return owner_->get_slot(index_)->get(); }
+
+    inline basic_iterator &operator++() LIBCOPP_MACRO_NOEXCEPT {
+      index_ = owner_->next_index(index_ + 1);
+      return *this;
+    }
+
+    inline basic_iterator operator++(int) LIBCOPP_MACRO_NOEXCEPT {
+      basic_iterator ret = *this;
+      ++(*this);
+      return ret;
+    }
+
+    friend inline bool operator==(const basic_iterator &l, const basic_iterator &r) LIBCOPP_MACRO_NOEXCEPT {
+      return l.index_ == r.index_;
+    }
+
+    friend inline bool operator!=(const basic_iterator &l, const basic_iterator &r) LIBCOPP_MACRO_NOEXCEPT {
+      return l.index_ != r.index_;
+    }
+
+   private:
+    template <class, class>
+    friend class basic_iterator;
+    friend class task_slot_map;
+
+    TOWNER *owner_;
+    size_t index_;
+  };
+
+ public:
+  using iterator = basic_iterator<self_type, value_type>;
+  using const_iterator = basic_iterator<const self_type, const value_type>;
+
+ public:
+  task_slot_map() : size_(0) {}
+  ~task_slot_map() { clear(); }
+
+  inline size_type size() const LIBCOPP_MACRO_NOEXCEPT { return size_; }
+  inline bool empty() const LIBCOPP_MACRO_NOEXCEPT { return 0 == size_; }
+
+  inline iterator begin() LIBCOPP_MACRO_NOEXCEPT { return iterator(this, next_index(0)); }
+  inline iterator end() LIBCOPP_MACRO_NOEXCEPT { return iterator(this, end_index()); }
+  inline const_iterator begin() const LIBCOPP_MACRO_NOEXCEPT { return const_iterator(this, next_index(0)); }
+  inline const_iterator end() const LIBCOPP_MACRO_NOEXCEPT { return const_iterator(this, end_index()); }
+  inline const_iterator cbegin() const LIBCOPP_MACRO_NOEXCEPT { return begin(); }
+  inline const_iterator cend() const LIBCOPP_MACRO_NOEXCEPT { return end(); }
+
+  inline iterator find(const key_type &key) LIBCOPP_MACRO_NOEXCEPT { return iterator(this, find_index(key)); }
+
+  inline const_iterator find(const key_type &key) const LIBCOPP_MACRO_NOEXCEPT {
+    return const_iterator(this, find_index(key));
+  }
+
+  inline size_type count(const key_type &key) const LIBCOPP_MACRO_NOEXCEPT {
+    return find_index(key) == end_index() ? 0 : 1;
+  }
+
+  /**
+   * @brief insert a value into the slot of key
+   * @note key must be allocated by uint64_slot_id_allocator, or it will fail when the slot index of key is too large
+   * @return the same as std::unordered_map::insert
+   */
+  std::pair<iterator, bool> insert(const value_type &value) {
+    size_t index = static_cast<size_t>(id_allocator_type::get_index(value.first));
+    size_t page_index = index >> PAGE_BITS;
+    if (page_index >= pages_.size()) {
+      // slot index of ids allocated by uint64_slot_id_allocator is always less than the peak count of living ids
+      if (index >= id_allocator_type::get_capacity()) {
+        return std::pair<iterator, bool>(end(), false);
+      }
+      pages_.resize(page_index + 1);
+    }
+
+    if (!pages_[page_index]) {
+      pages_[page_index].reset(new slot_type[static_cast<size_t>(1) << PAGE_BITS]());
+    }
+
+    slot_type *slot = get_slot(index);
+    if (slot->has_value) {
+      return std::pair<iterator, bool>(iterator(this, index), false);
+    }
+
+    new (slot->storage) value_type(value);
+    slot->has_value = true;
+    ++size_;
+    return std::pair<iterator, bool>(iterator(this, index), true);
+  }
+
+  /**
+   * @brief erase the value of iterator
+   * @note unlike std::unordered_map, the next iterator is not returned. Slot indexes are allocated by a global
+   *       allocator, so the map of a manager is usually sparse and scanning for the next value may cost O(capacity).
+   */
+  void erase(iterator iter) LIBCOPP_MACRO_NOEXCEPT {
+    if (iter.index_ >= end_index()) {
+      return;
+    }
+
+    destroy_slot(iter.index_);
+  }
+
+  size_type erase(const key_type &key) LIBCOPP_MACRO_NOEXCEPT {
+    size_t index = find_index(key);
+    if (index == end_index()) {
+      return 0;
+    }
+
+    destroy_slot(index);
+    return 1;
+  }
+
+  void clear() LIBCOPP_MACRO_NOEXCEPT {
+    for (size_t i = 0; size_ > 0 && i < end_index(); ++i) {
+      if (!pages_[i >> PAGE_BITS]) {
+        i |= (static_cast<size_t>(1) << PAGE_BITS) - 1;
+        continue;
+      }
+
+      destroy_slot(i);
+    }
+  }
+
+ private:
+  task_slot_map(const task_slot_map &) = delete;
+  task_slot_map &operator=(const task_slot_map &) = delete;
+
+  inline size_t end_index() const LIBCOPP_MACRO_NOEXCEPT { return pages_.size() << PAGE_BITS; }
+
+  inline slot_type *get_slot(size_t index) const LIBCOPP_MACRO_NOEXCEPT {
+    return &pages_[index >> PAGE_BITS][index & ((static_cast<size_t>(1) << PAGE_BITS) - 1)];
+  }
+
+  inline void destroy_slot(size_t index) LIBCOPP_MACRO_NOEXCEPT {
+    slot_type *slot = get_slot(index);
+    if (slot->has_value) {
+      slot->get()->~value_type();
+      slot->has_value = false;
+      --size_;
+    }
+  }
+
+  inline size_t find_index(const key_type &key) const LIBCOPP_MACRO_NOEXCEPT {
+    size_t index = static_cast<size_t>(id_allocator_type::get_index(key));
+    size_t page_index = index >> PAGE_BITS;
+    if (page_index >= pages_.size() || !pages_[page_index]) {
+      return end_index();
+    }
+
+    slot_type *slot = get_slot(index);
+    if (slot->has_value && slot->get()->first == key) {
+      return index;
+    }
+    return end_index();
+  }
+
+  size_t next_index(size_t index) const LIBCOPP_MACRO_NOEXCEPT {
+    size_t end_idx = end_index();
+    while (index < end_idx) {
+      if (!pages_[index >> PAGE_BITS]) {
+        index = ((index >> PAGE_BITS) + 1) << PAGE_BITS;
+        continue;
+      }
+
+      if (get_slot(index)->has_value) {
+        return index;
+      }
+      ++index;
+    }
+    return end_idx;
+  }
+
+ private:
+  std::vector<std::unique_ptr<slot_type[]>> pages_;
+  size_t size_;
+};
+
+}  // namespace detail
+
+LIBCOPP_COTASK_NAMESPACE_END
@@ -0,0 +1,403 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <assert.h>
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief configure of hierarchical timing wheel used by task_manager
+ * @note range of the wheel is granularity_nsec * 2^(slot_bits * levels), timers out of range are kept in an overflow
+ *       list and rechecked every round of the top level
+ */
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_timer_wheel_config {
+  uint64_t granularity_nsec; /** nanoseconds of one slot in the lowest level, timers may expire one slot later **/
+  uint32_t slot_bits;        /** every level has 2^slot_bits slots **/
+  uint32_t levels;           /** level count **/
+
+  inline task_timer_wheel_config() : granularity_nsec(1000000), slot_bits(8), levels(4) {}
+  inline task_timer_wheel_config(uint64_t g, uint32_t bits, uint32_t l)
+      : granularity_nsec(g), slot_bits(bits), levels(l) {}
+
+  inline bool is_valid() const LIBCOPP_MACRO_NOEXCEPT {
+    return granularity_nsec > 0 && slot_bits > 0 && slot_bits <= 16 && levels > 0 && slot_bits * levels < 64;
+  }
+};
+
+namespace detail {
+
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_timer_wheel_list_head {
+  task_timer_wheel_list_head *prev;
+  task_timer_wheel_list_head *next;
+};
+
+template <class TTASK_ID_TYPE>
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_timer_wheel_node : public task_timer_wheel_list_head {
+  uint64_t expired_nsec; /** expired time in nanoseconds **/
+  uint64_t expired_tick; /** slot tick, a timer expires when the wheel goes to this tick **/
+  uint32_t level;        /** level of the wheel, or list index of pending/expired/overflow list **/
+  TTASK_ID_TYPE task_id;
+};
+
+/**
+ * @brief hierarchical timing wheel with pooled nodes, insert and erase are O(1)
+ * @note it's not thread-safe, task_manager protects it with its own lock
+ */
+template <class TTASK_ID_TYPE>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_timer_wheel {
+ public:
+  using id_type = TTASK_ID_TYPE;
+  using node_type = task_timer_wheel_node<id_type>;
+  using list_head_type = task_timer_wheel_list_head;
+
+ private:
+  enum { NODE_CHUNK_SIZE = 256 };
+
+ public:
+  explicit task_timer_wheel(const task_timer_wheel_config &conf)
+      : conf_(conf),
+        slot_mask_((static_cast<uint64_t>(1) << conf.slot_bits) - 1),
+        current_tick_(0),
+        started_(false),
+        size_(0),
+        expired_size_(0),
+        free_list_(nullptr) {
+    assert(conf_.is_valid());
+
+    size_t slot_count = static_cast<size_t>(conf_.levels) << conf_.slot_bits;
+    slots_.resize(slot_count);
+    level_size_.resize(conf_.levels, 0);
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      init_list(slots_[i]);
+    }
+    init_list(pending_);
+    init_list(expired_);
+    init_list(overflow_);
+  }
+
+  inline const task_timer_wheel_config &get_config() const LIBCOPP_MACRO_NOEXCEPT { return conf_; }
+
+  /**
+   * @brief timer count, including expired timers which are not popped
+   */
+  inline size_t size() const LIBCOPP_MACRO_NOEXCEPT { return size_; }
+
+  inline bool empty() const LIBCOPP_MACRO_NOEXCEPT { return 0 == size_; }
+
+  /**
+   * @brief expired timers which are not popped
+   */
+  inline size_t get_expired_size() const LIBCOPP_MACRO_NOEXCEPT { return expired_size_; }
+
+  inline bool is_started() const LIBCOPP_MACRO_NOEXCEPT { return started_; }
+
+  /**
+   * @brief remove all timers and stop the wheel, nodes are kept in pool
+   */
+  void clear() LIBCOPP_MACRO_NOEXCEPT {
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      release_list(slots_[i]);
+    }
+    release_list(pending_);
+    release_list(expired_);
+    release_list(overflow_);
+    for (size_t i = 0; i < level_size_.size(); ++i) {
+      level_size_[i] = 0;
+    }
+
+    current_tick_ = 0;
+    started_ = false;
+    size_ = 0;
+    expired_size_ = 0;
+  }
+
+  /**
+   * @brief start the wheel at now_nsec, all timers inserted before are relative to now_nsec
+   */
+  void start(uint64_t now_nsec) {
+    if (started_) {
+      return;
+    }
+
+    started_ = true;
+    current_tick_ = now_nsec / conf_.granularity_nsec;
+
+    while (pending_.next != &pending_) {
+      node_type *node = static_cast<node_type *>(pending_.next);
+      unlink(node);
+      place(node, node->expired_nsec + now_nsec);
+    }
+  }
+
+  /**
+   * @brief add a timer
+   * @param task_id task id
+   * @param expired_nsec expired time in nanoseconds, it's relative to the time of start(...) before started
+   * @return node of timer which can be used to erase it
+   */
+  node_type *insert(id_type task_id, uint64_t expired_nsec) {
+    node_type *node = allocate_node();
+    node->task_id = task_id;
+    ++size_;
+
+    if (!started_) {
+      node->expired_nsec = expired_nsec;
+      node->expired_tick = 0;
+      node->level = pending_list_index();
+      link_tail(pending_, node);
+      return node;
+    }
+
+    place(node, expired_nsec);
+    return node;
+  }
+
+  /**
+   * @brief remove a timer, node will be unavailable after this call
+   */
+  void erase(node_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    if (nullptr == node) {
+      return;
+    }
+
+    unlink(node);
+    if (node->level < conf_.levels) {
+      --level_size_[node->level];
+    } else if (node->level == expired_list_index()) {
+      --expired_size_;
+    }
+
+    --size_;
+    deallocate_node(node);
+  }
+
+  /**
+   * @brief move the wheel to now_nsec, all timers expired before now_nsec will be moved to the expired list
+   * @return count of expired timers which are not popped
+   */
+  size_t advance(uint64_t now_nsec) LIBCOPP_MACRO_NOEXCEPT {
+    if (!started_) {
+      start(now_nsec);
+    }
+
+    uint64_t to_tick = now_nsec / conf_.granularity_nsec;
+    while (current_tick_ < to_tick) {
+      // no timer in wheel, just fast-forward
+      if (size_ == expired_size_) {
+        current_tick_ = to_tick;
+        break;
+      }
+
+      // no timer in lower levels, skip to the tick before next cascade of the first non-empty level
+      uint32_t skip_level = 0;
+      while (skip_level < conf_.levels && 0 == level_size_[skip_level]) {
+        ++skip_level;
+      }
+      if (skip_level > 0) {
+        uint64_t round_end = current_tick_ | ((static_cast<uint64_t>(1) << (conf_.slot_bits * skip_level)) - 1);
+        if (round_end >= to_tick) {
+          current_tick_ = to_tick;
+          break;
+        }
+        current_tick_ = round_end;
+      }
+
+      ++current_tick_;
+      cascade();
+
+      list_head_type &slot = get_slot(0, current_tick_ & slot_mask_);
+      while (slot.next != &slot) {
+        node_type *node = static_cast<node_type *>(slot.next);
+        unlink(node);
+        --level_size_[0];
+        push_expired(node);
+      }
+    }
+
+    return expired_size_;
+  }
+
+  /**
+   * @brief get the first expired timer, erase(...) should be called to pop it
+   * @return first expired timer or nullptr
+   */
+  inline node_type *front_expired() LIBCOPP_MACRO_NOEXCEPT {
+    if (expired_.next == &expired_) {
+      return nullptr;
+    }
+
+    return static_cast<node_type *>(expired_.next);
+  }
+
+ private:
+  task_timer_wheel(const task_timer_wheel &) = delete;
+  task_timer_wheel &operator=(const task_timer_wheel &) = delete;
+
+  inline uint32_t pending_list_index() const LIBCOPP_MACRO_NOEXCEPT { return conf_.levels; }
+  inline uint32_t expired_list_index() const LIBCOPP_MACRO_NOEXCEPT { return conf_.levels + 1; }
+  inline uint32_t overflow_list_index() const LIBCOPP_MACRO_NOEXCEPT { return conf_.levels + 2; }
+
+  inline list_head_type &get_slot(uint32_t level, uint64_t index) LIBCOPP_MACRO_NOEXCEPT {
+    return slots_[(static_cast<size_t>(level) << conf_.slot_bits) + static_cast<size_t>(index)];
+  }
+
+  static inline void init_list(list_head_type &head) LIBCOPP_MACRO_NOEXCEPT {
+    head.prev = &head;
+    head.next = &head;
+  }
+
+  static inline void link_tail(list_head_type &head, list_head_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    node->prev = head.prev;
+    node->next = &head;
+    head.prev->next = node;
+    head.prev = node;
+  }
+
+  static inline void unlink(list_head_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+  }
+
+  inline void push_expired(node_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    node->level = expired_list_index();
+    link_tail(expired_, node);
+    ++expired_size_;
+  }
+
+  void place(node_type *node, uint64_t expired_nsec) LIBCOPP_MACRO_NOEXCEPT {
+    node->expired_nsec = expired_nsec;
+    // timer expires only when now is greater than expired time, so put it into the next tick
+    node->expired_tick = expired_nsec / conf_.granularity_nsec + 1;
+    relink(node);
+  }
+
+  void relink(node_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    if (node->expired_tick <= current_tick_) {
+      push_expired(node);
+      return;
+    }
+
+    uint64_t delta = node->expired_tick - current_tick_;
+    for (uint32_t level = 0; level < conf_.levels; ++level) {
+      uint32_t shift = conf_.slot_bits * level;
+      if ((delta >> shift) <= slot_mask_) {
+        node->level = level;
+        link_tail(get_slot(level, (node->expired_tick >> shift) & slot_mask_), node);
+        ++level_size_[level];
+        return;
+      }
+    }
+
+    node->level = overflow_list_index();
+    link_tail(overflow_, node);
+  }
+
+  void cascade() LIBCOPP_MACRO_NOEXCEPT {
+    for (uint32_t level = 1; level <= conf_.levels; ++level) {
+      uint32_t shift = conf_.slot_bits * level;
+      if (0 != (current_tick_ & ((static_cast<uint64_t>(1) << shift) - 1))) {
+        break;
+      }
+
+      // the top level finished a round, recheck overflow timers
+      if (level == conf_.levels) {
+        relink_list(overflow_);
+        break;
+      }
+
+      list_head_type &slot = get_slot(level, (current_tick_ >> shift) & slot_mask_);
+      level_size_[level] -= relink_list(slot);
+    }
+  }
+
+  size_t relink_list(list_head_type &head) LIBCOPP_MACRO_NOEXCEPT {
+    // detach all nodes first, some of them may be linked back to the same list
+    list_head_type detached;
+    if (head.next == &head) {
+      return 0;
+    }
+    detached.next = head.next;
+    detached.prev = head.prev;
+    detached.next->prev = &detached;
+    detached.prev->next = &detached;
+    init_list(head);
+
+    size_t ret = 0;
+    while (detached.next != &detached) {
+      node_type *node = static_cast<node_type *>(detached.next);
+      unlink(node);
+      relink(node);
+      ++ret;
+    }
+    return ret;
+  }
+
+  void release_list(list_head_type &head) LIBCOPP_MACRO_NOEXCEPT {
+    while (head.next != &head) {
+      node_type *node = static_cast<node_type *>(head.next);
+      unlink(node);
+      deallocate_node(node);
+    }
+  }
+
+  node_type *allocate_node() {
+    if (nullptr == free_list_) {
+      std::unique_ptr<node_type[]> chunk(new node_type[NODE_CHUNK_SIZE]);
+      for (size_t i = 0; i < NODE_CHUNK_SIZE; ++i) {
+        chunk[i].next = free_list_;
+        free_list_ = &chunk[i];
+      }
+      node_chunks_.push_back(std::move(chunk));
+    }
+
+    node_type *ret = static_cast<node_type *>(free_list_);
+    free_list_ = free_list_->next;
+    ret->prev = ret;
+    ret->next = ret;
+    return ret;
+  }
+
+  inline void deallocate_node(node_type *node) LIBCOPP_MACRO_NOEXCEPT {
+    node->prev = nullptr;
+    node->next = free_list_;
+    free_list_ = node;
+  }
+
+ private:
+  task_timer_wheel_config conf_;
+  uint64_t slot_mask_;
+  uint64_t current_tick_;
+  bool started_;
+  size_t size_;
+  size_t expired_size_;
+
+  std::vector<list_head_type> slots_;
+  std::vector<size_t> level_size_;
+  list_head_type pending_;
+  list_head_type expired_;
+  list_head_type overflow_;
+
+  list_head_type *free_list_;
+  std::vector<std::unique_ptr<node_type[]>> node_chunks_;
+};
+
+}  // namespace detail
+
+LIBCOPP_COTASK_NAMESPACE_END
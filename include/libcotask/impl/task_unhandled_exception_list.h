@@ -0,0 +1,151 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+// clang-format off
+#  include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#  include <cstddef>
+#  include <exception>
+#  include <list>
+#  include <memory>
+#  include <utility>
+#  include <vector>
+// clang-format off
+#  include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief collector of unhandled exceptions of task APIs
+ * @note The first exception is stored inline, and all exceptions are moved into a vector when the second one is added.
+ *       So there is no memory allocation when there is no exception or only one exception, which is the common case.
+ *       Empty exception_ptr is ignored.
+ */
+class LIBCOPP_COTASK_API_HEAD_ONLY unhandled_exception_list {
+ public:
+  using value_type = std::exception_ptr;
+  using iterator = std::exception_ptr *;
+  using const_iterator = const std::exception_ptr *;
+
+ public:
+  unhandled_exception_list() LIBCOPP_MACRO_NOEXCEPT {}
+
+  unhandled_exception_list(unhandled_exception_list &&other) LIBCOPP_MACRO_NOEXCEPT
+      : inline_(std::move(other.inline_)),
+        overflow_(std::move(other.overflow_)) {
+    other.inline_ = nullptr;
+  }
+
+  unhandled_exception_list &operator=(unhandled_exception_list &&other) LIBCOPP_MACRO_NOEXCEPT {
+    if (this != &other) {
+      inline_ = std::move(other.inline_);
+      overflow_ = std::move(other.overflow_);
+      other.inline_ = nullptr;
+    }
+    return *this;
+  }
+
+  void push_back(std::exception_ptr eptr) {
+    if (!eptr) {
+      return;
+    }
+
+    if (!overflow_) {
+      if (!inline_) {
+        inline_ = std::move(eptr);
+        return;
+      }
+
+      overflow_.reset(new std::vector<std::exception_ptr>());
+      overflow_->reserve(4);
+      overflow_->push_back(std::move(inline_));
+      inline_ = nullptr;
+    }
+
+    overflow_->push_back(std::move(eptr));
+  }
+
+  template <class... TARGS>
+  inline void emplace_back(TARGS &&...args) {
+    push_back(std::exception_ptr(std::forward<TARGS>(args)...));
+  }
+
+  /**
+   * @brief move all exceptions of other to the end of this list
+   * @param other source list, it will be empty after this call
+   */
+  void append(unhandled_exception_list &other) {
+    if (this == &other) {
+      return;
+    }
+
+    if (empty()) {
+      swap(other);
+      return;
+    }
+
+    // size of inline mode changes after the exception_ptr is moved, so end() must be taken first
+    iterator end_iter = other.end();
+    for (iterator iter = other.begin(); iter != end_iter; ++iter) {
+      push_back(std::move(*iter));
+    }
+    other.clear();
+  }
+
+  /**
+   * @brief move all exceptions to the end of a std::list, it's used by APIs which are compatible with old versions
+   * @param out target list
+   */
+  void move_to(std::list<std::exception_ptr> &out) {
+    iterator end_iter = end();
+    for (iterator iter = begin(); iter != end_iter; ++iter) {
+      out.emplace_back(std::move(*iter));
+    }
+    clear();
+  }
+
+  inline void swap(unhandled_exception_list &other) LIBCOPP_MACRO_NOEXCEPT {
+    inline_.swap(other.inline_);
+    overflow_.swap(other.overflow_);
+  }
+
+  inline void clear() LIBCOPP_MACRO_NOEXCEPT {
+    inline_ = nullptr;
+    overflow_.reset();
+  }
+
+  inline bool empty() const LIBCOPP_MACRO_NOEXCEPT { return 0 == size(); }
+
+  inline size_t size() const LIBCOPP_MACRO_NOEXCEPT {
+    if (overflow_) {
+      return overflow_->size();
+    }
+    return inline_ ? 1 : 0;
+  }
+
+  inline iterator begin() LIBCOPP_MACRO_NOEXCEPT { return overflow_ ? overflow_->data() : &inline_; }
+  inline iterator end() LIBCOPP_MACRO_NOEXCEPT { return begin() + size(); }
+  inline const_iterator begin() const LIBCOPP_MACRO_NOEXCEPT { return overflow_ ? overflow_->data() : &inline_; }
+  inline const_iterator end() const LIBCOPP_MACRO_NOEXCEPT { return begin() + size(); }
+
+  inline std::exception_ptr &front() LIBCOPP_MACRO_NOEXCEPT { return *begin(); }
+  inline const std::exception_ptr &front() const LIBCOPP_MACRO_NOEXCEPT { return *begin(); }
+
+ private:
+  unhandled_exception_list(const unhandled_exception_list &) = delete;
+  unhandled_exception_list &operator=(const unhandled_exception_list &) = delete;
+
+ private:
+  std::exception_ptr inline_;
+  std::unique_ptr<std::vector<std::exception_ptr> > overflow_;
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
+#endif
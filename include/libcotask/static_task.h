@@ -0,0 +1,191 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/stack/stack_traits.h>
+#include <libcopp/utils/features.h>
+#include <libcopp/utils/intrusive_ptr.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/task.h"
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * @brief action of static_task, the runner calls invoke() directly and it can be inlined
+ */
+template <typename TACTION>
+class LIBCOPP_COTASK_API_HEAD_ONLY static_task_action final : public impl::task_action_impl {
+ public:
+  using value_type = TACTION;
+
+  template <typename... TARGS>
+  explicit static_task_action(TARGS &&...args) : action_(std::forward<TARGS>(args)...) {}
+
+  UTIL_FORCEINLINE int invoke(void *priv_data) {
+    return task_action_functor_check::call(&value_type::operator(), action_, priv_data);
+  }
+
+  // only used when it's called by task_action_impl
+  int operator()(void *priv_data) override { return invoke(priv_data); }
+
+  UTIL_FORCEINLINE value_type &get() LIBCOPP_MACRO_NOEXCEPT { return action_; }
+  UTIL_FORCEINLINE const value_type &get() const LIBCOPP_MACRO_NOEXCEPT { return action_; }
+
+ private:
+  value_type action_;
+};
+}  // namespace detail
+
+/**
+ * @brief task with action type known at compile time
+ * @note static_task is final, so start/resume/yield/cancel/kill called by static_task pointer are not dispatched by
+ *       vtable, and the runner of coroutine calls the action without virtual call. It can be converted to
+ *       task<TCO_MACRO>::ptr_type and used by task_manager of task<TCO_MACRO>, but calls by base pointer are still
+ *       virtual.
+ */
+template <typename TACTION, typename TCO_MACRO = macro_coroutine>
+class LIBCOPP_COTASK_API_HEAD_ONLY static_task final : public task<TCO_MACRO> {
+ public:
+  using base_type = task<TCO_MACRO>;
+  using self_type = static_task<TACTION, TCO_MACRO>;
+  using ptr_type = LIBCOPP_COPP_NAMESPACE_ID::util::intrusive_ptr<self_type>;
+  using base_ptr_type = typename base_type::ptr_type;
+  using action_type = typename std::decay<TACTION>::type;
+  using coroutine_type = typename base_type::coroutine_type;
+  using allocator_type = typename coroutine_type::allocator_type;
+
+ private:
+  using action_holder_type = detail::static_task_action<action_type>;
+
+ public:
+  /**
+   * @brief constuctor
+   * @note should not be called directly
+   */
+  explicit static_task(size_t stack_sz) : base_type(stack_sz) {}
+
+  /**
+   * @brief create task with parameters of action
+   * @param alloc stack allocator
+   * @param stack_size stack size
+   * @param private_buffer_size buffer size to store private data
+   * @param args all parameters passed to construtor of action
+   * @return task smart pointer
+   */
+  template <typename... TARGS>
+  static ptr_type create_with(allocator_type &alloc, size_t stack_size, size_t private_buffer_size, TARGS &&...args) {
+    if (0 == stack_size) {
+      stack_size = LIBCOPP_COPP_NAMESPACE_ID::stack_traits::default_size();
+    }
+
+    size_t action_size = coroutine_type::align_address_size(sizeof(action_holder_type));
+    size_t task_size = coroutine_type::align_address_size(sizeof(self_type));
+
+    if (stack_size <= sizeof(impl::task_impl *) + private_buffer_size + action_size + task_size) {
+      return ptr_type();
+    }
+
+    typename coroutine_type::ptr_type coroutine =
+        coroutine_type::create(typename coroutine_type::callback_t(), alloc, stack_size,
+                               sizeof(impl::task_impl *) + private_buffer_size, action_size + task_size);
+    if (!coroutine) {
+      return ptr_type();
+    }
+
+    void *action_addr = base_type::sub_buffer_offset(coroutine.get(), action_size);
+    void *task_addr = base_type::sub_buffer_offset(action_addr, task_size);
+
+    // placement new task
+    ptr_type ret(new (task_addr) self_type(stack_size));
+    if (!ret) {
+      return ret;
+    }
+
+    *(reinterpret_cast<impl::task_impl **>(coroutine->get_private_buffer())) = ret.get();
+    ret->coroutine_obj_ = coroutine;
+    ret->coroutine_obj_->set_flags(impl::task_impl::ext_coroutine_flag_t::EN_ECFT_COTASK);
+
+    // placement new action
+    action_holder_type *action = new (action_addr) action_holder_type(std::forward<TARGS>(args)...);
+
+    // redirect runner, the type of action is known here
+    coroutine->set_runner([action](void *private_data) { return action->invoke(private_data); });
+
+    ret->action_destroy_fn_ = get_placement_destroy(action);
+    ret->_set_action(action);
+
+    return ret;
+  }
+
+  template <typename... TARGS>
+  static inline ptr_type create_with(size_t stack_size, size_t private_buffer_size, TARGS &&...args) {
+    allocator_type alloc;
+    return create_with(alloc, stack_size, private_buffer_size, std::forward<TARGS>(args)...);
+  }
+
+  /**
+   * @brief create task with action
+   * @param action action object
+   * @param stack_size stack size
+   * @param private_buffer_size buffer size to store private data
+   * @return task smart pointer
+   */
+  static inline ptr_type create(action_type action, allocator_type &alloc, size_t stack_size = 0,
+                                size_t private_buffer_size = 0) {
+    return create_with(alloc, stack_size, private_buffer_size, std::move(action));
+  }
+
+  static inline ptr_type create(action_type action, size_t stack_size = 0, size_t private_buffer_size = 0) {
+    allocator_type alloc;
+    return create_with(alloc, stack_size, private_buffer_size, std::move(action));
+  }
+
+  /**
+   * get current running task and convert to static_task object
+   * @return task pointer, or nullptr if current task is not this type
+   */
+  static self_type *this_task() {
+#if defined(LIBCOPP_MACRO_ENABLE_RTTI) && LIBCOPP_MACRO_ENABLE_RTTI
+    return dynamic_cast<self_type *>(impl::task_impl::this_task());
+#else
+    return static_cast<self_type *>(impl::task_impl::this_task());
+#endif
+  }
+
+  inline action_type &get_action() LIBCOPP_MACRO_NOEXCEPT {
+    return static_cast<action_holder_type *>(this->_get_action())->get();
+  }
+
+  using base_type::cancel;
+  using base_type::kill;
+  using base_type::resume;
+  using base_type::start;
+  using base_type::yield;
+
+  // this type is final, these calls do not use vtable
+  UTIL_FORCEINLINE int start() { return start(nullptr, EN_TS_CREATED); }
+  UTIL_FORCEINLINE int resume() { return resume(nullptr, EN_TS_WAITING); }
+  UTIL_FORCEINLINE int yield() { return yield(nullptr); }
+  UTIL_FORCEINLINE int cancel() { return cancel(nullptr); }
+  UTIL_FORCEINLINE int kill() { return kill(EN_TS_KILLED, nullptr); }
+
+ private:
+  static_task(const static_task &) = delete;
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
@@ -10,6 +10,8 @@
 
 #include <libcopp/stack/stack_traits.h>
 #include <libcopp/utils/errno.h>
+#include <libcopp/utils/gsl/span.h>
+#include <libcotask/task_arena.h>
 #include <libcotask/task_macros.h>
 #include <libcotask/this_task.h>
 
@@ -27,12 +29,19 @@
 #include <algorithm>
 #include <cstddef>
 #include <list>
+#include <vector>
 // clang-format off
 #include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
 // clang-format on
 
 LIBCOPP_COTASK_NAMESPACE_BEGIN
 
+template <typename TACTION, typename TCO_MACRO>
+class LIBCOPP_COTASK_API_HEAD_ONLY static_task;
+
+template <typename TCO_MACRO>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_executor;
+
 template <typename TCO_MACRO = macro_coroutine>
 class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
  public:
@@ -60,8 +69,180 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
   // Compability with libcopp-1.x
   using action_ptr_t = action_ptr_type;
 
-  struct task_group {
-    std::list<std::pair<ptr_type, void *> > member_list_;
+  template <typename, typename>
+  friend class LIBCOPP_COTASK_API_HEAD_ONLY static_task;
+
+  template <typename>
+  friend class LIBCOPP_COTASK_API_HEAD_ONLY task_executor;
+
+ public:
+  /**
+   * @brief callback called when task finished, see add_finish_callback(...)
+   * @note unhandled exceptions of tasks started or resumed by callback should be appended to the unhandled list
+   */
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  using finish_callback_type = void (*)(void *, self_type &, unhandled_exception_list &);
+#else
+  using finish_callback_type = void (*)(void *, self_type &);
+#endif
+
+ private:
+
+  // spilled continuation, the first continuation is stored inline in next_task_list
+  struct next_task_node {
+    ptr_type task;
+    void *priv_data;
+    finish_callback_type callback;
+    next_task_node *next;
+  };
+
+  // free list of spilled continuations, shared by all tasks of the same type
+  struct next_task_node_pool {
+    enum { MAX_FREE_NUMBER = 256 };
+
+    next_task_node *free_head;
+    size_t free_number;
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock lock;
+#endif
+
+    next_task_node_pool() : free_head(nullptr), free_number(0) {}
+
+    static next_task_node_pool &instance() {
+      // never destroyed, tasks may be released after static variables are destroyed
+      static next_task_node_pool *ret = new next_task_node_pool();
+      return *ret;
+    }
+
+    next_task_node *allocate() {
+      next_task_node *ret = nullptr;
+      {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock>
+            lock_guard(lock);
+#endif
+        if (nullptr != free_head) {
+          ret = free_head;
+          free_head = ret->next;
+          --free_number;
+        }
+      }
+
+      if (nullptr == ret) {
+        ret = new next_task_node();
+      }
+      ret->priv_data = nullptr;
+      ret->callback = nullptr;
+      ret->next = nullptr;
+      return ret;
+    }
+
+    void deallocate(next_task_node *node) {
+      node->task.reset();
+      {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock>
+            lock_guard(lock);
+#endif
+        if (free_number < MAX_FREE_NUMBER) {
+          node->next = free_head;
+          free_head = node;
+          ++free_number;
+          return;
+        }
+      }
+      delete node;
+    }
+  };
+
+  /**
+   * @brief continuations of this task
+   * @note Most tasks have at most one continuation, it's stored inline and published by an atomic state without lock
+   *       or memory allocation. Other continuations are spilled to an intrusive list protected by inner_action_lock_.
+   */
+  struct next_task_list {
+    enum inline_state_type {
+      EN_NTS_EMPTY = 0,
+      EN_NTS_WRITING = 1,
+      EN_NTS_READY = 2,
+      // a finish callback is spilled, following continuations must be spilled after it to keep the order
+      EN_NTS_CLOSED = 3,
+    };
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<uint32_t> inline_state;
+#else
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<uint32_t> >
+        inline_state;
+#endif
+    ptr_type inline_task;
+    void *inline_priv_data;
+    next_task_node *spill_head;
+    next_task_node *spill_tail;
+
+    next_task_list()
+        : inline_state(static_cast<uint32_t>(EN_NTS_EMPTY)),
+          inline_priv_data(nullptr),
+          spill_head(nullptr),
+          spill_tail(nullptr) {}
+
+    ~next_task_list() {
+      while (nullptr != spill_head) {
+        next_task_node *node = spill_head;
+        spill_head = node->next;
+        next_task_node_pool::instance().deallocate(node);
+      }
+    }
+
+    // lock-free, only fails when the inline slot is used
+    bool try_push_inline(const ptr_type &next_task, void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
+      uint32_t expected = static_cast<uint32_t>(EN_NTS_EMPTY);
+      if (!inline_state.compare_exchange_strong(expected, static_cast<uint32_t>(EN_NTS_WRITING),
+                                                LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+                                                LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+        return false;
+      }
+
+      inline_task = next_task;
+      inline_priv_data = priv_data;
+      inline_state.store(static_cast<uint32_t>(EN_NTS_READY),
+                         LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+      return true;
+    }
+
+    // lock-free, make the empty inline slot unavailable
+    void close_inline() LIBCOPP_MACRO_NOEXCEPT {
+      uint32_t expected = static_cast<uint32_t>(EN_NTS_EMPTY);
+      inline_state.compare_exchange_strong(expected, static_cast<uint32_t>(EN_NTS_CLOSED),
+                                           LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+                                           LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire);
+    }
+
+    bool try_pop_inline(ptr_type &out_task, void *&out_priv_data) LIBCOPP_MACRO_NOEXCEPT {
+      while (true) {
+        uint32_t expected = inline_state.load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire);
+        if (static_cast<uint32_t>(EN_NTS_EMPTY) == expected || static_cast<uint32_t>(EN_NTS_CLOSED) == expected) {
+          return false;
+        }
+
+        // another thread is just writing the inline slot, it's only two stores
+        if (static_cast<uint32_t>(EN_NTS_WRITING) == expected) {
+          continue;
+        }
+
+        if (inline_state.compare_exchange_strong(expected, static_cast<uint32_t>(EN_NTS_WRITING),
+                                                 LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+                                                 LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+          out_task.swap(inline_task);
+          out_priv_data = inline_priv_data;
+          inline_priv_data = nullptr;
+          inline_state.store(static_cast<uint32_t>(EN_NTS_EMPTY),
+                             LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+          return true;
+        }
+      }
+    }
   };
 
  public:
@@ -71,7 +252,9 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
    */
   task(size_t stack_sz)
       : stack_size_(stack_sz),
-        action_destroy_fn_(nullptr)
+        action_destroy_fn_(nullptr),
+        private_data_destroy_fn_(nullptr),
+        executor_state_(0)
 #if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
         ,
         binding_manager_ptr_(nullptr),
@@ -112,6 +295,73 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
       return ptr_type();
     }
 
+    return attach_delegate<a_t>(coroutine, COPP_MACRO_STD_FORWARD(Ty, callable), stack_size);
+  }
+
+  /**
+   * @brief create a batch of tasks with functors
+   * @note stacks are allocated at once if allocator supports it, such as stack_allocator_pool
+   * @param count count of tasks
+   * @param factory factory(size_t index) returns the functor of the task at index
+   * @param alloc stack allocator, every task has a copy of it
+   * @param stack_size stack size
+   * @param private_buffer_size buffer size to store private data
+   * @return tasks created, it has less than count tasks if failed
+   */
+  template <typename TFactory>
+  static LIBCOPP_COTASK_API_HEAD_ONLY std::vector<ptr_type> create_many(
+      size_t count, TFactory &&factory, const typename coroutine_type::allocator_type &alloc, size_t stack_size = 0,
+      size_t private_buffer_size = 0) {
+    using decay_type = typename std::decay<decltype(factory(static_cast<size_t>(0)))>::type;
+    using a_t = typename std::conditional<std::is_base_of<impl::task_action_impl, decay_type>::value, decay_type,
+                                          task_action_functor<decay_type> >::type;
+
+    std::vector<ptr_type> ret;
+    if (0 == stack_size) {
+      stack_size = LIBCOPP_COPP_NAMESPACE_ID::stack_traits::default_size();
+    }
+
+    size_t action_size = coroutine_type::align_address_size(sizeof(a_t));
+    size_t task_size = coroutine_type::align_address_size(sizeof(self_type));
+
+    if (0 == count || stack_size <= sizeof(impl::task_impl *) + private_buffer_size + action_size + task_size) {
+      return ret;
+    }
+
+    std::vector<typename coroutine_type::ptr_type> coroutines;
+    coroutines.resize(count);
+    size_t coroutine_count = coroutine_type::create_many(
+        LIBCOPP_COPP_NAMESPACE_ID::gsl::span<typename coroutine_type::ptr_type>(coroutines.data(), coroutines.size()),
+        alloc, stack_size, sizeof(impl::task_impl *) + private_buffer_size, action_size + task_size);
+
+    ret.reserve(coroutine_count);
+    for (size_t i = 0; i < coroutine_count; ++i) {
+      ptr_type task_inst = attach_delegate<a_t>(coroutines[i], factory(i), stack_size);
+      if (!task_inst) {
+        break;
+      }
+      ret.push_back(std::move(task_inst));
+    }
+
+    return ret;
+  }
+
+  template <typename TFactory>
+  static inline std::vector<ptr_type> create_many(size_t count, TFactory &&factory, size_t stack_size = 0,
+                                                  size_t private_buffer_size = 0) {
+    typename coroutine_type::allocator_type alloc;
+    return create_many(count, std::forward<TFactory>(factory), alloc, stack_size, private_buffer_size);
+  }
+
+ private:
+  // create task and action in the buffer before coroutine
+  template <typename TAct, typename Ty>
+  static ptr_type attach_delegate(typename coroutine_type::ptr_type &coroutine, Ty &&callable, size_t stack_size) {
+    using a_t = TAct;
+
+    size_t action_size = coroutine_type::align_address_size(sizeof(a_t));
+    size_t task_size = coroutine_type::align_address_size(sizeof(self_type));
+
     void *action_addr = sub_buffer_offset(coroutine.get(), action_size);
     void *task_addr = sub_buffer_offset(action_addr, task_size);
 
@@ -140,6 +390,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
     return ret;
   }
 
+ public:
   /**
    * @brief create task with functor
    * @param action
@@ -220,6 +471,48 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
     return create(a_t(std::forward<TParams>(args)...), alloc, stack_size, private_buffer_size);
   }
 
+  /**
+   * @brief create task with functor and private data constructed in private buffer
+   * @note private data can be got by get_private_data<TPRIVATE_DATA>() or this_task::get_private_data<TPRIVATE_DATA>(),
+   *       and it's destroyed after the task is destroyed
+   * @param functor action
+   * @param alloc stack allocator
+   * @param stack_size stack size
+   * @param args all parameters passed to construtor of type TPRIVATE_DATA
+   * @return task smart pointer
+   */
+  template <typename TPRIVATE_DATA, typename Ty, typename... TParams>
+  static LIBCOPP_COTASK_API_HEAD_ONLY ptr_type create_with_private_data(Ty &&functor,
+                                                                        typename coroutine_type::allocator_type &alloc,
+                                                                        size_t stack_size, TParams &&...args) {
+    using decay_type = typename std::decay<Ty>::type;
+    using a_t = typename std::conditional<std::is_base_of<impl::task_action_impl, decay_type>::value, decay_type,
+                                          task_action_functor<decay_type> >::type;
+
+    ptr_type ret = create_with_delegate<a_t>(
+        std::forward<Ty>(functor), alloc, stack_size,
+        coroutine_type::align_address_size(impl::task_impl::get_private_data_reserve_size<TPRIVATE_DATA>()));
+    if (!ret) {
+      return ret;
+    }
+
+    TPRIVATE_DATA *private_data = ret->template get_private_data<TPRIVATE_DATA>();
+    if (nullptr == private_data) {
+      return ptr_type();
+    }
+
+    new (private_data) TPRIVATE_DATA(std::forward<TParams>(args)...);
+    ret->private_data_destroy_fn_ = &destroy_private_data<TPRIVATE_DATA>;
+    return ret;
+  }
+
+  template <typename TPRIVATE_DATA, typename Ty, typename... TParams>
+  static inline ptr_type create_with_private_data(Ty &&functor, size_t stack_size, TParams &&...args) {
+    typename coroutine_type::allocator_type alloc;
+    return create_with_private_data<TPRIVATE_DATA>(std::forward<Ty>(functor), alloc, stack_size,
+                                                   std::forward<TParams>(args)...);
+  }
+
   /**
    * @brief add next task to run when task finished
    * @note please not to make tasks refer to each other. [it will lead to memory leak]
@@ -246,12 +539,26 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
       return next_task;
     }
 
+    // the first continuation is lock-free and allocation-free
+    if (next_list_.try_push_inline(next_task, priv_data)) {
+      return next_task;
+    }
+
+    next_task_node *node = next_task_node_pool::instance().allocate();
+    node->task = next_task;
+    node->priv_data = priv_data;
+
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
     LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
         inner_action_lock_);
 #endif
 
-    next_list_.member_list_.push_back(std::make_pair(next_task, priv_data));
+    if (nullptr == next_list_.spill_tail) {
+      next_list_.spill_head = node;
+    } else {
+      next_list_.spill_tail->next = node;
+    }
+    next_list_.spill_tail = node;
     return next_task;
   }
 
@@ -377,6 +684,51 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
    */
   inline ptr_type then(ptr_type next_task, void *priv_data = nullptr) { return next(next_task, priv_data); }
 
+  /**
+   * @brief add a callback to be called when task finished, it's called in order with tasks added by next()
+   * @note callback is called by the thread which finishes the task and it should not throw exception
+   * @note callback is called immediately if the task is already exiting or completed
+   * @param fn callback function
+   * @param callback_data data passed to fn
+   * @return 0 or error code
+   */
+  int add_finish_callback(finish_callback_type fn, void *callback_data) {
+    if (nullptr == fn) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (is_exiting() || is_completed()) {
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      unhandled_exception_list eptrs;
+      (*fn)(callback_data, *this, eptrs);
+      maybe_rethrow(eptrs);
+#else
+      (*fn)(callback_data, *this);
+#endif
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    }
+
+    // callbacks are always spilled, continuations added later must not jump ahead of it by the inline slot
+    next_list_.close_inline();
+
+    next_task_node *node = next_task_node_pool::instance().allocate();
+    node->priv_data = callback_data;
+    node->callback = fn;
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+        inner_action_lock_);
+#endif
+
+    if (nullptr == next_list_.spill_tail) {
+      next_list_.spill_head = node;
+    } else {
+      next_list_.spill_tail->next = node;
+    }
+    next_list_.spill_tail = node;
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
   /**
    * @brief create next task with functor using the same allocator and private buffer size as this task
    * @see next
@@ -424,7 +776,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
       kill(EN_TS_TIMEOUT);
     } else if (status <= EN_TS_CREATED) {
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-      std::list<std::exception_ptr> eptrs;
+      unhandled_exception_list eptrs;
       active_next_tasks(eptrs);
       // next tasks
       maybe_rethrow(eptrs);
@@ -450,14 +802,23 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int start(void *priv_data, EN_TASK_STATUS expected_status = EN_TS_CREATED) override {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = start(eptrs, priv_data, expected_status);
     maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   virtual int start(std::list<std::exception_ptr> &unhandled, void *priv_data,
                     EN_TASK_STATUS expected_status = EN_TS_CREATED) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = start(eptrs, priv_data, expected_status);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  virtual int start(unhandled_exception_list &unhandled, void *priv_data,
+                    EN_TASK_STATUS expected_status = EN_TS_CREATED) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int start(void *priv_data, EN_TASK_STATUS expected_status = EN_TS_CREATED) override {
 #endif
@@ -535,16 +896,98 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
     return start(priv_data, expected_status);
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   virtual int resume(std::list<std::exception_ptr> &unhandled, void *priv_data,
                      EN_TASK_STATUS expected_status = EN_TS_WAITING) LIBCOPP_MACRO_NOEXCEPT {
     return start(unhandled, priv_data, expected_status);
   }
+
+  virtual int resume(unhandled_exception_list &unhandled, void *priv_data,
+                     EN_TASK_STATUS expected_status = EN_TS_WAITING) LIBCOPP_MACRO_NOEXCEPT {
+    return start(unhandled, priv_data, expected_status);
+  }
 #else
   int resume(void *priv_data, EN_TASK_STATUS expected_status = EN_TS_WAITING) override {
     return start(priv_data, expected_status);
   }
 #endif
 
+  /**
+   * @brief resume a batch of tasks one by one
+   * @note the next task and its coroutine context are prefetched while the current one is running, but unlike
+   *       coroutine_context::resume_batch, the caller state is not hoisted out of the loop. Every task still goes
+   *       through start(), which claims its status just before switching in, so a task killed by an earlier one of
+   *       the same batch is not resumed any more.
+   * @param tasks tasks to resume, nullptr will get COPP_EC_ARGS_ERROR
+   * @param ret_codes return codes of each task, only the first min(tasks.size(), ret_codes.size()) ones are resumed
+   * @param priv_data private data, will be passed to runner operator() or return to yield
+   * @exception if exception is enabled, it will throw all unhandled exception after the whole batch resumed
+   * @return count of tasks resumed successfully
+   */
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  static size_t resume_batch(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<self_type *const> tasks,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<int> ret_codes, void *priv_data = nullptr) {
+    unhandled_exception_list eptrs;
+    size_t ret = resume_batch(eptrs, tasks, ret_codes, priv_data);
+    maybe_rethrow(eptrs);
+    return ret;
+  }
+
+  static size_t resume_batch(std::list<std::exception_ptr> &unhandled,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<self_type *const> tasks,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<int> ret_codes,
+                             void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    size_t ret = resume_batch(eptrs, tasks, ret_codes, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  static size_t resume_batch(unhandled_exception_list &unhandled,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<self_type *const> tasks,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<int> ret_codes,
+                             void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+#else
+  static size_t resume_batch(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<self_type *const> tasks,
+                             LIBCOPP_COPP_NAMESPACE_ID::gsl::span<int> ret_codes, void *priv_data = nullptr) {
+#endif
+    size_t count = tasks.size() < ret_codes.size() ? tasks.size() : ret_codes.size();
+    size_t ret = 0;
+    if (count > 0 && nullptr != tasks[0]) {
+      COPP_MACRO_PREFETCH(tasks[0]->coroutine_obj_.get());
+    }
+    if (count > 1 && nullptr != tasks[1]) {
+      COPP_MACRO_PREFETCH(tasks[1]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      if (i + 1 < count && nullptr != tasks[i + 1]) {
+        COPP_MACRO_PREFETCH(tasks[i + 1]->coroutine_obj_.get());
+      }
+      if (i + 2 < count && nullptr != tasks[i + 2]) {
+        COPP_MACRO_PREFETCH(tasks[i + 2]);
+      }
+
+      self_type *task_inst = tasks[i];
+      COPP_UNLIKELY_IF (nullptr == task_inst) {
+        ret_codes[i] = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+        continue;
+      }
+
+      // tasks created by create(...) are always self_type, so we can skip the virtual call here
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      ret_codes[i] = task_inst->self_type::start(unhandled, priv_data, EN_TS_WAITING);
+#else
+      ret_codes[i] = task_inst->self_type::start(priv_data, EN_TS_WAITING);
+#endif
+      if (LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS == ret_codes[i]) {
+        ++ret;
+      }
+    }
+
+    return ret;
+  }
+
   int yield(void **priv_data) override {
     if (!coroutine_obj_) {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_INITED;
@@ -555,13 +998,21 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int cancel(void *priv_data) override {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = cancel(eptrs, priv_data);
     maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   virtual int cancel(std::list<std::exception_ptr> &unhandled, void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = cancel(eptrs, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  virtual int cancel(unhandled_exception_list &unhandled, void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int cancel(void *priv_data) override {
 #endif
@@ -588,14 +1039,23 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int kill(enum EN_TASK_STATUS status, void *priv_data) override {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = kill(eptrs, status, priv_data);
     maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   virtual int kill(std::list<std::exception_ptr> &unhandled, enum EN_TASK_STATUS status,
                    void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = kill(eptrs, status, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  virtual int kill(unhandled_exception_list &unhandled, enum EN_TASK_STATUS status,
+                   void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int kill(enum EN_TASK_STATUS status, void *priv_data) override {
 #endif
@@ -665,9 +1125,25 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
     return coroutine_obj_->get_private_buffer_size() - sizeof(impl::task_impl *);
   }
 
+  /**
+   * @brief get private data
+   * @note the task should be created by create_with_private_data<TPRIVATE_DATA>(...)
+   * @return private data, or nullptr if private buffer is too small
+   */
+  template <typename TPRIVATE_DATA>
+  inline TPRIVATE_DATA *get_private_data() {
+    return impl::task_impl::get_private_data_address<TPRIVATE_DATA>(get_private_buffer(), get_private_buffer_size());
+  }
+
   inline size_t use_count() const { return ref_count_.load(); }
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  UTIL_FORCEINLINE static void maybe_rethrow(unhandled_exception_list &eptrs) {
+    for (unhandled_exception_list::iterator iter = eptrs.begin(); iter != eptrs.end(); ++iter) {
+      coroutine_type::maybe_rethrow(*iter);
+    }
+  }
+
   UTIL_FORCEINLINE static void maybe_rethrow(std::list<std::exception_ptr> &eptrs) {
     for (std::list<std::exception_ptr>::iterator iter = eptrs.begin(); iter != eptrs.end(); ++iter) {
       coroutine_type::maybe_rethrow(*iter);
@@ -677,23 +1153,58 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
  private:
   task(const task &) = delete;
 
+  template <typename TPRIVATE_DATA>
+  static void destroy_private_data(void *buffer, size_t buffer_size) {
+    placement_destroy<TPRIVATE_DATA>(impl::task_impl::get_private_data_address<TPRIVATE_DATA>(buffer, buffer_size));
+  }
+
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-  void active_next_tasks(std::list<std::exception_ptr> &unhandled) LIBCOPP_MACRO_NOEXCEPT {
+  static void active_next_task(const ptr_type &next_task, void *priv_data,
+                               unhandled_exception_list &unhandled) LIBCOPP_MACRO_NOEXCEPT {
+#else
+  static void active_next_task(const ptr_type &next_task, void *priv_data) {
+#endif
+    if (!next_task || EN_TS_INVALID == next_task->get_status()) {
+      return;
+    }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    if (next_task->get_status() < EN_TS_RUNNING) {
+      next_task->start(unhandled, priv_data);
+    } else {
+      next_task->resume(unhandled, priv_data);
+    }
+#else
+    if (next_task->get_status() < EN_TS_RUNNING) {
+      next_task->start(priv_data);
+    } else {
+      next_task->resume(priv_data);
+    }
+#endif
+  }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  void active_next_tasks(unhandled_exception_list &unhandled) LIBCOPP_MACRO_NOEXCEPT {
 #else
   void active_next_tasks() {
 #endif
-    std::list<std::pair<ptr_type, void *> > next_list;
+    ptr_type inline_task;
+    void *inline_priv_data = nullptr;
+    next_task_node *spill_head;
 #if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
     void *manager_ptr;
     void (*manager_fn)(void *, self_type &);
 #endif
-    // first, lock and swap container
+    // first, take the inline continuation, then lock and take spilled continuations
+    next_list_.try_pop_inline(inline_task, inline_priv_data);
     {
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
       LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
           inner_action_lock_);
 #endif
-      next_list.swap(next_list_.member_list_);
+      spill_head = next_list_.spill_head;
+      next_list_.spill_head = nullptr;
+      next_list_.spill_tail = nullptr;
 #if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
       manager_ptr = binding_manager_ptr_;
       manager_fn = binding_manager_fn_;
@@ -702,26 +1213,31 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
 #endif
     }
 
-    // then, do all the pending tasks
-    for (typename std::list<std::pair<ptr_type, void *> >::iterator iter = next_list.begin(); iter != next_list.end();
-         ++iter) {
-      if (!iter->first || EN_TS_INVALID == iter->first->get_status()) {
-        continue;
-      }
+    // then, do all the pending tasks in the order they were added
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    active_next_task(inline_task, inline_priv_data, unhandled);
+#else
+    active_next_task(inline_task, inline_priv_data);
+#endif
+    inline_task.reset();
 
+    while (nullptr != spill_head) {
+      next_task_node *node = spill_head;
+      spill_head = node->next;
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-      if (iter->first->get_status() < EN_TS_RUNNING) {
-        iter->first->start(unhandled, iter->second);
+      if (nullptr != node->callback) {
+        (*node->callback)(node->priv_data, *this, unhandled);
       } else {
-        iter->first->resume(unhandled, iter->second);
+        active_next_task(node->task, node->priv_data, unhandled);
       }
 #else
-      if (iter->first->get_status() < EN_TS_RUNNING) {
-        iter->first->start(iter->second);
+      if (nullptr != node->callback) {
+        (*node->callback)(node->priv_data, *this);
       } else {
-        iter->first->resume(iter->second);
+        active_next_task(node->task, node->priv_data);
       }
 #endif
+      next_task_node_pool::instance().deallocate(node);
     }
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_COROUTINE) && LIBCOPP_MACRO_ENABLE_STD_COROUTINE
@@ -738,7 +1254,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
 
   int _notify_finished(
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-      std::list<std::exception_ptr> &unhandled,
+      unhandled_exception_list &unhandled,
 #endif
       void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
     // first, make sure coroutine finished.
@@ -795,9 +1311,22 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
         (*p->action_destroy_fn_)(action_ptr);
       }
 
+      // private data is destroyed after task, the task may be killed in destructor and still use it
+      void (*private_data_destroy_fn)(void *, size_t) = p->private_data_destroy_fn_;
+      void *private_buffer = p->get_private_buffer();
+      size_t private_buffer_size = p->get_private_buffer_size();
+
+      // arena is destroyed after private data, which may still hold memory allocated from it
+      task_arena *arena = p->_detach_arena();
+
       // then, destruct task
       p->~task();
 
+      if (nullptr != private_data_destroy_fn) {
+        (*private_data_destroy_fn)(private_buffer, private_buffer_size);
+      }
+      task_arena::destroy(arena);
+
       // at last, destroy the coroutine and maybe recycle the stack space
       coro.reset();
     }
@@ -923,18 +1452,24 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task : public impl::task_impl {
  private:
   size_t stack_size_;
   typename coroutine_type::ptr_type coroutine_obj_;
-  task_group next_list_;
+  next_task_list next_list_;
 
   // ============== action information ==============
   void (*action_destroy_fn_)(void *);
+  void (*private_data_destroy_fn_)(void *, size_t);
 
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t> ref_count_; /** ref_count **/
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock inner_action_lock_;
+  // scheduling state in task_executor
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<uint32_t> executor_state_;
 #else
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
       LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<size_t> >
       ref_count_; /** ref_count **/
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<uint32_t> >
+      executor_state_;
 #endif
 
   // ============== binding to task manager ==============
@@ -0,0 +1,196 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <cstddef>
+#include <new>
+#if defined(__has_include)
+#  if __has_include(<memory_resource>) && \
+      ((defined(__cplusplus) && __cplusplus >= 201703L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#    include <memory_resource>
+#  endif
+#endif
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#if defined(__cpp_lib_memory_resource) && __cpp_lib_memory_resource >= 201603L
+#  define LIBCOTASK_MACRO_ENABLE_TASK_ARENA_PMR 1
+#endif
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief bump allocator owned by a task
+ * @note Memory is allocated from blocks which are recycled by a global pool, and the arena itself is placed at the head
+ *       of its first block. Memory is not freed by deallocate(...) except the last allocation, all blocks except the
+ *       first one are returned to pool at once when the task is finished, and the first one is returned when the task
+ *       is destroyed. Objects which outlive the task may still deallocate from the arena, but must not access the
+ *       released memory any more.
+ * @note It's not thread-safe, it should only be used by the owner task.
+ */
+class UTIL_SYMBOL_VISIBLE task_arena {
+ public:
+  // size of pooled block, larger allocations use dedicated blocks
+  static constexpr const size_t BLOCK_SIZE = 8192;
+
+  /**
+   * @brief create a task arena
+   * @return arena, or nullptr if failed to allocate memory
+   */
+  static LIBCOPP_COTASK_API task_arena *create() LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief destroy a task arena and recycle all blocks
+   * @param arena arena created by create()
+   */
+  static LIBCOPP_COTASK_API void destroy(task_arena *arena) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief allocate memory
+   * @param bytes size
+   * @param alignment alignment, it must be power of 2
+   * @return address, or nullptr if failed
+   */
+  LIBCOPP_COTASK_API void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief deallocate memory, only the last allocation in current block will be reused
+   * @param p address
+   * @param bytes size
+   */
+  LIBCOPP_COTASK_API void deallocate(void *p, size_t bytes) LIBCOPP_MACRO_NOEXCEPT;
+
+  /**
+   * @brief free all allocations, only the first block is kept
+   */
+  LIBCOPP_COTASK_API void release() LIBCOPP_MACRO_NOEXCEPT;
+
+  // bytes allocated and not deallocated
+  UTIL_FORCEINLINE size_t get_allocated_size() const LIBCOPP_MACRO_NOEXCEPT { return allocated_size_; }
+
+  // blocks used, including the first one
+  UTIL_FORCEINLINE size_t get_block_count() const LIBCOPP_MACRO_NOEXCEPT { return block_count_; }
+
+ private:
+  struct block_header {
+    block_header *next;
+    size_t size;
+  };
+
+  task_arena(unsigned char *begin, unsigned char *end) LIBCOPP_MACRO_NOEXCEPT;
+  ~task_arena();
+
+  task_arena(const task_arena &) = delete;
+  task_arena &operator=(const task_arena &) = delete;
+
+ private:
+  block_header *blocks_;  // blocks except the first one
+  unsigned char *first_begin_;
+  unsigned char *cursor_;
+  unsigned char *end_;
+  size_t allocated_size_;
+  size_t block_count_;
+};
+
+/**
+ * @brief allocator using task_arena, it can be used by STL containers
+ */
+template <typename T>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_arena_allocator {
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = task_arena_allocator<U>;
+  };
+
+  explicit task_arena_allocator(task_arena *arena) LIBCOPP_MACRO_NOEXCEPT : arena_(arena) {}
+
+  template <typename U>
+  task_arena_allocator(const task_arena_allocator<U> &other) LIBCOPP_MACRO_NOEXCEPT : arena_(other.get_arena()) {}
+
+  T *allocate(size_t n) {
+    void *ret = nullptr;
+    if (nullptr != arena_) {
+      ret = arena_->allocate(n * sizeof(T), alignof(T));
+    }
+#if defined(LIBCOPP_MACRO_ENABLE_EXCEPTION) && LIBCOPP_MACRO_ENABLE_EXCEPTION
+    if (nullptr == ret) {
+      throw std::bad_alloc();
+    }
+#endif
+    return reinterpret_cast<T *>(ret);
+  }
+
+  void deallocate(T *p, size_t n) LIBCOPP_MACRO_NOEXCEPT {
+    if (nullptr != arena_) {
+      arena_->deallocate(p, n * sizeof(T));
+    }
+  }
+
+  UTIL_FORCEINLINE task_arena *get_arena() const LIBCOPP_MACRO_NOEXCEPT { return arena_; }
+
+ private:
+  task_arena *arena_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const task_arena_allocator<T> &l, const task_arena_allocator<U> &r) LIBCOPP_MACRO_NOEXCEPT {
+  return l.get_arena() == r.get_arena();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const task_arena_allocator<T> &l, const task_arena_allocator<U> &r) LIBCOPP_MACRO_NOEXCEPT {
+  return l.get_arena() != r.get_arena();
+}
+
+#if defined(LIBCOTASK_MACRO_ENABLE_TASK_ARENA_PMR) && LIBCOTASK_MACRO_ENABLE_TASK_ARENA_PMR
+/**
+ * @brief std::pmr::memory_resource using task_arena
+ * @note usage: task_arena_memory_resource mr(this_task::get_arena()); std::pmr::vector<int> v(&mr);
+ */
+class LIBCOPP_COTASK_API_HEAD_ONLY task_arena_memory_resource : public std::pmr::memory_resource {
+ public:
+  explicit task_arena_memory_resource(task_arena *arena) LIBCOPP_MACRO_NOEXCEPT : arena_(arena) {}
+
+  UTIL_FORCEINLINE task_arena *get_arena() const LIBCOPP_MACRO_NOEXCEPT { return arena_; }
+
+ private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    void *ret = nullptr;
+    if (nullptr != arena_) {
+      ret = arena_->allocate(bytes, alignment);
+    }
+#  if defined(LIBCOPP_MACRO_ENABLE_EXCEPTION) && LIBCOPP_MACRO_ENABLE_EXCEPTION
+    if (nullptr == ret) {
+      throw std::bad_alloc();
+    }
+#  endif
+    return ret;
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t) override {
+    if (nullptr != arena_) {
+      arena_->deallocate(p, bytes);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const LIBCOPP_MACRO_NOEXCEPT override {
+    return this == &other;
+  }
+
+ private:
+  task_arena *arena_;
+};
+#endif
+
+LIBCOPP_COTASK_NAMESPACE_END
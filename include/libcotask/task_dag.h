@@ -0,0 +1,384 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/atomic_int_type.h>
+#include <libcopp/utils/errno.h>
+#include <libcopp/utils/features.h>
+#include <libcopp/utils/lock_holder.h>
+#include <libcopp/utils/spin_lock.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/task.h"
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief run tasks by dependency graph
+ * @note Every node has a counter of unfinished dependencies, and it's dispatched once the counter reaches zero by the
+ *       thread which finishes its last dependency. So independent branches run in parallel when they are dispatched to
+ *       a thread pool such as task_executor, and there is no extra coroutine switch for edges.
+ * @note A DAG can only run once, and it keeps itself alive until all nodes are finished. Tasks must be created but not
+ *       started when run() is called.
+ */
+template <typename TCO_MACRO = macro_coroutine>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_dag : public std::enable_shared_from_this<task_dag<TCO_MACRO>> {
+ public:
+  using self_type = task_dag<TCO_MACRO>;
+  using ptr_type = std::shared_ptr<self_type>;
+  using task_type = task<TCO_MACRO>;
+  using task_ptr_type = typename task_type::ptr_type;
+  using clock_type = std::chrono::steady_clock;
+  using time_point_type = clock_type::time_point;
+  using duration_type = clock_type::duration;
+
+  /**
+   * @brief dispatcher of ready tasks, it's called by the thread which finishes the last dependency
+   */
+  using dispatcher_type = std::function<void(const task_ptr_type &)>;
+
+  static constexpr const size_t npos = std::numeric_limits<size_t>::max();
+
+  struct node_timing_type {
+    time_point_type ready_time;   // all dependencies are finished and the node is dispatched
+    time_point_type finish_time;  // task is finished
+
+    inline duration_type get_duration() const LIBCOPP_MACRO_NOEXCEPT { return finish_time - ready_time; }
+  };
+
+  struct critical_path_type {
+    std::vector<size_t> nodes;
+    duration_type duration;
+  };
+
+ private:
+  struct constructor_delegator {};
+
+  struct node_type {
+    self_type *owner;
+    size_t index;
+    task_ptr_type task_inst;
+    std::string name;
+    std::vector<size_t> successors;
+    size_t dependency_count;
+    node_timing_type timing;
+  };
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+  using counter_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t>;
+#else
+  using counter_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<size_t> >;
+#endif
+
+  task_dag(const task_dag &) = delete;
+  task_dag &operator=(const task_dag &) = delete;
+
+ public:
+  explicit task_dag(constructor_delegator) : started_(false) {}
+
+  /**
+   * @brief create a new task DAG
+   * @return smart pointer of task DAG
+   */
+  static ptr_type create() { return std::make_shared<self_type>(constructor_delegator()); }
+
+  /**
+   * @brief add a task as a node
+   * @param task_inst task, it must not be started
+   * @param name name of this node, used by reports
+   * @return index of the node, or npos if failed
+   */
+  size_t add_node(const task_ptr_type &task_inst, std::string name = std::string()) {
+    if (!task_inst || started_) {
+      return npos;
+    }
+
+    nodes_.push_back(node_type());
+    node_type &node = nodes_.back();
+    node.owner = this;
+    node.index = nodes_.size() - 1;
+    node.task_inst = task_inst;
+    node.name = std::move(name);
+    node.dependency_count = 0;
+    return node.index;
+  }
+
+  /**
+   * @brief add a dependency edge, the node to will be dispatched after the node from finished
+   * @param from index of the dependency
+   * @param to index of the dependent
+   * @return 0 or error code
+   */
+  int add_edge(size_t from, size_t to) {
+    if (started_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING;
+    }
+
+    if (from >= nodes_.size() || to >= nodes_.size() || from == to) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    nodes_[from].successors.push_back(to);
+    ++nodes_[to].dependency_count;
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief run all nodes
+   * @param dispatcher dispatcher of ready tasks, if it's empty, ready tasks are queued and run by run_ready()
+   * @note if dispatcher is empty, run_ready() is called once before this function returns
+   * @return 0 or error code, COPP_EC_TASK_DAG_HAS_CYCLE if there is a cycle
+   */
+  int run(dispatcher_type dispatcher = dispatcher_type()) {
+    if (started_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_INITED;
+    }
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      if (EN_TS_CREATED != nodes_[i].task_inst->get_status()) {
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+      }
+    }
+
+    int ret = build_topological_order();
+    if (ret < 0) {
+      return ret;
+    }
+
+    started_ = true;
+    dispatcher_ = std::move(dispatcher);
+    start_time_ = clock_type::now();
+    if (nodes_.empty()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    }
+
+    pending_counters_.reset(new counter_type[nodes_.size()]);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      pending_counters_[i].store(nodes_[i].dependency_count);
+    }
+    holder_ = this->shared_from_this();
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      nodes_[i].task_inst->add_finish_callback(on_node_finished, &nodes_[i]);
+    }
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      if (0 == nodes_[i].dependency_count) {
+        dispatch(nodes_[i]);
+      }
+    }
+
+    if (!dispatcher_) {
+      run_ready();
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief start queued ready tasks on current thread, only used when run() is called without dispatcher
+   * @note tasks which are ready when running are also started
+   * @param max_count max number of tasks to start
+   * @return number of started tasks
+   */
+  size_t run_ready(size_t max_count = std::numeric_limits<size_t>::max()) {
+    size_t ret = 0;
+    while (ret < max_count) {
+      size_t index;
+      {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+            ready_lock_);
+#endif
+        if (ready_queue_.empty()) {
+          break;
+        }
+        index = ready_queue_.front();
+        ready_queue_.pop_front();
+      }
+
+      // hold the task, the DAG may release all nodes when the last one is finished
+      task_ptr_type task_inst = nodes_[index].task_inst;
+      ++ret;
+      task_inst->start();
+    }
+
+    return ret;
+  }
+
+  inline size_t get_node_count() const LIBCOPP_MACRO_NOEXCEPT { return nodes_.size(); }
+  inline size_t get_finished_count() const LIBCOPP_MACRO_NOEXCEPT { return finished_count_.load(); }
+  inline bool is_started() const LIBCOPP_MACRO_NOEXCEPT { return started_; }
+  inline bool is_completed() const LIBCOPP_MACRO_NOEXCEPT {
+    return started_ && finished_count_.load() >= nodes_.size();
+  }
+
+  inline const task_ptr_type &get_node_task(size_t index) const { return nodes_[index].task_inst; }
+  inline const std::string &get_node_name(size_t index) const { return nodes_[index].name; }
+
+  /**
+   * @brief get timing of a node, it's available after the node is finished
+   */
+  inline const node_timing_type &get_node_timing(size_t index) const { return nodes_[index].timing; }
+
+  /**
+   * @return duration from run() to the last node finished, available after is_completed() returns true
+   */
+  duration_type get_total_duration() const LIBCOPP_MACRO_NOEXCEPT {
+    time_point_type finish_time = start_time_;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i].timing.finish_time > finish_time) {
+        finish_time = nodes_[i].timing.finish_time;
+      }
+    }
+    return finish_time - start_time_;
+  }
+
+  /**
+   * @brief get the path with the longest total duration of nodes
+   * @note duration of a node is from dispatched to finished, so it contains the waiting time in dispatcher
+   * @return critical path, empty if the DAG is not completed
+   */
+  critical_path_type get_critical_path() const {
+    critical_path_type ret;
+    ret.duration = duration_type::zero();
+    if (!is_completed() || nodes_.empty()) {
+      return ret;
+    }
+
+    // distance[i] is the longest duration of paths which end with node i
+    std::vector<duration_type> distance;
+    std::vector<size_t> previous;
+    distance.resize(nodes_.size(), duration_type::zero());
+    previous.resize(nodes_.size(), npos);
+
+    size_t last = npos;
+    for (size_t i = 0; i < topological_order_.size(); ++i) {
+      size_t index = topological_order_[i];
+      distance[index] += nodes_[index].timing.get_duration();
+      if (npos == last || distance[index] > distance[last]) {
+        last = index;
+      }
+
+      for (size_t j = 0; j < nodes_[index].successors.size(); ++j) {
+        size_t successor = nodes_[index].successors[j];
+        if (npos == previous[successor] || distance[index] > distance[successor]) {
+          distance[successor] = distance[index];
+          previous[successor] = index;
+        }
+      }
+    }
+
+    ret.duration = distance[last];
+    for (size_t index = last; npos != index; index = previous[index]) {
+      ret.nodes.push_back(index);
+    }
+    std::reverse(ret.nodes.begin(), ret.nodes.end());
+    return ret;
+  }
+
+ private:
+  int build_topological_order() {
+    std::vector<size_t> dependency_count;
+    dependency_count.reserve(nodes_.size());
+    topological_order_.clear();
+    topological_order_.reserve(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      dependency_count.push_back(nodes_[i].dependency_count);
+      if (0 == nodes_[i].dependency_count) {
+        topological_order_.push_back(i);
+      }
+    }
+
+    for (size_t i = 0; i < topological_order_.size(); ++i) {
+      const node_type &node = nodes_[topological_order_[i]];
+      for (size_t j = 0; j < node.successors.size(); ++j) {
+        if (0 == --dependency_count[node.successors[j]]) {
+          topological_order_.push_back(node.successors[j]);
+        }
+      }
+    }
+
+    if (topological_order_.size() != nodes_.size()) {
+      topological_order_.clear();
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_DAG_HAS_CYCLE;
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  void dispatch(node_type &node) {
+    node.timing.ready_time = clock_type::now();
+    if (dispatcher_) {
+      dispatcher_(node.task_inst);
+      return;
+    }
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+        ready_lock_);
+#endif
+    ready_queue_.push_back(node.index);
+  }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  static void on_node_finished(void *callback_data, task_type &, unhandled_exception_list &) {
+#else
+  static void on_node_finished(void *callback_data, task_type &) {
+#endif
+    node_type *node = reinterpret_cast<node_type *>(callback_data);
+    self_type *self = node->owner;
+    node->timing.finish_time = clock_type::now();
+
+    for (size_t i = 0; i < node->successors.size(); ++i) {
+      size_t successor = node->successors[i];
+      if (0 == --self->pending_counters_[successor]) {
+        self->dispatch(self->nodes_[successor]);
+      }
+    }
+
+    if (++self->finished_count_ >= self->nodes_.size()) {
+      // all nodes are finished, the DAG may be destroyed when this function returns
+      ptr_type holder;
+      holder.swap(self->holder_);
+    }
+  }
+
+ private:
+  std::vector<node_type> nodes_;
+  std::vector<size_t> topological_order_;
+  std::unique_ptr<counter_type[]> pending_counters_;
+  counter_type finished_count_;
+  bool started_;
+  dispatcher_type dispatcher_;
+  time_point_type start_time_;
+  ptr_type holder_;
+
+  std::deque<size_t> ready_queue_;
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock ready_lock_;
+#endif
+};
+
+template <typename TCO_MACRO>
+constexpr const size_t task_dag<TCO_MACRO>::npos;
+
+LIBCOPP_COTASK_NAMESPACE_END
@@ -0,0 +1,743 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/features.h>
+#include <libcopp/utils/lock_holder.h>
+#include <libcopp/utils/spin_lock.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/task.h"
+#include "libcotask/this_task.h"
+
+// workers need thread local storage and multi-thread support of this_task
+#if defined(COPP_MACRO_THREAD_LOCAL) && (!defined(LIBCOPP_LOCK_DISABLE_THIS_MT) || !(LIBCOPP_LOCK_DISABLE_THIS_MT))
+#  define LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR 1
+#else
+#  define LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR 0
+#endif
+
+#if LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * @brief Chase-Lev work-stealing deque
+ * @note Only the owner thread can call push(...) and pop(), which work on the bottom like a stack. Any thread can
+ *       call steal(), which takes the oldest element from the top. The ring buffer is grown by the owner and old
+ *       buffers are kept until the deque is destroyed, because thieves may still read from them.
+ * @see Chase & Lev, "Dynamic Circular Work-Stealing Deque", SPAA 2005
+ * @see Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013
+ */
+template <class T>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_work_stealing_deque {
+ private:
+  struct ring_type {
+    int64_t mask;
+    std::unique_ptr<std::atomic<T *>[]> slots;
+
+    explicit ring_type(int64_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<T *>[static_cast<size_t>(capacity)]) {}
+
+    inline T *get(int64_t index) const LIBCOPP_MACRO_NOEXCEPT {
+      return slots[static_cast<size_t>(index & mask)].load(std::memory_order_relaxed);
+    }
+
+    inline void put(int64_t index, T *value) LIBCOPP_MACRO_NOEXCEPT {
+      slots[static_cast<size_t>(index & mask)].store(value, std::memory_order_relaxed);
+    }
+  };
+
+ public:
+  using value_type = T;
+
+  explicit task_work_stealing_deque(size_t capacity = 256) : top_(0), bottom_(0) {
+    int64_t real_capacity = 16;
+    while (real_capacity < static_cast<int64_t>(capacity)) {
+      real_capacity <<= 1;
+    }
+
+    rings_.push_back(std::unique_ptr<ring_type>(new ring_type(real_capacity)));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief push a element into the bottom, can only be called by the owner thread
+   */
+  void push(T *value) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    ring_type *ring = ring_.load(std::memory_order_relaxed);
+    if (b - t > ring->mask) {
+      ring = grow(ring, t, b);
+    }
+
+    ring->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief pop the last pushed element, can only be called by the owner thread
+   * @return the element or nullptr when it's empty
+   */
+  T *pop() LIBCOPP_MACRO_NOEXCEPT {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    ring_type *ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T *ret = ring->get(b);
+    if (t == b) {
+      // the last element, race with thieves
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        ret = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief steal the oldest element, can be called by any thread
+   * @return the element or nullptr when it's empty or another thread won the race
+   */
+  T *steal() LIBCOPP_MACRO_NOEXCEPT {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+
+    ring_type *ring = ring_.load(std::memory_order_acquire);
+    T *ret = ring->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return ret;
+  }
+
+  /**
+   * @return approximate size, it may be changed by other threads at any time
+   */
+  size_t size() const LIBCOPP_MACRO_NOEXCEPT {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  inline bool empty() const LIBCOPP_MACRO_NOEXCEPT { return 0 == size(); }
+
+  inline size_t capacity() const LIBCOPP_MACRO_NOEXCEPT {
+    return static_cast<size_t>(ring_.load(std::memory_order_relaxed)->mask + 1);
+  }
+
+ private:
+  task_work_stealing_deque(const task_work_stealing_deque &) = delete;
+  task_work_stealing_deque &operator=(const task_work_stealing_deque &) = delete;
+
+  ring_type *grow(ring_type *ring, int64_t t, int64_t b) {
+    std::unique_ptr<ring_type> new_ring(new ring_type((ring->mask + 1) << 1));
+    for (int64_t i = t; i < b; ++i) {
+      new_ring->put(i, ring->get(i));
+    }
+
+    ring_type *ret = new_ring.get();
+    rings_.push_back(std::move(new_ring));
+    ring_.store(ret, std::memory_order_release);
+    return ret;
+  }
+
+ private:
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<ring_type *> ring_;
+  std::vector<std::unique_ptr<ring_type>> rings_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief multi-thread executor of task<>, every worker thread has a work-stealing deque and idle workers steal tasks
+ *        from others
+ * @note Tasks posted by workers are pushed into the deque of current worker, and tasks posted by other threads are
+ *       pushed into a shared injection queue. A task can run on any worker and may be moved to another worker after
+ *       it yields, so it should not keep thread local states across yield. this_task::get_task() works as usual.
+ * @note The executor holds a reference of every task posted until it's started or resumed. Posting a task which is
+ *       already in the executor does nothing, and posting a task which is being run by a worker requests another
+ *       resume, the task will be posted again after it's switched out. So it's safe for other threads to post a task
+ *       back before it yields.
+ */
+template <typename TCO_MACRO = macro_coroutine>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_executor {
+ public:
+  using task_type = task<TCO_MACRO>;
+  using task_ptr_type = typename task_type::ptr_type;
+  using self_type = task_executor<TCO_MACRO>;
+  using ptr_type = std::shared_ptr<self_type>;
+
+ private:
+  enum {
+    // check the injection queue every N tasks, so tasks posted by other threads and yielded tasks will not starve
+    INJECTION_CHECK_INTERVAL = 61,
+    INJECTION_MAX_BATCH = 64,
+    IDLE_SPIN_TIMES = 64,
+  };
+
+  // scheduling state of task, stored in task::executor_state_
+  enum task_state_type {
+    EN_TES_IDLE = 0,
+    EN_TES_SCHEDULED = 1,
+    EN_TES_RUNNING = 2,
+    // resume requested by post(...) when it's running
+    EN_TES_RESUME_REQUESTED = 3,
+  };
+
+  struct worker_type {
+    self_type *owner;
+    size_t index;
+    uint64_t random_seed;
+    size_t schedule_tick;
+    bool yield_requested;
+    detail::task_work_stealing_deque<task_type> deque;
+    std::atomic<uint64_t> executed_count;
+    std::atomic<uint64_t> steal_count;
+    std::thread thread;
+
+    worker_type(self_type *o, size_t i)
+        : owner(o),
+          index(i),
+          random_seed(static_cast<uint64_t>(i) * static_cast<uint64_t>(0x9E3779B97F4A7C15ULL) + 1),
+          schedule_tick(0),
+          yield_requested(false),
+          executed_count(0),
+          steal_count(0) {}
+  };
+
+ public:
+  /**
+   * @brief create a executor
+   * @param worker_count worker thread count, use std::thread::hardware_concurrency() when it's 0
+   */
+  explicit task_executor(size_t worker_count = 0)
+      : running_(false), stopping_(false), injection_size_(0), pending_count_(0), sleeping_count_(0) {
+    if (0 == worker_count) {
+      worker_count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    if (0 == worker_count) {
+      worker_count = 1;
+    }
+
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+      workers_.push_back(std::unique_ptr<worker_type>(new worker_type(this, i)));
+    }
+  }
+
+  ~task_executor() { stop(); }
+
+  /**
+   * @brief create a new executor
+   * @param worker_count worker thread count, use std::thread::hardware_concurrency() when it's 0
+   * @return smart pointer of executor
+   */
+  static ptr_type create(size_t worker_count = 0) { return std::make_shared<self_type>(worker_count); }
+
+  /**
+   * @brief start all worker threads
+   * @return 0 or error code
+   */
+  int start() {
+    if (running_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_INITED;
+    }
+
+    running_ = true;
+    stopping_.store(false, std::memory_order_release);
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      worker_type *worker = workers_[i].get();
+      worker->thread = std::thread([this, worker]() { run_worker(*worker); });
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief stop and join all worker threads
+   * @note tasks which are not started or resumed yet will be released without running, this can not be called by
+   *       workers of this executor
+   */
+  void stop() {
+    if (running_) {
+      stopping_.store(true, std::memory_order_release);
+      {
+        std::lock_guard<std::mutex> guard(sleep_mutex_);
+        sleep_cv_.notify_all();
+      }
+
+      for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i]->thread.joinable()) {
+          workers_[i]->thread.join();
+        }
+      }
+      running_ = false;
+    }
+
+    // all workers are joined, it's safe to pop from their deques here
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      task_type *task_inst;
+      while (nullptr != (task_inst = workers_[i]->deque.pop())) {
+        set_task_state(*task_inst, EN_TES_IDLE);
+        finish_task(task_ptr_type(task_inst, false));
+      }
+    }
+
+    std::deque<task_type *> injection_queue;
+    {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          injection_lock_};
+#  endif
+      injection_queue.swap(injection_queue_);
+      injection_size_.store(0, std::memory_order_relaxed);
+    }
+    for (typename std::deque<task_type *>::iterator iter = injection_queue.begin(); iter != injection_queue.end();
+         ++iter) {
+      set_task_state(**iter, EN_TES_IDLE);
+      finish_task(task_ptr_type(*iter, false));
+    }
+  }
+
+  /**
+   * @brief post a task to run, task with EN_TS_CREATED will be started and others will be resumed
+   * @note it's pushed into the deque of current worker if it's called by a worker of this executor
+   * @note if the task is being run by a worker, it will be posted again after it's switched out
+   * @param task_inst task to run
+   * @return 0 or error code
+   */
+  int post(const task_ptr_type &task_inst) {
+    if (!task_inst) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (task_inst->get_status() >= EN_TS_DONE) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_FINISHED;
+    }
+
+    uint32_t state = task_inst->executor_state_.load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire);
+    while (true) {
+      uint32_t desired;
+      if (static_cast<uint32_t>(EN_TES_IDLE) == state) {
+        desired = static_cast<uint32_t>(EN_TES_SCHEDULED);
+      } else if (static_cast<uint32_t>(EN_TES_RUNNING) == state) {
+        desired = static_cast<uint32_t>(EN_TES_RESUME_REQUESTED);
+      } else {
+        // already in the executor or another resume is requested
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+      }
+
+      if (task_inst->executor_state_.compare_exchange_strong(
+              state, desired, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+              LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+        // the worker running it will post it again
+        if (static_cast<uint32_t>(EN_TES_RESUME_REQUESTED) == desired) {
+          return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+        }
+        break;
+      }
+    }
+
+    pending_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // the reference is moved into the queue, and will be moved back by run_task(...)
+    task_ptr_type holder = task_inst;
+    task_type *raw = holder.detach();
+    worker_type *worker = current_worker();
+    if (nullptr != worker && worker->owner == this) {
+      worker->deque.push(raw);
+    } else {
+      push_injection(raw);
+    }
+
+    wakeup_one();
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief yield current task and post it to the executor again
+   * @param priv_data private data, will be passed to yield
+   * @note the task will be pushed into the injection queue after it's yielded, so all other tasks get a chance to run
+   * @return 0 or error code
+   */
+  static int yield(void **priv_data = nullptr) {
+    worker_type *worker = current_worker();
+    if (nullptr == worker) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_RUNNING;
+    }
+
+    impl::task_impl *task_inst = this_task::get_task();
+    if (nullptr == task_inst) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_RUNNING;
+    }
+
+    // the task may be resumed by another worker, do not touch worker after yield
+    worker->yield_requested = true;
+    return task_inst->yield(priv_data);
+  }
+
+  /**
+   * @brief block until all posted tasks are finished or waiting to be posted again
+   * @note this can not be called by workers of this executor
+   * @exception if exception is enabled, it will throw the unhandled exceptions of tasks after all tasks are done
+   * @return 0 or error code
+   */
+  int wait_idle() {
+    if (!running_ && pending_count_.load(std::memory_order_acquire) > 0) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_RUNNING;
+    }
+
+    {
+      std::unique_lock<std::mutex> guard(idle_mutex_);
+      while (pending_count_.load(std::memory_order_acquire) > 0) {
+        idle_cv_.wait(guard);
+      }
+    }
+
+#  if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    unhandled_exception_list eptrs;
+    {
+#    if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          unhandled_lock_};
+#    endif
+      eptrs.swap(unhandled_);
+    }
+    task_type::maybe_rethrow(eptrs);
+#  endif
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @return the executor which current worker thread belongs to, nullptr if it's not called by a worker
+   */
+  static self_type *this_executor() LIBCOPP_MACRO_NOEXCEPT {
+    worker_type *worker = current_worker();
+    if (nullptr == worker) {
+      return nullptr;
+    }
+    return worker->owner;
+  }
+
+  inline bool is_running() const LIBCOPP_MACRO_NOEXCEPT { return running_; }
+
+  inline size_t get_worker_count() const LIBCOPP_MACRO_NOEXCEPT { return workers_.size(); }
+
+  /**
+   * @return count of tasks which are posted and not finished or waiting to be posted again
+   */
+  inline size_t get_pending_count() const LIBCOPP_MACRO_NOEXCEPT {
+    return pending_count_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @return total count of task runs by all workers
+   */
+  uint64_t get_executed_count() const LIBCOPP_MACRO_NOEXCEPT {
+    uint64_t ret = 0;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      ret += workers_[i]->executed_count.load(std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+  /**
+   * @return total count of tasks stolen from other workers
+   */
+  uint64_t get_steal_count() const LIBCOPP_MACRO_NOEXCEPT {
+    uint64_t ret = 0;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      ret += workers_[i]->steal_count.load(std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+ private:
+  task_executor(const task_executor &) = delete;
+  task_executor &operator=(const task_executor &) = delete;
+
+  static worker_type *&current_worker() LIBCOPP_MACRO_NOEXCEPT {
+    static COPP_MACRO_THREAD_LOCAL worker_type *ret = nullptr;
+    return ret;
+  }
+
+  void push_injection(task_type *task_inst) {
+    {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          injection_lock_};
+#  endif
+      injection_queue_.push_back(task_inst);
+      injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    }
+  }
+
+  // take a batch from the injection queue, the first one is returned and others are moved into the deque of worker
+  task_type *pop_injection(worker_type &worker) {
+    if (0 == injection_size_.load(std::memory_order_relaxed)) {
+      return nullptr;
+    }
+
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        injection_lock_};
+#  endif
+    if (injection_queue_.empty()) {
+      return nullptr;
+    }
+
+    size_t batch_size = injection_queue_.size() / workers_.size() + 1;
+    if (batch_size > INJECTION_MAX_BATCH) {
+      batch_size = INJECTION_MAX_BATCH;
+    }
+
+    task_type *ret = injection_queue_.front();
+    injection_queue_.pop_front();
+    for (size_t i = 1; i < batch_size && !injection_queue_.empty(); ++i) {
+      worker.deque.push(injection_queue_.front());
+      injection_queue_.pop_front();
+    }
+    injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    return ret;
+  }
+
+  task_type *steal_task(worker_type &worker) {
+    if (workers_.size() <= 1) {
+      return nullptr;
+    }
+
+    // xorshift64, choose a random victim to start
+    worker.random_seed ^= worker.random_seed << 13;
+    worker.random_seed ^= worker.random_seed >> 7;
+    worker.random_seed ^= worker.random_seed << 17;
+    size_t start_index = static_cast<size_t>(worker.random_seed % workers_.size());
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      worker_type &victim = *workers_[(start_index + i) % workers_.size()];
+      if (&victim == &worker) {
+        continue;
+      }
+
+      task_type *ret = victim.deque.steal();
+      if (nullptr != ret) {
+        worker.steal_count.store(worker.steal_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return ret;
+      }
+    }
+
+    return nullptr;
+  }
+
+  task_type *find_task(worker_type &worker) {
+    task_type *ret;
+    if (0 == ++worker.schedule_tick % INJECTION_CHECK_INTERVAL) {
+      ret = pop_injection(worker);
+      if (nullptr != ret) {
+        return ret;
+      }
+    }
+
+    ret = worker.deque.pop();
+    if (nullptr != ret) {
+      return ret;
+    }
+
+    ret = pop_injection(worker);
+    if (nullptr != ret) {
+      return ret;
+    }
+
+    return steal_task(worker);
+  }
+
+  bool has_any_task() const LIBCOPP_MACRO_NOEXCEPT {
+    if (injection_size_.load(std::memory_order_relaxed) > 0) {
+      return true;
+    }
+
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      if (!workers_[i]->deque.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void wakeup_one() {
+    // pair with the fence in wait_for_task(), either the sleeper sees the new task or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_count_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> guard(sleep_mutex_);
+      sleep_cv_.notify_one();
+    }
+  }
+
+  void wait_for_task() {
+    std::unique_lock<std::mutex> guard(sleep_mutex_);
+    sleeping_count_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!stopping_.load(std::memory_order_acquire) && !has_any_task()) {
+      sleep_cv_.wait(guard);
+    }
+    sleeping_count_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  static inline void set_task_state(task_type &task_inst, task_state_type state) LIBCOPP_MACRO_NOEXCEPT {
+    task_inst.executor_state_.store(static_cast<uint32_t>(state),
+                                    LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+  }
+
+  // post a task which is switched out again, it's still pending
+  void repost_task(task_ptr_type &task_inst) {
+    set_task_state(*task_inst, EN_TES_SCHEDULED);
+    push_injection(task_inst.detach());
+    wakeup_one();
+  }
+
+  void finish_task(task_ptr_type &&task_inst) {
+    task_inst.reset();
+    if (1 == pending_count_.fetch_sub(1, std::memory_order_acq_rel)) {
+      std::lock_guard<std::mutex> guard(idle_mutex_);
+      idle_cv_.notify_all();
+    }
+  }
+
+  void run_task(worker_type &worker, task_type *raw) {
+    task_ptr_type task_inst(raw, false);
+    EN_TASK_STATUS status = task_inst->get_status();
+    // it's started or resumed out of this executor and not switched out yet, try it later
+    if (EN_TS_RUNNING == status) {
+      push_injection(task_inst.detach());
+      wakeup_one();
+      return;
+    }
+
+    if (EN_TS_CREATED == status || EN_TS_WAITING == status) {
+      set_task_state(*task_inst, EN_TES_RUNNING);
+      worker.yield_requested = false;
+#  if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      unhandled_exception_list eptrs;
+      task_inst->start(eptrs, nullptr, status);
+      if (!eptrs.empty()) {
+#    if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock>
+            lock_guard{unhandled_lock_};
+#    endif
+        unhandled_.append(eptrs);
+      }
+#  else
+      task_inst->start(nullptr, status);
+#  endif
+      worker.executed_count.store(worker.executed_count.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+
+      // like runtime.Gosched() of golang, yielded task is put into the global queue
+      if (worker.yield_requested && EN_TS_WAITING == task_inst->get_status()) {
+        worker.yield_requested = false;
+        repost_task(task_inst);
+        return;
+      }
+
+      // post(...) may be called by other threads before it's switched out
+      uint32_t expected = static_cast<uint32_t>(EN_TES_RUNNING);
+      if (task_inst->executor_state_.compare_exchange_strong(
+              expected, static_cast<uint32_t>(EN_TES_IDLE), LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+              LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+        finish_task(std::move(task_inst));
+        return;
+      }
+
+      if (EN_TS_WAITING == task_inst->get_status()) {
+        repost_task(task_inst);
+        return;
+      }
+    }
+
+    set_task_state(*task_inst, EN_TES_IDLE);
+    finish_task(std::move(task_inst));
+  }
+
+  void run_worker(worker_type &worker) {
+    current_worker() = &worker;
+
+    size_t idle_times = 0;
+    while (!stopping_.load(std::memory_order_acquire)) {
+      task_type *task_inst = find_task(worker);
+      if (nullptr != task_inst) {
+        idle_times = 0;
+        run_task(worker, task_inst);
+        continue;
+      }
+
+      if (++idle_times < IDLE_SPIN_TIMES) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      idle_times = 0;
+      wait_for_task();
+    }
+
+    current_worker() = nullptr;
+  }
+
+ private:
+  std::vector<std::unique_ptr<worker_type>> workers_;
+  bool running_;
+  std::atomic<bool> stopping_;
+
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock injection_lock_;
+  std::deque<task_type *> injection_queue_;
+  std::atomic<size_t> injection_size_;
+
+  std::atomic<size_t> pending_count_;
+  std::atomic<size_t> sleeping_count_;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+
+#  if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock unhandled_lock_;
+  unhandled_exception_list unhandled_;
+#  endif
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
+
+#endif
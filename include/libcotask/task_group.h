@@ -0,0 +1,296 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/atomic_int_type.h>
+#include <libcopp/utils/errno.h>
+#include <libcopp/utils/features.h>
+#include <libcopp/utils/lock_holder.h>
+#include <libcopp/utils/spin_lock.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/task.h"
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief join any number of child tasks in one parent task
+ * @note Every child decreases the pending counter when it's finished, and only the last one resumes the parent which
+ *       is waiting in join(), so the parent is woken up once no matter how many children there are.
+ * @note If the parent is killed when it's waiting in join(), or if it's finished after bind_parent(...), all unfinished
+ *       children are killed.
+ * @note Like task::await_task(...), the parent should be resumed by one thread at a time. Children can be finished by
+ *       other threads, if the last one is finished when the parent is still switching out in join(), it waits until
+ *       the parent is suspended or resumed by others and then resumes it.
+ */
+template <typename TCO_MACRO = macro_coroutine>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_group : public std::enable_shared_from_this<task_group<TCO_MACRO>> {
+ public:
+  using self_type = task_group<TCO_MACRO>;
+  using ptr_type = std::shared_ptr<self_type>;
+  using task_type = task<TCO_MACRO>;
+  using task_ptr_type = typename task_type::ptr_type;
+
+ private:
+  struct constructor_delegator {};
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+  using counter_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t>;
+  using flag_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<uint32_t>;
+#else
+  using counter_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<size_t> >;
+  using flag_type = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<uint32_t> >;
+#endif
+
+  using lock_holder_type =
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock>;
+
+  task_group(const task_group &) = delete;
+  task_group &operator=(const task_group &) = delete;
+
+ public:
+  explicit task_group(constructor_delegator) : pending_(0), wake_pending_(0) {}
+
+  /**
+   * @brief create a new task group
+   * @return smart pointer of task group
+   */
+  static ptr_type create() { return std::make_shared<self_type>(constructor_delegator()); }
+
+  /**
+   * @brief add a child task, the child can be started before or after it's added
+   * @param child child task
+   * @return 0 or error code
+   */
+  int add(const task_ptr_type &child) {
+    if (!child) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (child->is_exiting() || child->is_completed()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_IS_EXITING;
+    }
+
+    {
+      lock_holder_type lock_guard(lock_);
+      // keep group alive until all children are finished
+      if (0 == pending_.load()) {
+        holder_ = this->shared_from_this();
+      }
+      ++pending_;
+      children_.push_back(child);
+    }
+
+    // callback is called immediately if child is finished by another thread now
+    int ret = child->add_finish_callback(on_child_finished, this);
+    if (ret < 0) {
+      on_child_finished_internal();
+    }
+    return ret;
+  }
+
+  /**
+   * @brief add and start a child task
+   * @param child child task, it must not be started
+   * @param priv_data priv_data passed to start the child
+   * @return 0 or error code
+   */
+  int spawn(const task_ptr_type &child, void *priv_data = nullptr) {
+    if (child && EN_TS_CREATED != child->get_status()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    int ret = add(child);
+    if (ret < 0) {
+      return ret;
+    }
+
+    return child->start(priv_data);
+  }
+
+  /**
+   * @brief wait for all children in current task
+   * @note all unfinished children are killed if current task is killed when waiting
+   * @return 0 or error code
+   */
+  int join() {
+    task_type *parent = task_type::this_task();
+    if (nullptr == parent) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_NOT_IN_ACTION;
+    }
+
+    int ret = 0;
+    while (true) {
+      bool exiting = parent->is_exiting();
+      bool finished;
+      {
+        lock_holder_type lock_guard(lock_);
+        // parent is running here, so the wakeup from the last child is received or not needed any more
+        waiting_parent_.reset();
+        wake_pending_.store(0, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+
+        finished = 0 == pending_.load();
+        if (!exiting && !finished) {
+          waiting_parent_ = task_ptr_type(parent);
+        }
+      }
+
+      if (exiting) {
+        cancel_all();
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_IS_EXITING;
+      }
+
+      if (finished) {
+        break;
+      }
+
+      ret = parent->yield(nullptr);
+    }
+
+    return ret;
+  }
+
+  /**
+   * @brief kill all unfinished children
+   * @return count of killed children
+   */
+  size_t cancel_all() {
+    std::vector<task_ptr_type> children;
+    {
+      lock_holder_type lock_guard(lock_);
+      children = children_;
+    }
+
+    size_t ret = 0;
+    for (size_t i = 0; i < children.size(); ++i) {
+      if (children[i]->is_exiting() || children[i]->is_completed()) {
+        continue;
+      }
+
+      if (children[i]->kill(EN_TS_KILLED, nullptr) >= 0) {
+        ++ret;
+      }
+    }
+
+    return ret;
+  }
+
+  /**
+   * @brief kill all unfinished children when parent is finished, killed or timeout
+   * @param parent parent task
+   * @return 0 or error code
+   */
+  int bind_parent(const task_ptr_type &parent) {
+    if (!parent) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    // the callback can not be removed, so it only holds a weak reference of this group
+    std::weak_ptr<self_type> *callback_data = new std::weak_ptr<self_type>(this->shared_from_this());
+    int ret = parent->add_finish_callback(on_parent_finished, callback_data);
+    if (ret < 0) {
+      delete callback_data;
+    }
+    return ret;
+  }
+
+  inline size_t get_pending_count() const LIBCOPP_MACRO_NOEXCEPT { return pending_.load(); }
+
+ private:
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  static void on_child_finished(void *callback_data, task_type &, unhandled_exception_list &unhandled) {
+    reinterpret_cast<self_type *>(callback_data)->on_child_finished_internal(unhandled);
+  }
+
+  static void on_parent_finished(void *callback_data, task_type &, unhandled_exception_list &) {
+#else
+  static void on_child_finished(void *callback_data, task_type &) {
+    reinterpret_cast<self_type *>(callback_data)->on_child_finished_internal();
+  }
+
+  static void on_parent_finished(void *callback_data, task_type &) {
+#endif
+    std::weak_ptr<self_type> *weak_self = reinterpret_cast<std::weak_ptr<self_type> *>(callback_data);
+    ptr_type self = weak_self->lock();
+    delete weak_self;
+
+    if (self) {
+      self->cancel_all();
+    }
+  }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  void on_child_finished_internal() {
+    unhandled_exception_list eptrs;
+    on_child_finished_internal(eptrs);
+    task_type::maybe_rethrow(eptrs);
+  }
+
+  void on_child_finished_internal(unhandled_exception_list &unhandled) {
+#else
+  void on_child_finished_internal() {
+#endif
+    if (0 != --pending_) {
+      return;
+    }
+
+    task_ptr_type waiting_parent;
+    ptr_type holder;
+    {
+      lock_holder_type lock_guard(lock_);
+      // another child may be added after the counter reaches zero
+      if (0 != pending_.load()) {
+        return;
+      }
+
+      waiting_parent.swap(waiting_parent_);
+      if (waiting_parent) {
+        wake_pending_.store(1, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+      }
+      children_.clear();
+      holder.swap(holder_);
+    }
+
+    // the only wakeup of parent. If this child is finished by another thread, parent may be still switching out in
+    //   join(), so retry until parent is suspended, or until it's resumed by others and takes the wakeup by itself.
+    unsigned char try_times = 0;
+    while (waiting_parent) {
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      int res = waiting_parent->resume(unhandled, nullptr);
+#else
+      int res = waiting_parent->resume(nullptr);
+#endif
+      if (LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING != res ||
+          0 == wake_pending_.load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+        break;
+      }
+
+      __LIBCOPP_UTIL_LOCK_SPIN_LOCK_WAIT(try_times++);
+    }
+  }
+
+ private:
+  counter_type pending_;
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock lock_;
+  std::vector<task_ptr_type> children_;
+  task_ptr_type waiting_parent_;
+  flag_type wake_pending_;
+  ptr_type holder_;
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
@@ -13,7 +13,9 @@
 #include <stdint.h>
 #include <algorithm>
 #include <ctime>
+#include <limits>
 #include <list>
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -29,11 +31,24 @@
 #include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
 // clang-format on
 
+#include "libcotask/impl/task_bounded_mailbox.h"
 #include "libcotask/task.h"
+#include "libcotask/impl/task_slot_map.h"
+#include "libcotask/impl/task_timer_wheel.h"
 #include "libcotask/task_promise.h"
 
 LIBCOPP_COTASK_NAMESPACE_BEGIN
 
+/**
+ * @brief counters of a ready class in task_manager
+ */
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_ready_class_stats {
+  uint32_t weight;      // max number of tasks run in a round of weighted round-robin
+  size_t ready_size;    // number of tasks waiting in this class
+  uint64_t mark_count;  // number of times tasks in this class are marked ready
+  uint64_t run_count;   // number of tasks in this class run by run_ready(...)
+};
+
 namespace detail {
 struct LIBCOPP_COTASK_API_HEAD_ONLY tickspec_t {
   time_t tv_sec; /* Seconds.  */
@@ -126,6 +141,11 @@ struct LIBCOPP_COTASK_API_HEAD_ONLY task_timer_node {
 #endif
 };
 
+inline uint64_t to_timer_wheel_nsec(time_t sec, int nsec) LIBCOPP_MACRO_NOEXCEPT {
+  int64_t ret = static_cast<int64_t>(sec) * 1000000000 + static_cast<int64_t>(nsec);
+  return ret > 0 ? static_cast<uint64_t>(ret) : 0;
+}
+
 template <class TTask>
 struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_node;
 
@@ -135,6 +155,13 @@ struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_node<task<TCO_MACRO>> {
 
   task_ptr_type task_;
   typename std::set<task_timer_node<typename task<TCO_MACRO>::id_type>>::iterator timer_node;
+  task_timer_wheel_node<typename task<TCO_MACRO>::id_type> *timer_wheel_node;
+
+  // intrusive links of ready queue
+  task_manager_node *ready_prev;
+  task_manager_node *ready_next;
+  uint32_t ready_class;
+  bool is_ready;
 };
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_COROUTINE) && LIBCOPP_MACRO_ENABLE_STD_COROUTINE
@@ -144,9 +171,43 @@ struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_node<task_future<TVALUE, TPRIVA
 
   task_type task_;
   typename std::set<task_timer_node<typename task_type::id_type>>::iterator timer_node;
+  task_timer_wheel_node<typename task_type::id_type> *timer_wheel_node;
+
+  // intrusive links of ready queue
+  task_manager_node *ready_prev;
+  task_manager_node *ready_next;
+  uint32_t ready_class;
+  bool is_ready;
 };
 #endif
 
+template <class TNODE>
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_ready_class {
+  TNODE *head;
+  TNODE *tail;
+  task_manager_ready_class_stats stats;
+
+  explicit task_manager_ready_class(uint32_t weight = 1) : head(nullptr), tail(nullptr) {
+    stats.weight = weight;
+    stats.ready_size = 0;
+    stats.mark_count = 0;
+    stats.run_count = 0;
+  }
+};
+
+// resume request posted by other threads, see task_manager::post_remote_resume(...)
+template <class TTASK_ID_TYPE>
+struct LIBCOPP_COTASK_API_HEAD_ONLY task_manager_remote_resume_message {
+  TTASK_ID_TYPE task_id;
+  void *priv_data;
+
+  task_manager_remote_resume_message() : task_id(0), priv_data(nullptr) {}
+  task_manager_remote_resume_message(TTASK_ID_TYPE id, void *priv) : task_id(id), priv_data(priv) {}
+};
+
+// max number of tasks detached by one lock in tick(...) and run_ready(...), a small batch keeps task contexts in cache
+// until they are used
+static constexpr const size_t task_manager_batch_size = 256;
 }  // namespace detail
 
 template <typename TTask>
@@ -159,7 +220,11 @@ template <typename TCO_MACRO>
 class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
  public:
   using task_type = task<TCO_MACRO>;
+#if defined(LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY) && LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY
+  using container_type = detail::task_slot_map<typename task_type::id_type, detail::task_manager_node<task_type>>;
+#else
   using container_type = std::unordered_map<typename task_type::id_type, detail::task_manager_node<task_type>>;
+#endif
   using id_type = typename task_type::id_type;
   using task_ptr_type = typename task_type::ptr_type;
   using self_type = task_manager<task_type>;
@@ -170,6 +235,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       EN_TM_NONE = 0x00,
       EN_TM_IN_TICK = 0x01,
       EN_TM_IN_RESET = 0x02,
+      EN_TM_HAS_PENDING_EXPIRE = 0x04,
     };
   };
 
@@ -183,6 +249,9 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
   using flag_t = flag_type;
 
  private:
+  using remote_resume_message_type = detail::task_manager_remote_resume_message<id_type>;
+  using remote_resume_queue_type = detail::task_bounded_mailbox<remote_resume_message_type>;
+
   struct flag_guard_type {
     int *data_;
     typename flag_type::type flag_;
@@ -204,7 +273,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
   };
 
  public:
-  task_manager() : flags_(0) {
+  task_manager()
+      : ready_classes_(1),
+        ready_size_(0),
+        ready_round_class_(0),
+        ready_round_credit_(1),
+        reclaim_max_backlog_(0),
+        flags_(0) {
     last_tick_time_.tv_sec = 0;
     last_tick_time_.tv_nsec = 0;
   }
@@ -234,18 +309,39 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       }
 
       tasks_.clear();
+      for (size_t i = 0; i < ready_classes_.size(); ++i) {
+        ready_classes_[i].head = nullptr;
+        ready_classes_[i].tail = nullptr;
+        ready_classes_[i].stats.ready_size = 0;
+      }
+      ready_size_ = 0;
+      ready_round_class_ = 0;
+      ready_round_credit_ = ready_classes_[0].stats.weight;
       task_timeout_timer_.clear();
+      if (timer_wheel_) {
+        timer_wheel_->clear();
+      }
       flags_ = 0;
       last_tick_time_.tv_sec = 0;
       last_tick_time_.tv_nsec = 0;
     }
 
+    // pending remote resume requests are dropped, the queue is kept for other threads
+    if (remote_resume_queue_) {
+      remote_resume_message_type message;
+      while (remote_resume_queue_->try_pop(message)) {
+      }
+    }
+
     // then, kill all tasks
     for (typename std::vector<task_ptr_type>::iterator iter = all_tasks.begin(); iter != all_tasks.end(); ++iter) {
       if (!(*iter)->is_exiting()) {
         (*iter)->kill(EN_TS_KILLED);
       }
     }
+
+    // at last, destroy all finished tasks waiting for reclaim
+    reclaim();
   }
 
   /**
@@ -261,13 +357,14 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
    * @param task task to be inserted
    * @param timeout_sec timeout in second ( unix time stamp recommanded )
    * @param timeout_nsec timeout in nanosecond ( must be in the range 0-999999999 )
+   * @param ready_class class of ready queue, see set_ready_class_weights(...)
    * @return 0 or error code
    *
    * @note if a task added before the first calling of tick method,
    *       the timeout will be set releative to the first calling time of tick method
    * @see tick
    */
-  int add_task(const task_ptr_type &task, time_t timeout_sec, int timeout_nsec) {
+  int add_task(const task_ptr_type &task, time_t timeout_sec, int timeout_nsec, uint32_t ready_class = 0) {
     if (!task) {
       assert(task);
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
@@ -277,51 +374,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
 
-    if (task->is_exiting()) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_IS_EXITING;
-    }
-
-    // try to cast type
-    using pair_type = typename container_type::value_type;
-    detail::task_manager_node<task_type> task_node;
-    task_node.task_ = task;
-    task_node.timer_node = task_timeout_timer_.end();
-
-    if (!task_node.task_) {
-      assert(task_node.task_);
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAST_FAILED;
-    }
-
     // lock before we will operator tasks_
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
     LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
         action_lock_};
 #endif
 
-    id_type task_id = task->get_id();
-    if (tasks_.end() != tasks_.find(task_id)) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_EXIST;
-    }
-
-#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-    using task_manager_helper = typename task_type::task_manager_helper;
-    if (!task_manager_helper::setup_task_manager(*task, reinterpret_cast<void *>(this), &task_cleanup_callback)) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_ALREADY_IN_ANOTHER_MANAGER;
-    }
-#endif
-
-    // try to insert to container
-    std::pair<typename container_type::iterator, bool> res = tasks_.insert(pair_type(task_id, task_node));
-    if (false == res.second) {
-#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-      task_manager_helper::cleanup_task_manager(*task, reinterpret_cast<void *>(this));
-#endif
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_EXTERNAL_INSERT_FAILED;
-    }
-
-    // add timeout controller
-    set_timeout_timer(res.first->second, timeout_sec, timeout_nsec);
-    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    return add_task_without_lock(task, timeout_sec, timeout_nsec, ready_class);
   }
 
   /**
@@ -334,6 +393,42 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
    */
   int add_task(const task_ptr_type &task) { return add_task(task, 0, 0); }
 
+  /**
+   * @brief add a batch of tasks to manager with only one lock
+   *
+   * @param tasks tasks to be inserted, invalid tasks are skipped
+   * @param timeout_sec timeout in second ( unix time stamp recommanded )
+   * @param timeout_nsec timeout in nanosecond ( must be in the range 0-999999999 )
+   * @param ready_class class of ready queue, see set_ready_class_weights(...)
+   * @return count of tasks inserted
+   */
+  size_t add_tasks(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<const task_ptr_type> tasks, time_t timeout_sec = 0,
+                   int timeout_nsec = 0, uint32_t ready_class = 0) {
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return 0;
+    }
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#endif
+
+    size_t ret = 0;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      if (tasks[i] && add_task_without_lock(tasks[i], timeout_sec, timeout_nsec, ready_class) >= 0) {
+        ++ret;
+      }
+    }
+
+    return ret;
+  }
+
+  size_t add_tasks(const std::vector<task_ptr_type> &tasks, time_t timeout_sec = 0, int timeout_nsec = 0,
+                   uint32_t ready_class = 0) {
+    return add_tasks(LIBCOPP_COPP_NAMESPACE_ID::gsl::span<const task_ptr_type>(tasks.data(), tasks.size()),
+                     timeout_sec, timeout_nsec, ready_class);
+  }
+
   /**
    * @brief set or update task timeout
    *
@@ -415,6 +510,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_inst = std::move(iter->second.task_);
 
       remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
       tasks_.erase(iter);
     }
 
@@ -425,10 +521,14 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_manager_helper::cleanup_task_manager(*task_inst, reinterpret_cast<void *>(this));
 #endif
 
+      int ret = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
       EN_TASK_STATUS task_status = task_inst->get_status();
       if (task_status > EN_TS_CREATED && task_status < EN_TS_DONE) {
-        return task_inst->kill(EN_TS_KILLED, nullptr);
+        ret = task_inst->kill(EN_TS_KILLED, nullptr);
       }
+
+      defer_reclaim(task_inst);
+      return ret;
     }
 
     return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
@@ -461,13 +561,21 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
   // int scheduling_loop();
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int start(id_type id, void *priv_data = nullptr) {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = start(id, eptrs, priv_data);
     task_type::maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   int start(id_type id, std::list<std::exception_ptr> &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = start(id, eptrs, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  int start(id_type id, unhandled_exception_list &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int start(id_type id, void *priv_data = nullptr) {
 #endif
@@ -510,13 +618,21 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int resume(id_type id, void *priv_data = nullptr) {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = resume(id, eptrs, priv_data);
     task_type::maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   int resume(id_type id, std::list<std::exception_ptr> &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = resume(id, eptrs, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  int resume(id_type id, unhandled_exception_list &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int resume(id_type id, void *priv_data = nullptr) {
 #endif
@@ -559,13 +675,21 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int cancel(id_type id, void *priv_data = nullptr) {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = cancel(id, eptrs, priv_data);
     task_type::maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   int cancel(id_type id, std::list<std::exception_ptr> &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = cancel(id, eptrs, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  int cancel(id_type id, unhandled_exception_list &unhandled, void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int cancel(id_type id, void *priv_data = nullptr) {
 #endif
@@ -589,6 +713,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_inst = std::move(iter->second.task_);
 
       remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
       tasks_.erase(iter);  // remove from container
     }
 
@@ -600,10 +725,12 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_manager_helper::cleanup_task_manager(*task_inst, reinterpret_cast<void *>(this));
 #endif
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-      return task_inst->cancel(unhandled, priv_data);
+      int ret = task_inst->cancel(unhandled, priv_data);
 #else
-      return task_inst->cancel(priv_data);
+      int ret = task_inst->cancel(priv_data);
 #endif
+      defer_reclaim(task_inst);
+      return ret;
     } else {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
     }
@@ -611,14 +738,23 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   int kill(id_type id, enum EN_TASK_STATUS status, void *priv_data = nullptr) {
-    std::list<std::exception_ptr> eptrs;
+    unhandled_exception_list eptrs;
     int ret = kill(id, eptrs, status, priv_data);
     task_type::maybe_rethrow(eptrs);
     return ret;
   }
 
+  // compatible with std::list<std::exception_ptr> of old versions
   int kill(id_type id, std::list<std::exception_ptr> &unhandled, enum EN_TASK_STATUS status,
            void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    int ret = kill(id, eptrs, status, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  int kill(id_type id, unhandled_exception_list &unhandled, enum EN_TASK_STATUS status,
+           void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
 #else
   int kill(id_type id, enum EN_TASK_STATUS status, void *priv_data = nullptr) {
 #endif
@@ -642,6 +778,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_inst = std::move(iter->second.task_);
 
       remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
       tasks_.erase(iter);  // remove from container
     }
 
@@ -653,10 +790,12 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       task_manager_helper::cleanup_task_manager(*task_inst, reinterpret_cast<void *>(this));
 #endif
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-      return task_inst->kill(unhandled, status, priv_data);
+      int ret = task_inst->kill(unhandled, status, priv_data);
 #else
-      return task_inst->kill(status, priv_data);
+      int ret = task_inst->kill(status, priv_data);
 #endif
+      defer_reclaim(task_inst);
+      return ret;
     } else {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
     }
@@ -665,134 +804,559 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
   int kill(id_type id, void *priv_data = nullptr) { return kill(id, EN_TS_KILLED, priv_data); }
 
   /**
-   * @brief active tick event and deal with clock
-   * @param sec current time in second ( unix time stamp recommanded )
-   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @brief mark a task ready, it will be resumed by run_ready(...) in FIFO order
+   * @param id task id
    * @return 0 or error code
-   *
-   * @note timeout tasks will be removed here
+   * @note the ready queue is intrusive, there is no memory allocation. Mark a task which is already ready does nothing.
    */
-  int tick(time_t sec, int nsec = 0) {
-    detail::tickspec_t now_tick_time;
-    // time can not be back
-    if (sec < last_tick_time_.tv_sec || (sec == last_tick_time_.tv_sec && nsec <= last_tick_time_.tv_nsec)) {
-      return 0;
+  int mark_ready(id_type id) {
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
 
-    now_tick_time.tv_sec = sec;
-    now_tick_time.tv_nsec = nsec;
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#endif
 
-    // we will ignore tick when in a recursive call
-    flag_guard_type tick_flag(&flags_, flag_type::EN_TM_IN_TICK);
-    if (!tick_flag) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    using iter_type = typename container_type::iterator;
+    iter_type iter = tasks_.find(id);
+    if (tasks_.end() == iter) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+
+    if (!iter->second.is_ready) {
+      push_ready_node(iter->second);
+      ++get_ready_class(iter->second).stats.mark_count;
     }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief get number of tasks in ready queue
+   * @return number of ready tasks
+   */
+  size_t get_ready_size() const LIBCOPP_MACRO_NOEXCEPT { return ready_size_; }
 
+  /**
+   * @brief set weights of ready classes, run_ready(...) runs ready tasks by weighted round-robin of these classes
+   * @param weights weight of every class, every round runs at most weights[i] tasks of class i, from class 0 to the
+   *        last one. So class 0 runs first, and classes with ready tasks will run in every round and never starve.
+   * @return 0 or error code
+   * @note it can only be set when there is no ready task, tasks with a class not less than weights.size() will be put
+   *       into the last class. Counters of all classes will be reset.
+   */
+  int set_ready_class_weights(const std::vector<uint32_t> &weights) {
     if (flags_ & flag_type::EN_TM_IN_RESET) {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
 
-    // first tick, init and reset task timeout
-    if (0 == last_tick_time_.tv_sec && 0 == last_tick_time_.tv_nsec) {
-      // hold lock
+    if (weights.empty()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+    for (size_t i = 0; i < weights.size(); ++i) {
+      if (0 == weights[i]) {
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+      }
+    }
+
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
-      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
-          action_lock_};
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
 #endif
 
-      std::set<detail::task_timer_node<id_type>> real_checkpoints;
-      for (typename std::set<detail::task_timer_node<id_type>>::iterator iter = task_timeout_timer_.begin();
-           task_timeout_timer_.end() != iter; ++iter) {
-        detail::task_timer_node<id_type> new_checkpoint = (*iter);
-        new_checkpoint.expired_time.tv_sec += sec;
-        new_checkpoint.expired_time.tv_nsec += nsec;
-        real_checkpoints.insert(new_checkpoint);
-      }
+    if (ready_size_ > 0) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING;
+    }
 
-      task_timeout_timer_.swap(real_checkpoints);
-      for (typename std::set<detail::task_timer_node<id_type>>::iterator iter = task_timeout_timer_.begin();
-           task_timeout_timer_.end() != iter; ++iter) {
-        const typename std::set<detail::task_timer_node<id_type>>::value_type &checkpoint = *iter;
-        using co_iter_type = typename container_type::iterator;
-        co_iter_type  co_iter = tasks_.find(checkpoint.task_id);
+    ready_classes_.clear();
+    ready_classes_.reserve(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+      ready_classes_.push_back(detail::task_manager_ready_class<detail::task_manager_node<task_type>>(weights[i]));
+    }
+    ready_round_class_ = 0;
+    ready_round_credit_ = ready_classes_[0].stats.weight;
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
 
-        if (tasks_.end() != co_iter) {
-          co_iter->second.timer_node = iter;
-        }
-      }
-      last_tick_time_ = now_tick_time;
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  /**
+   * @brief change ready class of a task, it will be moved to the tail of the new class if it's ready
+   * @param id task id
+   * @param ready_class new class
+   * @return 0 or error code
+   */
+  int set_ready_class(id_type id, uint32_t ready_class) {
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#endif
+
+    using iter_type = typename container_type::iterator;
+    iter_type iter = tasks_.find(id);
+    if (tasks_.end() == iter) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+
+    if (iter->second.is_ready) {
+      remove_ready_node(iter->second);
+      iter->second.ready_class = ready_class;
+      push_ready_node(iter->second);
+    } else {
+      iter->second.ready_class = ready_class;
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  inline size_t get_ready_class_count() const LIBCOPP_MACRO_NOEXCEPT { return ready_classes_.size(); }
+
+  /**
+   * @brief get counters of a ready class
+   * @param class_index index of class
+   * @return counters, all zero if class_index is out of range
+   */
+  task_manager_ready_class_stats get_ready_class_stats(size_t class_index) const LIBCOPP_MACRO_NOEXCEPT {
+    if (class_index >= ready_classes_.size()) {
+      return task_manager_ready_class_stats();
     }
 
+    return ready_classes_[class_index].stats;
+  }
+
+  /**
+   * @brief resume ready tasks in FIFO order, tasks are detached from the ready queue by batches
+   * @param max_count max number of tasks to resume
+   * @param priv_data private data passed to resume
+   * @return number of resumed tasks
+   */
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-    std::list<std::exception_ptr> eptrs;
+  size_t run_ready(size_t max_count = std::numeric_limits<size_t>::max(), void *priv_data = nullptr) {
+    unhandled_exception_list eptrs;
+    size_t ret = run_ready(eptrs, max_count, priv_data);
+    task_type::maybe_rethrow(eptrs);
+    return ret;
+  }
+
+  // compatible with std::list<std::exception_ptr> of old versions
+  size_t run_ready(std::list<std::exception_ptr> &unhandled, size_t max_count = std::numeric_limits<size_t>::max(),
+                   void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    size_t ret = run_ready(eptrs, max_count, priv_data);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  size_t run_ready(unhandled_exception_list &unhandled, size_t max_count = std::numeric_limits<size_t>::max(),
+                   void *priv_data = nullptr) LIBCOPP_MACRO_NOEXCEPT {
+#else
+  size_t run_ready(size_t max_count = std::numeric_limits<size_t>::max(), void *priv_data = nullptr) {
+#endif
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return 0;
+    }
+
+    size_t ret = 0;
+    size_t left_count;
+    std::vector<task_ptr_type> ready_tasks;
+    {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
 #endif
-    // remove timeout tasks
-    while (false == task_timeout_timer_.empty()) {
-      task_ptr_type task_inst;
+      // tasks marked ready again while running will be resumed by the next call
+      left_count = ready_size_ < max_count ? ready_size_ : max_count;
+    }
 
+    while (left_count > 0) {
       {
-        // hold lock
+        // hold lock once for every batch
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
         LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
             action_lock_};
 #endif
 
-        const typename std::set<detail::task_timer_node<id_type>>::value_type &timer_node =
-            *task_timeout_timer_.begin();
-        // all tasks those expired time less than now are timeout
-        if (now_tick_time <= timer_node.expired_time) {
-          break;
+        size_t batch_count = left_count;
+        if (batch_count > detail::task_manager_batch_size) {
+          batch_count = detail::task_manager_batch_size;
         }
-
-        // check expire time(may be changed)
-        using iter_type = typename container_type::iterator;
-
-        iter_type iter = tasks_.find(timer_node.task_id);
-
-        if (tasks_.end() != iter) {
-          // task may be removed before
-          task_inst = std::move(iter->second.task_);
-
-          remove_timeout_timer(iter->second);
-          tasks_.erase(iter);  // remove from container
+        ready_tasks.reserve(batch_count);
+        while (ready_tasks.size() < batch_count) {
+          detail::task_manager_node<task_type> *node = pop_ready_node();
+          if (nullptr == node) {
+            break;
+          }
+          ready_tasks.push_back(node->task_);
         }
+
+        // some ready tasks may be removed
+        left_count = ready_tasks.size() < batch_count ? 0 : left_count - batch_count;
       }
 
       // task call can not be used when lock is on
-      if (task_inst && !task_inst->is_exiting()) {
-#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-        using task_manager_helper = typename task_type::task_manager_helper;
-        // already cleanup, there is no need to cleanup again
-        task_manager_helper::cleanup_task_manager(*task_inst, reinterpret_cast<void *>(this));
-#endif
+      for (typename std::vector<task_ptr_type>::iterator iter = ready_tasks.begin(); iter != ready_tasks.end();
+           ++iter) {
+        task_ptr_type &task_inst = *iter;
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-        task_inst->kill(eptrs, EN_TS_TIMEOUT, nullptr);
+        task_inst->resume(unhandled, priv_data);
 #else
-        task_inst->kill(EN_TS_TIMEOUT);
+        task_inst->resume(priv_data);
 #endif
+
+        // if task is finished, remove it
+        if (task_inst->get_status() >= EN_TS_DONE) {
+          remove_task(task_inst->get_id(), task_inst.get());
+        }
       }
+      ret += ready_tasks.size();
+      ready_tasks.clear();
     }
 
-    last_tick_time_ = now_tick_time;
-
-#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-    task_type::maybe_rethrow(eptrs);
-#endif
-    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    return ret;
   }
 
   /**
-   * @brief get timeout checkpoint number in this manager
-   * @return checkpoint number
+   * @brief defer destruction of finished tasks, they are kept in reclaim queue until reclaim(...) or
+   *        detach_reclaim_batch(...) is called, so the action, the coroutine and the stack are not destroyed in
+   *        resume path
+   * @param max_backlog max number of finished tasks in reclaim queue, 0 to disable deferred reclaim. Tasks finished
+   *        when the queue is full are destroyed immediately.
+   * @note tasks already in reclaim queue are kept when it's disabled
    */
-  size_t get_tick_checkpoint_size() const LIBCOPP_MACRO_NOEXCEPT { return task_timeout_timer_.size(); }
+  void set_deferred_reclaim(size_t max_backlog) LIBCOPP_MACRO_NOEXCEPT { reclaim_max_backlog_ = max_backlog; }
+
+  inline size_t get_deferred_reclaim_backlog() const LIBCOPP_MACRO_NOEXCEPT { return reclaim_max_backlog_; }
 
   /**
-   * @brief get task number in this manager
-   * @return task number
+   * @brief get number of finished tasks waiting to be destroyed
+   * @return number of tasks in reclaim queue
    */
-  size_t get_task_size() const LIBCOPP_MACRO_NOEXCEPT { return tasks_.size(); }
+  size_t get_reclaim_size() {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
+#endif
+    return reclaim_tasks_.size();
+  }
+
+  /**
+   * @brief destroy finished tasks in reclaim queue, usually called at the end of every loop
+   * @param max_count max number of tasks to destroy
+   * @return number of tasks released by this manager, tasks still referenced by others are destroyed later
+   */
+  size_t reclaim(size_t max_count = std::numeric_limits<size_t>::max()) {
+    size_t ret = 0;
+    std::vector<task_ptr_type> reclaim_tasks;
+    while (ret < max_count) {
+      size_t batch_count = max_count - ret;
+      if (batch_count > detail::task_manager_batch_size) {
+        batch_count = detail::task_manager_batch_size;
+      }
+
+      if (0 == detach_reclaim_batch(reclaim_tasks, batch_count)) {
+        break;
+      }
+
+      // tasks are destroyed after unlock
+      ret += reclaim_tasks.size();
+      reclaim_tasks.clear();
+    }
+
+    return ret;
+  }
+
+  /**
+   * @brief move finished tasks in reclaim queue to output, then they can be destroyed by another thread
+   * @param output where to append the tasks
+   * @param max_count max number of tasks to move
+   * @return number of tasks moved
+   * @note the stack allocator must be thread-safe if tasks are destroyed by another thread
+   */
+  size_t detach_reclaim_batch(std::vector<task_ptr_type> &output,
+                              size_t max_count = detail::task_manager_batch_size) {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
+#endif
+
+    size_t ret = 0;
+    output.reserve(output.size() + (reclaim_tasks_.size() < max_count ? reclaim_tasks_.size() : max_count));
+    while (ret < max_count && !reclaim_tasks_.empty()) {
+      output.push_back(std::move(reclaim_tasks_.back()));
+      reclaim_tasks_.pop_back();
+      ++ret;
+    }
+
+    return ret;
+  }
+
+  /**
+   * @brief create the remote resume queue, then any thread can post resume requests by post_remote_resume(...)
+   * @param capacity max number of pending requests, it will be rounded up to the power of 2
+   * @return 0 or error code
+   * @note it must be called by the owner thread before other threads call post_remote_resume(...), and the queue will
+   *       not be destroyed until the task manager is destroyed
+   */
+  int init_remote_resume_queue(size_t capacity = 1024) {
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    if (0 == capacity) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (remote_resume_queue_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_INITED;
+    }
+
+    remote_resume_queue_.reset(new remote_resume_queue_type(capacity));
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief post a resume request of a task, it can be called by any thread and never takes a lock
+   * @param id task id
+   * @param priv_data private data passed to resume
+   * @return 0 or error code, COPP_EC_NOT_INITED if init_remote_resume_queue(...) is not called and COPP_EC_QUEUE_FULL
+   *         if there are too many pending requests
+   * @note the task will be resumed by the owner thread in drain_remote_resume(...), so it's safe to post before the
+   *       task yields
+   */
+  int post_remote_resume(id_type id, void *priv_data = nullptr) {
+    if (!remote_resume_queue_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_INITED;
+    }
+
+    if (!remote_resume_queue_->try_push(remote_resume_message_type(id, priv_data))) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_QUEUE_FULL;
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief resume tasks posted by post_remote_resume(...) in FIFO order, it should be called by the owner thread
+   * @param max_count max number of requests to handle
+   * @return number of handled requests, requests of removed tasks are also counted
+   */
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  size_t drain_remote_resume(size_t max_count = std::numeric_limits<size_t>::max()) {
+    unhandled_exception_list eptrs;
+    size_t ret = drain_remote_resume(eptrs, max_count);
+    task_type::maybe_rethrow(eptrs);
+    return ret;
+  }
+
+  // compatible with std::list<std::exception_ptr> of old versions
+  size_t drain_remote_resume(std::list<std::exception_ptr> &unhandled,
+                             size_t max_count = std::numeric_limits<size_t>::max()) LIBCOPP_MACRO_NOEXCEPT {
+    unhandled_exception_list eptrs;
+    size_t ret = drain_remote_resume(eptrs, max_count);
+    eptrs.move_to(unhandled);
+    return ret;
+  }
+
+  size_t drain_remote_resume(unhandled_exception_list &unhandled,
+                             size_t max_count = std::numeric_limits<size_t>::max()) LIBCOPP_MACRO_NOEXCEPT {
+#else
+  size_t drain_remote_resume(size_t max_count = std::numeric_limits<size_t>::max()) {
+#endif
+    if (!remote_resume_queue_ || (flags_ & flag_type::EN_TM_IN_RESET)) {
+      return 0;
+    }
+
+    size_t ret = 0;
+    remote_resume_message_type message;
+    while (ret < max_count && remote_resume_queue_->try_pop(message)) {
+      ++ret;
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      resume(message.task_id, unhandled, message.priv_data);
+#else
+      resume(message.task_id, message.priv_data);
+#endif
+    }
+
+    return ret;
+  }
+
+  /**
+   * @return approximate number of pending remote resume requests
+   */
+  size_t get_remote_resume_size() const LIBCOPP_MACRO_NOEXCEPT {
+    return remote_resume_queue_ ? remote_resume_queue_->size() : 0;
+  }
+
+  /**
+   * @brief active tick event and deal with clock
+   * @param sec current time in second ( unix time stamp recommanded )
+   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @return 0 or error code
+   *
+   * @note timeout tasks will be removed here
+   */
+  int tick(time_t sec, int nsec = 0) { return tick(sec, nsec, std::numeric_limits<size_t>::max()); }
+
+  /**
+   * @brief active tick event and deal with clock, but kill at most max_expire timeout tasks
+   * @param sec current time in second ( unix time stamp recommanded )
+   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @param max_expire max number of timeout tasks to kill in this call, 0 means just move the clock
+   * @param pending_count if not nullptr, it will be set to the number of timeout tasks left to the next tick
+   * @return 0 or error code
+   *
+   * @note timeout tasks left by the limit will be killed by the next tick, even if the time is not changed.
+   *       pending_count costs O(pending_count) when timing wheel is not used, and O(1) otherwise.
+   */
+  int tick(time_t sec, int nsec, size_t max_expire, size_t *pending_count = nullptr) {
+    detail::tickspec_t now_tick_time;
+    if (nullptr != pending_count) {
+      *pending_count = 0;
+    }
+
+    // time can not be back
+    if (sec < last_tick_time_.tv_sec || (sec == last_tick_time_.tv_sec && nsec < last_tick_time_.tv_nsec)) {
+      return 0;
+    }
+    // but timeout tasks left by the last tick can be killed at the same time
+    if (sec == last_tick_time_.tv_sec && nsec == last_tick_time_.tv_nsec &&
+        0 == (flags_ & flag_type::EN_TM_HAS_PENDING_EXPIRE)) {
+      return 0;
+    }
+
+    now_tick_time.tv_sec = sec;
+    now_tick_time.tv_nsec = nsec;
+
+    // we will ignore tick when in a recursive call
+    flag_guard_type tick_flag(&flags_, flag_type::EN_TM_IN_TICK);
+    if (!tick_flag) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    }
+
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    if (timer_wheel_) {
+      return tick_timer_wheel(now_tick_time, max_expire, pending_count);
+    }
+
+    // first tick, init and reset task timeout
+    if (0 == last_tick_time_.tv_sec && 0 == last_tick_time_.tv_nsec) {
+      // hold lock
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#endif
+
+      std::set<detail::task_timer_node<id_type>> real_checkpoints;
+      for (typename std::set<detail::task_timer_node<id_type>>::iterator iter = task_timeout_timer_.begin();
+           task_timeout_timer_.end() != iter; ++iter) {
+        detail::task_timer_node<id_type> new_checkpoint = (*iter);
+        new_checkpoint.expired_time.tv_sec += sec;
+        new_checkpoint.expired_time.tv_nsec += nsec;
+        real_checkpoints.insert(new_checkpoint);
+      }
+
+      task_timeout_timer_.swap(real_checkpoints);
+      for (typename std::set<detail::task_timer_node<id_type>>::iterator iter = task_timeout_timer_.begin();
+           task_timeout_timer_.end() != iter; ++iter) {
+        const typename std::set<detail::task_timer_node<id_type>>::value_type &checkpoint = *iter;
+        using co_iter_type = typename container_type::iterator;
+        co_iter_type  co_iter = tasks_.find(checkpoint.task_id);
+
+        if (tasks_.end() != co_iter) {
+          co_iter->second.timer_node = iter;
+        }
+      }
+      last_tick_time_ = now_tick_time;
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    unhandled_exception_list eptrs;
+#endif
+    // remove timeout tasks, every batch is detached by one lock and killed after unlock
+    std::vector<task_ptr_type> timeout_tasks;
+    size_t expired_count = 0;
+    bool has_more_timeout = true;
+    flags_ &= ~static_cast<int>(flag_type::EN_TM_HAS_PENDING_EXPIRE);
+    while (has_more_timeout) {
+      has_more_timeout = false;
+      {
+        // hold lock
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+            action_lock_};
+#endif
+
+        using iter_type = typename container_type::iterator;
+        while (false == task_timeout_timer_.empty()) {
+          typename std::set<detail::task_timer_node<id_type>>::iterator timer_iter = task_timeout_timer_.begin();
+          // all tasks those expired time less than now are timeout
+          if (now_tick_time <= timer_iter->expired_time) {
+            break;
+          }
+
+          // reach the limit, left the rest timeout tasks to the next tick
+          if (expired_count >= max_expire) {
+            flags_ |= flag_type::EN_TM_HAS_PENDING_EXPIRE;
+            if (nullptr != pending_count) {
+              *pending_count = get_timeout_checkpoint_size(now_tick_time);
+            }
+            break;
+          }
+
+          if (timeout_tasks.size() >= detail::task_manager_batch_size) {
+            has_more_timeout = true;
+            break;
+          }
+          if (timeout_tasks.capacity() < detail::task_manager_batch_size) {
+            timeout_tasks.reserve(detail::task_manager_batch_size);
+          }
+          ++expired_count;
+
+          iter_type iter = tasks_.find(timer_iter->task_id);
+          if (tasks_.end() != iter && iter->second.timer_node == timer_iter) {
+            timeout_tasks.push_back(std::move(iter->second.task_));
+            remove_ready_node(iter->second);
+            tasks_.erase(iter);  // remove from container
+          }
+          task_timeout_timer_.erase(timer_iter);
+        }
+      }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+      kill_timeout_tasks(timeout_tasks, eptrs);
+#else
+      kill_timeout_tasks(timeout_tasks);
+#endif
+      timeout_tasks.clear();
+    }
+
+    last_tick_time_ = now_tick_time;
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    task_type::maybe_rethrow(eptrs);
+#endif
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief get timeout checkpoint number in this manager
+   * @return checkpoint number
+   */
+  size_t get_tick_checkpoint_size() const LIBCOPP_MACRO_NOEXCEPT {
+    return timer_wheel_ ? timer_wheel_->size() : task_timeout_timer_.size();
+  }
+
+  /**
+   * @brief get task number in this manager
+   * @return task number
+   */
+  size_t get_task_size() const LIBCOPP_MACRO_NOEXCEPT { return tasks_.size(); }
 
   /**
    * @brief get last tick time
@@ -814,7 +1378,96 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
     return task_timeout_timer_;
   }
 
+  /**
+   * @brief use hierarchical timing wheel instead of std::set to manage timeout of tasks
+   * @param conf configure of timing wheel
+   * @return 0 or error code
+   *
+   * @note it can only be called when there is no task in this manager. When timing wheel is enabled, add and remove
+   *       timeout of tasks are O(1), and timeout tasks may be killed at most one granularity later.
+   *       get_checkpoints() will always be empty and timeout of tasks can not be found in get_container().
+   */
+  int set_timer_wheel(const task_timer_wheel_config &conf) {
+    if (!conf.is_valid()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (flags_ & flag_type::EN_TM_IN_RESET) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    // lock before we will operator tasks_
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#endif
+    if (!tasks_.empty()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING;
+    }
+
+    timer_wheel_.reset(new detail::task_timer_wheel<id_type>(conf));
+    // tick is already started, timeout of new tasks will be relative to the last tick time
+    if (0 != last_tick_time_.tv_sec || 0 != last_tick_time_.tv_nsec) {
+      timer_wheel_->start(detail::to_timer_wheel_nsec(last_tick_time_.tv_sec, last_tick_time_.tv_nsec));
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief if timing wheel is used to manage timeout of tasks
+   * @return true if set_timer_wheel(...) is called successfully
+   */
+  inline bool is_timer_wheel_enabled() const LIBCOPP_MACRO_NOEXCEPT { return !!timer_wheel_; }
+
  private:
+  // action_lock_ must be locked before calling this
+  int add_task_without_lock(const task_ptr_type &task, time_t timeout_sec, int timeout_nsec, uint32_t ready_class) {
+    if (task->is_exiting()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_IS_EXITING;
+    }
+
+    // try to cast type
+    using pair_type = typename container_type::value_type;
+    detail::task_manager_node<task_type> task_node;
+    task_node.task_ = task;
+    task_node.timer_node = task_timeout_timer_.end();
+    task_node.timer_wheel_node = nullptr;
+    task_node.ready_prev = nullptr;
+    task_node.ready_next = nullptr;
+    task_node.ready_class = ready_class;
+    task_node.is_ready = false;
+
+    if (!task_node.task_) {
+      assert(task_node.task_);
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAST_FAILED;
+    }
+
+    id_type task_id = task->get_id();
+    if (tasks_.end() != tasks_.find(task_id)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_EXIST;
+    }
+
+#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+    using task_manager_helper = typename task_type::task_manager_helper;
+    if (!task_manager_helper::setup_task_manager(*task, reinterpret_cast<void *>(this), &task_cleanup_callback)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_TASK_ALREADY_IN_ANOTHER_MANAGER;
+    }
+#endif
+
+    // try to insert to container
+    std::pair<typename container_type::iterator, bool> res = tasks_.insert(pair_type(task_id, task_node));
+    if (false == res.second) {
+#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+      task_manager_helper::cleanup_task_manager(*task, reinterpret_cast<void *>(this));
+#endif
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_EXTERNAL_INSERT_FAILED;
+    }
+
+    // add timeout controller
+    set_timeout_timer(res.first->second, timeout_sec, timeout_nsec);
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
   void set_timeout_timer(detail::task_manager_node<task_type> &node, time_t timeout_sec, int timeout_nsec) {
     remove_timeout_timer(node);
 
@@ -826,6 +1479,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
       return;
     }
 
+    if (timer_wheel_) {
+      node.timer_wheel_node = timer_wheel_->insert(
+          node.task_->get_id(), detail::to_timer_wheel_nsec(last_tick_time_.tv_sec + timeout_sec,
+                                                            last_tick_time_.tv_nsec + timeout_nsec));
+      return;
+    }
+
     detail::task_timer_node<id_type> timer_node;
     timer_node.task_id = node.task_->get_id();
     timer_node.expired_time.tv_sec = last_tick_time_.tv_sec + timeout_sec;
@@ -838,13 +1498,197 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
     }
   }
 
+  inline detail::task_manager_ready_class<detail::task_manager_node<task_type>> &get_ready_class(
+      const detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    // tasks with a unknown class are put into the last class
+    return node.ready_class < ready_classes_.size() ? ready_classes_[node.ready_class] : ready_classes_.back();
+  }
+
+  void push_ready_node(detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class = get_ready_class(node);
+    node.ready_prev = ready_class.tail;
+    node.ready_next = nullptr;
+    if (nullptr != ready_class.tail) {
+      ready_class.tail->ready_next = &node;
+    } else {
+      ready_class.head = &node;
+    }
+    ready_class.tail = &node;
+    node.is_ready = true;
+    ++ready_class.stats.ready_size;
+    ++ready_size_;
+  }
+
+  void remove_ready_node(detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    if (!node.is_ready) {
+      return;
+    }
+
+    detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class = get_ready_class(node);
+    if (nullptr != node.ready_prev) {
+      node.ready_prev->ready_next = node.ready_next;
+    } else {
+      ready_class.head = node.ready_next;
+    }
+    if (nullptr != node.ready_next) {
+      node.ready_next->ready_prev = node.ready_prev;
+    } else {
+      ready_class.tail = node.ready_prev;
+    }
+    node.ready_prev = nullptr;
+    node.ready_next = nullptr;
+    node.is_ready = false;
+    --ready_class.stats.ready_size;
+    --ready_size_;
+  }
+
+  // weighted round-robin, every class runs at most weight tasks in a round, from class 0 to the last one
+  detail::task_manager_node<task_type> *pop_ready_node() LIBCOPP_MACRO_NOEXCEPT {
+    if (0 == ready_size_) {
+      return nullptr;
+    }
+
+    while (true) {
+      detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class =
+          ready_classes_[ready_round_class_];
+      if (nullptr != ready_class.head && ready_round_credit_ > 0) {
+        --ready_round_credit_;
+        ++ready_class.stats.run_count;
+
+        detail::task_manager_node<task_type> *ret = ready_class.head;
+        remove_ready_node(*ret);
+        return ret;
+      }
+
+      ready_round_class_ = (ready_round_class_ + 1) % ready_classes_.size();
+      ready_round_credit_ = ready_classes_[ready_round_class_].stats.weight;
+    }
+  }
+
+  // count of timeout checkpoints which are expired before now_tick_time, lock must be held
+  size_t get_timeout_checkpoint_size(const detail::tickspec_t &now_tick_time) const LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (typename std::set<detail::task_timer_node<id_type>>::const_iterator iter = task_timeout_timer_.begin();
+         iter != task_timeout_timer_.end() && iter->expired_time < now_tick_time; ++iter) {
+      ++ret;
+    }
+    return ret;
+  }
+
   void remove_timeout_timer(detail::task_manager_node<task_type> &node) {
+    if (nullptr != node.timer_wheel_node) {
+      if (timer_wheel_) {
+        timer_wheel_->erase(node.timer_wheel_node);
+      }
+      node.timer_wheel_node = nullptr;
+    }
+
     if (node.timer_node != task_timeout_timer_.end()) {
       task_timeout_timer_.erase(node.timer_node);
       node.timer_node = task_timeout_timer_.end();
     }
   }
 
+  int tick_timer_wheel(const detail::tickspec_t &now_tick_time, size_t max_expire, size_t *pending_count) {
+    std::vector<task_ptr_type> timeout_tasks;
+    {
+      // hold lock
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#endif
+      uint64_t now_nsec = detail::to_timer_wheel_nsec(now_tick_time.tv_sec, now_tick_time.tv_nsec);
+      // first tick, timeout of tasks added before are relative to now
+      if (!timer_wheel_->is_started()) {
+        timer_wheel_->start(now_nsec);
+        last_tick_time_ = now_tick_time;
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+      }
+
+      size_t expired_count = timer_wheel_->advance(now_nsec);
+      if (expired_count > max_expire) {
+        expired_count = max_expire;
+      }
+      timeout_tasks.reserve(expired_count);
+
+      using iter_type = typename container_type::iterator;
+      typename detail::task_timer_wheel<id_type>::node_type *timer_node;
+      for (; expired_count > 0 && nullptr != (timer_node = timer_wheel_->front_expired()); --expired_count) {
+        iter_type iter = tasks_.find(timer_node->task_id);
+        if (tasks_.end() != iter && iter->second.timer_wheel_node == timer_node) {
+          timeout_tasks.push_back(std::move(iter->second.task_));
+          remove_ready_node(iter->second);
+          tasks_.erase(iter);  // remove from container
+        }
+        timer_wheel_->erase(timer_node);
+      }
+
+      // left the rest timeout tasks to the next tick
+      if (timer_wheel_->get_expired_size() > 0) {
+        flags_ |= flag_type::EN_TM_HAS_PENDING_EXPIRE;
+      } else {
+        flags_ &= ~static_cast<int>(flag_type::EN_TM_HAS_PENDING_EXPIRE);
+      }
+      if (nullptr != pending_count) {
+        *pending_count = timer_wheel_->get_expired_size();
+      }
+    }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    unhandled_exception_list eptrs;
+    kill_timeout_tasks(timeout_tasks, eptrs);
+#else
+    kill_timeout_tasks(timeout_tasks);
+#endif
+
+    last_tick_time_ = now_tick_time;
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    task_type::maybe_rethrow(eptrs);
+#endif
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  void kill_timeout_tasks(std::vector<task_ptr_type> &timeout_tasks, unhandled_exception_list &unhandled) {
+#else
+  void kill_timeout_tasks(std::vector<task_ptr_type> &timeout_tasks) {
+#endif
+    // task call can not be used when lock is on
+    for (typename std::vector<task_ptr_type>::iterator iter = timeout_tasks.begin(); iter != timeout_tasks.end();
+         ++iter) {
+      task_ptr_type &task_inst = *iter;
+      if (task_inst && !task_inst->is_exiting()) {
+#if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+        using task_manager_helper = typename task_type::task_manager_helper;
+        // already cleanup, there is no need to cleanup again
+        task_manager_helper::cleanup_task_manager(*task_inst, reinterpret_cast<void *>(this));
+#endif
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+        task_inst->kill(unhandled, EN_TS_TIMEOUT, nullptr);
+#else
+        task_inst->kill(EN_TS_TIMEOUT);
+#endif
+      }
+      defer_reclaim(task_inst);
+    }
+  }
+
+  // keep finished task in reclaim queue, it's destroyed immediately if deferred reclaim is disabled or queue is full
+  void defer_reclaim(task_ptr_type &task_inst) {
+    if (0 == reclaim_max_backlog_ || !task_inst) {
+      return;
+    }
+
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
+#endif
+    if (reclaim_tasks_.size() < reclaim_max_backlog_) {
+      reclaim_tasks_.push_back(std::move(task_inst));
+    }
+  }
+
 #if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
   static void task_cleanup_callback(void *self_ptr, task_type &task_inst) {
     if (nullptr == self_ptr) {
@@ -859,9 +1703,18 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task<TCO_MACRO>> {
   container_type tasks_;
   detail::tickspec_t last_tick_time_;
   std::set<detail::task_timer_node<id_type>> task_timeout_timer_;
+  std::unique_ptr<detail::task_timer_wheel<id_type>> timer_wheel_;
+  std::vector<detail::task_manager_ready_class<detail::task_manager_node<task_type>>> ready_classes_;
+  size_t ready_size_;
+  size_t ready_round_class_;
+  uint32_t ready_round_credit_;
+  std::unique_ptr<remote_resume_queue_type> remote_resume_queue_;
+  size_t reclaim_max_backlog_;
+  std::vector<task_ptr_type> reclaim_tasks_;
 
 #if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock action_lock_;
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock reclaim_lock_;
 #endif
   int flags_;
 };
@@ -874,7 +1727,11 @@ template <class TVALUE, class TPRIVATE_DATA, class TERROR_TRANSFORM>
 class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DATA, TERROR_TRANSFORM>> {
  public:
   using task_type = task_future<TVALUE, TPRIVATE_DATA, TERROR_TRANSFORM>;
+#  if defined(LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY) && LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY
+  using container_type = detail::task_slot_map<typename task_type::id_type, detail::task_manager_node<task_type>>;
+#  else
   using container_type = std::unordered_map<typename task_type::id_type, detail::task_manager_node<task_type>>;
+#  endif
   using id_type = typename task_type::id_type;
   using task_status_type = typename task_type::task_status_type;
   using self_type = task_manager<task_type>;
@@ -884,6 +1741,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       kNone = 0,
       kTimerTick = 0x01,
       kTimerReset = 0x02,
+      kTimerPendingExpire = 0x04,
   };
 
  private:
@@ -908,7 +1766,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
   };
 
  public:
-  task_manager() : flags_(0) {
+  task_manager()
+      : ready_classes_(1),
+        ready_size_(0),
+        ready_round_class_(0),
+        ready_round_credit_(1),
+        reclaim_max_backlog_(0),
+        flags_(0) {
     last_tick_time_.tv_sec = 0;
     last_tick_time_.tv_nsec = 0;
   }
@@ -938,7 +1802,18 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       }
 
       tasks_.clear();
+      for (size_t i = 0; i < ready_classes_.size(); ++i) {
+        ready_classes_[i].head = nullptr;
+        ready_classes_[i].tail = nullptr;
+        ready_classes_[i].stats.ready_size = 0;
+      }
+      ready_size_ = 0;
+      ready_round_class_ = 0;
+      ready_round_credit_ = ready_classes_[0].stats.weight;
       task_timeout_timer_.clear();
+      if (timer_wheel_) {
+        timer_wheel_->clear();
+      }
       flags_ = 0;
       last_tick_time_.tv_sec = 0;
       last_tick_time_.tv_nsec = 0;
@@ -956,6 +1831,9 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
         (*iter).kill(task_status_type::kKilled);
       }
     }
+
+    // at last, destroy all finished tasks waiting for reclaim
+    reclaim();
   }
 
   /**
@@ -971,13 +1849,14 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
    * @param task task to be inserted
    * @param timeout_sec timeout in second ( unix time stamp recommanded )
    * @param timeout_nsec timeout in nanosecond ( must be in the range 0-999999999 )
+   * @param ready_class class of ready queue, see set_ready_class_weights(...)
    * @return 0 or error code
    *
    * @note if a task added before the first calling of tick method,
    *       the timeout will be set releative to the first calling time of tick method
    * @see tick
    */
-  int add_task(const task_type &task, time_t timeout_sec, int timeout_nsec) noexcept {
+  int add_task(const task_type &task, time_t timeout_sec, int timeout_nsec, uint32_t ready_class = 0) noexcept {
     if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
@@ -991,6 +1870,11 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
     detail::task_manager_node<task_type> task_node;
     task_node.task_ = task;
     task_node.timer_node = task_timeout_timer_.end();
+    task_node.timer_wheel_node = nullptr;
+    task_node.ready_prev = nullptr;
+    task_node.ready_next = nullptr;
+    task_node.ready_class = ready_class;
+    task_node.is_ready = false;
 
     // lock before we will operator tasks_
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
@@ -1118,6 +2002,7 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       task_inst = std::move(iter->second.task_);
 
       remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
       tasks_.erase(iter);
     }
 
@@ -1128,10 +2013,14 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
 #  endif
 
+      int ret = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
       task_status_type task_status = task_inst.get_status();
       if (task_status > task_status_type::kCreated && task_status < task_status_type::kDone) {
-        return task_inst.kill(task_status_type::kKilled);
+        ret = task_inst.kill(task_status_type::kKilled);
       }
+
+      defer_reclaim(task_inst);
+      return ret;
     }
 
     return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
@@ -1165,112 +2054,380 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
 
-    task_type task_inst;
-    {
+    task_type task_inst;
+    {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#  endif
+
+      using iter_type = typename container_type::iterator;
+      iter_type iter = tasks_.find(id);
+      if (tasks_.end() == iter) return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+
+      task_inst = iter->second.task_;
+    }
+
+    // unlock and then run start
+    if (task_inst.get_context()) {
+      task_inst.start();
+
+      // if task is finished, remove it
+      if (task_inst.is_exiting()) {
+        remove_task(id, task_inst);
+      }
+
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    } else {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+  }
+
+  int cancel(id_type id) {
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    task_type task_inst;
+    {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#  endif
+
+      using iter_type = typename container_type::iterator;
+      iter_type iter = tasks_.find(id);
+      if (tasks_.end() == iter) {
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+      }
+
+      task_inst = std::move(iter->second.task_);
+
+      remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
+      tasks_.erase(iter);  // remove from container
+    }
+
+    // unlock and then run cancel
+    if (task_inst.get_context()) {
+#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+      using task_manager_helper = typename task_type::task_manager_helper;
+      // already cleanup, there is no need to cleanup again
+      task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
+#  endif
+      task_inst.cancel();
+      defer_reclaim(task_inst);
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    } else {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+  }
+
+  int kill(id_type id, task_status_type target_status) {
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    task_type task_inst;
+    {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#  endif
+
+      using iter_type = typename container_type::iterator;
+      iter_type iter = tasks_.find(id);
+      if (tasks_.end() == iter) {
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+      }
+
+      task_inst = std::move(iter->second.task_);
+
+      remove_timeout_timer(iter->second);
+      remove_ready_node(iter->second);
+      tasks_.erase(iter);  // remove from container
+    }
+
+    // unlock and then run kill
+    if (task_inst.get_context()) {
+#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+      using task_manager_helper = typename task_type::task_manager_helper;
+      // already cleanup, there is no need to cleanup again
+      task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
+#  endif
+      task_inst.kill(target_status);
+      defer_reclaim(task_inst);
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    } else {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+  }
+
+  int kill(id_type id) { return kill(id, task_status_type::kKilled); }
+
+  /**
+   * @brief mark a task ready, it will be started by run_ready(...) in FIFO order
+   * @param id task id
+   * @return 0 or error code
+   * @note the ready queue is intrusive, there is no memory allocation. Mark a task which is already ready does nothing.
+   */
+  int mark_ready(id_type id) {
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#  endif
+
+    using iter_type = typename container_type::iterator;
+    iter_type iter = tasks_.find(id);
+    if (tasks_.end() == iter) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    }
+
+    if (!iter->second.is_ready) {
+      push_ready_node(iter->second);
+      ++get_ready_class(iter->second).stats.mark_count;
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief get number of tasks in ready queue
+   * @return number of ready tasks
+   */
+  size_t get_ready_size() const LIBCOPP_MACRO_NOEXCEPT { return ready_size_; }
+
+  /**
+   * @brief set weights of ready classes, run_ready(...) runs ready tasks by weighted round-robin of these classes
+   * @param weights weight of every class, every round runs at most weights[i] tasks of class i, from class 0 to the
+   *        last one. So class 0 runs first, and classes with ready tasks will run in every round and never starve.
+   * @return 0 or error code
+   * @note it can only be set when there is no ready task, tasks with a class not less than weights.size() will be put
+   *       into the last class. Counters of all classes will be reset.
+   */
+  int set_ready_class_weights(const std::vector<uint32_t> &weights) {
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    if (weights.empty()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+    for (size_t i = 0; i < weights.size(); ++i) {
+      if (0 == weights[i]) {
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+      }
+    }
+
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#  endif
+
+    if (ready_size_ > 0) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING;
+    }
+
+    ready_classes_.clear();
+    ready_classes_.reserve(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+      ready_classes_.push_back(detail::task_manager_ready_class<detail::task_manager_node<task_type>>(weights[i]));
+    }
+    ready_round_class_ = 0;
+    ready_round_credit_ = ready_classes_[0].stats.weight;
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief change ready class of a task, it will be moved to the tail of the new class if it's ready
+   * @param id task id
+   * @param ready_class new class
+   * @return 0 or error code
+   */
+  int set_ready_class(id_type id, uint32_t ready_class) {
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
-      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
-          action_lock_};
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
 #  endif
 
-      using iter_type = typename container_type::iterator;
-      iter_type iter = tasks_.find(id);
-      if (tasks_.end() == iter) return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
-
-      task_inst = iter->second.task_;
+    using iter_type = typename container_type::iterator;
+    iter_type iter = tasks_.find(id);
+    if (tasks_.end() == iter) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
     }
 
-    // unlock and then run start
-    if (task_inst.get_context()) {
-      task_inst.start();
+    if (iter->second.is_ready) {
+      remove_ready_node(iter->second);
+      iter->second.ready_class = ready_class;
+      push_ready_node(iter->second);
+    } else {
+      iter->second.ready_class = ready_class;
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
 
-      // if task is finished, remove it
-      if (task_inst.is_exiting()) {
-        remove_task(id, task_inst);
-      }
+  inline size_t get_ready_class_count() const LIBCOPP_MACRO_NOEXCEPT { return ready_classes_.size(); }
 
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
-    } else {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+  /**
+   * @brief get counters of a ready class
+   * @param class_index index of class
+   * @return counters, all zero if class_index is out of range
+   */
+  task_manager_ready_class_stats get_ready_class_stats(size_t class_index) const LIBCOPP_MACRO_NOEXCEPT {
+    if (class_index >= ready_classes_.size()) {
+      return task_manager_ready_class_stats();
     }
+
+    return ready_classes_[class_index].stats;
   }
 
-  int cancel(id_type id) {
+  /**
+   * @brief start ready tasks in FIFO order, tasks are detached from the ready queue by batches
+   * @param max_count max number of tasks to start
+   * @return number of started tasks
+   * @note task_future is resumed by what it's awaiting after started, so tasks which are already started will be
+   *       skipped
+   */
+  size_t run_ready(size_t max_count = std::numeric_limits<size_t>::max()) {
     if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+      return 0;
     }
 
-    task_type task_inst;
+    size_t ret = 0;
+    size_t left_count;
+    std::vector<task_type> ready_tasks;
     {
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
       LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
           action_lock_};
 #  endif
+      // tasks marked ready again while running will be started by the next call
+      left_count = ready_size_ < max_count ? ready_size_ : max_count;
+    }
 
-      using iter_type = typename container_type::iterator;
-      iter_type iter = tasks_.find(id);
-      if (tasks_.end() == iter) {
-        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+    while (left_count > 0) {
+      {
+        // hold lock once for every batch
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+        LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+            action_lock_};
+#  endif
+
+        size_t batch_count = left_count;
+        if (batch_count > detail::task_manager_batch_size) {
+          batch_count = detail::task_manager_batch_size;
+        }
+        ready_tasks.reserve(batch_count);
+        while (ready_tasks.size() < batch_count) {
+          detail::task_manager_node<task_type> *node = pop_ready_node();
+          if (nullptr == node) {
+            break;
+          }
+          ready_tasks.push_back(node->task_);
+        }
+
+        // some ready tasks may be removed
+        left_count = ready_tasks.size() < batch_count ? 0 : left_count - batch_count;
       }
 
-      task_inst = std::move(iter->second.task_);
+      // task call can not be used when lock is on
+      for (typename std::vector<task_type>::iterator iter = ready_tasks.begin(); iter != ready_tasks.end(); ++iter) {
+        task_type &task_inst = *iter;
+        if (!task_inst.get_context()) {
+          continue;
+        }
+        task_inst.start();
 
-      remove_timeout_timer(iter->second);
-      tasks_.erase(iter);  // remove from container
+        // if task is finished, remove it
+        if (task_inst.is_exiting()) {
+          remove_task(task_inst.get_id(), task_inst);
+        }
+      }
+      ret += ready_tasks.size();
+      ready_tasks.clear();
     }
 
-    // unlock and then run cancel
-    if (task_inst.get_context()) {
-#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-      using task_manager_helper = typename task_type::task_manager_helper;
-      // already cleanup, there is no need to cleanup again
-      task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
-#  endif
-      task_inst.cancel();
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
-    } else {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
-    }
+    return ret;
   }
 
-  int kill(id_type id, task_status_type target_status) {
-    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
-    }
+  /**
+   * @brief defer destruction of finished tasks, they are kept in reclaim queue until reclaim(...) or
+   *        detach_reclaim_batch(...) is called, so the coroutine frame and the context are not destroyed in resume path
+   * @param max_backlog max number of finished tasks in reclaim queue, 0 to disable deferred reclaim. Tasks finished
+   *        when the queue is full are destroyed immediately.
+   * @note tasks already in reclaim queue are kept when it's disabled
+   */
+  void set_deferred_reclaim(size_t max_backlog) LIBCOPP_MACRO_NOEXCEPT { reclaim_max_backlog_ = max_backlog; }
 
-    task_type task_inst;
-    {
+  inline size_t get_deferred_reclaim_backlog() const LIBCOPP_MACRO_NOEXCEPT { return reclaim_max_backlog_; }
+
+  /**
+   * @brief get number of finished tasks waiting to be destroyed
+   * @return number of tasks in reclaim queue
+   */
+  size_t get_reclaim_size() {
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
-      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
-          action_lock_};
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
 #  endif
+    return reclaim_tasks_.size();
+  }
 
-      using iter_type = typename container_type::iterator;
-      iter_type iter = tasks_.find(id);
-      if (tasks_.end() == iter) {
-        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+  /**
+   * @brief destroy finished tasks in reclaim queue, usually called at the end of every loop
+   * @param max_count max number of tasks to destroy
+   * @return number of tasks released by this manager, tasks still referenced by others are destroyed later
+   */
+  size_t reclaim(size_t max_count = std::numeric_limits<size_t>::max()) {
+    size_t ret = 0;
+    std::vector<task_type> reclaim_tasks;
+    while (ret < max_count) {
+      size_t batch_count = max_count - ret;
+      if (batch_count > detail::task_manager_batch_size) {
+        batch_count = detail::task_manager_batch_size;
       }
 
-      task_inst = std::move(iter->second.task_);
+      if (0 == detach_reclaim_batch(reclaim_tasks, batch_count)) {
+        break;
+      }
 
-      remove_timeout_timer(iter->second);
-      tasks_.erase(iter);  // remove from container
+      // tasks are destroyed after unlock
+      ret += reclaim_tasks.size();
+      reclaim_tasks.clear();
     }
 
-    // unlock and then run kill
-    if (task_inst.get_context()) {
-#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-      using task_manager_helper = typename task_type::task_manager_helper;
-      // already cleanup, there is no need to cleanup again
-      task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
+    return ret;
+  }
+
+  /**
+   * @brief move finished tasks in reclaim queue to output, then they can be destroyed by another thread
+   * @param output where to append the tasks
+   * @param max_count max number of tasks to move
+   * @return number of tasks moved
+   */
+  size_t detach_reclaim_batch(std::vector<task_type> &output, size_t max_count = detail::task_manager_batch_size) {
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
 #  endif
-      task_inst.kill(target_status);
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
-    } else {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_NOT_FOUND;
+
+    size_t ret = 0;
+    output.reserve(output.size() + (reclaim_tasks_.size() < max_count ? reclaim_tasks_.size() : max_count));
+    while (ret < max_count && !reclaim_tasks_.empty()) {
+      output.push_back(std::move(reclaim_tasks_.back()));
+      reclaim_tasks_.pop_back();
+      ++ret;
     }
-  }
 
-  int kill(id_type id) { return kill(id, task_status_type::kKilled); }
+    return ret;
+  }
 
   /**
    * @brief active tick event and deal with clock
@@ -1280,10 +2437,32 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
    *
    * @note timeout tasks will be removed here
    */
-  int tick(time_t sec, int nsec = 0) {
+  int tick(time_t sec, int nsec = 0) { return tick(sec, nsec, std::numeric_limits<size_t>::max()); }
+
+  /**
+   * @brief active tick event and deal with clock, but kill at most max_expire timeout tasks
+   * @param sec current time in second ( unix time stamp recommanded )
+   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @param max_expire max number of timeout tasks to kill in this call, 0 means just move the clock
+   * @param pending_count if not nullptr, it will be set to the number of timeout tasks left to the next tick
+   * @return 0 or error code
+   *
+   * @note timeout tasks left by the limit will be killed by the next tick, even if the time is not changed.
+   *       pending_count costs O(pending_count) when timing wheel is not used, and O(1) otherwise.
+   */
+  int tick(time_t sec, int nsec, size_t max_expire, size_t *pending_count = nullptr) {
     detail::tickspec_t now_tick_time;
+    if (nullptr != pending_count) {
+      *pending_count = 0;
+    }
+
     // time can not be back
-    if (sec < last_tick_time_.tv_sec || (sec == last_tick_time_.tv_sec && nsec <= last_tick_time_.tv_nsec)) {
+    if (sec < last_tick_time_.tv_sec || (sec == last_tick_time_.tv_sec && nsec < last_tick_time_.tv_nsec)) {
+      return 0;
+    }
+    // but timeout tasks left by the last tick can be killed at the same time
+    if (sec == last_tick_time_.tv_sec && nsec == last_tick_time_.tv_nsec &&
+        0 == (flags_ & static_cast<uint32_t>(flag_type::kTimerPendingExpire))) {
       return 0;
     }
 
@@ -1300,6 +2479,10 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
     }
 
+    if (timer_wheel_) {
+      return tick_timer_wheel(now_tick_time, max_expire, pending_count);
+    }
+
     // first tick, init and reset task timeout
     if (0 == last_tick_time_.tv_sec && 0 == last_tick_time_.tv_nsec) {
       // hold lock
@@ -1332,10 +2515,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
     }
 
-    // remove timeout tasks
-    while (false == task_timeout_timer_.empty()) {
-      task_type task_inst;
-
+    // remove timeout tasks, every batch is detached by one lock and killed after unlock
+    std::vector<task_type> timeout_tasks;
+    size_t expired_count = 0;
+    bool has_more_timeout = true;
+    flags_ &= ~static_cast<uint32_t>(flag_type::kTimerPendingExpire);
+    while (has_more_timeout) {
+      has_more_timeout = false;
       {
         // hold lock
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
@@ -1343,36 +2529,44 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
             action_lock_};
 #  endif
 
-        const typename std::set<detail::task_timer_node<id_type>>::value_type &timer_node =
-            *task_timeout_timer_.begin();
-        // all tasks those expired time less than now are timeout
-        if (now_tick_time <= timer_node.expired_time) {
-          break;
-        }
-
-        // check expire time(may be changed)
         using iter_type = typename container_type::iterator;
-
-        iter_type iter = tasks_.find(timer_node.task_id);
-
-        if (tasks_.end() != iter) {
-          // task may be removed before
-          task_inst = std::move(iter->second.task_);
-
-          remove_timeout_timer(iter->second);
-          tasks_.erase(iter);  // remove from container
+        while (false == task_timeout_timer_.empty()) {
+          typename std::set<detail::task_timer_node<id_type>>::iterator timer_iter = task_timeout_timer_.begin();
+          // all tasks those expired time less than now are timeout
+          if (now_tick_time <= timer_iter->expired_time) {
+            break;
+          }
+
+          // reach the limit, left the rest timeout tasks to the next tick
+          if (expired_count >= max_expire) {
+            flags_ |= static_cast<uint32_t>(flag_type::kTimerPendingExpire);
+            if (nullptr != pending_count) {
+              *pending_count = get_timeout_checkpoint_size(now_tick_time);
+            }
+            break;
+          }
+
+          if (timeout_tasks.size() >= detail::task_manager_batch_size) {
+            has_more_timeout = true;
+            break;
+          }
+          if (timeout_tasks.capacity() < detail::task_manager_batch_size) {
+            timeout_tasks.reserve(detail::task_manager_batch_size);
+          }
+          ++expired_count;
+
+          iter_type iter = tasks_.find(timer_iter->task_id);
+          if (tasks_.end() != iter && iter->second.timer_node == timer_iter) {
+            timeout_tasks.push_back(std::move(iter->second.task_));
+            remove_ready_node(iter->second);
+            tasks_.erase(iter);  // remove from container
+          }
+          task_timeout_timer_.erase(timer_iter);
         }
       }
 
-      // task call can not be used when lock is on
-      if (!task_inst.is_exiting()) {
-#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
-        using task_manager_helper = typename task_type::task_manager_helper;
-        // already cleanup, there is no need to cleanup again
-        task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
-#  endif
-        task_inst.kill(task_status_type::kTimeout);
-      }
+      kill_timeout_tasks(timeout_tasks);
+      timeout_tasks.clear();
     }
 
     last_tick_time_ = now_tick_time;
@@ -1383,7 +2577,9 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
    * @brief get timeout checkpoint number in this manager
    * @return checkpoint number
    */
-  size_t get_tick_checkpoint_size() const LIBCOPP_MACRO_NOEXCEPT { return task_timeout_timer_.size(); }
+  size_t get_tick_checkpoint_size() const LIBCOPP_MACRO_NOEXCEPT {
+    return timer_wheel_ ? timer_wheel_->size() : task_timeout_timer_.size();
+  }
 
   /**
    * @brief get task number in this manager
@@ -1411,6 +2607,47 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
     return task_timeout_timer_;
   }
 
+  /**
+   * @brief use hierarchical timing wheel instead of std::set to manage timeout of tasks
+   * @param conf configure of timing wheel
+   * @return 0 or error code
+   *
+   * @note it can only be called when there is no task in this manager. When timing wheel is enabled, add and remove
+   *       timeout of tasks are O(1), and timeout tasks may be killed at most one granularity later.
+   *       get_checkpoints() will always be empty and timeout of tasks can not be found in get_container().
+   */
+  int set_timer_wheel(const task_timer_wheel_config &conf) {
+    if (!conf.is_valid()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    if (flags_ & static_cast<uint32_t>(flag_type::kTimerReset)) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IN_RESET;
+    }
+
+    // lock before we will operator tasks_
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        action_lock_};
+#  endif
+    if (!tasks_.empty()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_IS_RUNNING;
+    }
+
+    timer_wheel_.reset(new detail::task_timer_wheel<id_type>(conf));
+    // tick is already started, timeout of new tasks will be relative to the last tick time
+    if (0 != last_tick_time_.tv_sec || 0 != last_tick_time_.tv_nsec) {
+      timer_wheel_->start(detail::to_timer_wheel_nsec(last_tick_time_.tv_sec, last_tick_time_.tv_nsec));
+    }
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief if timing wheel is used to manage timeout of tasks
+   * @return true if set_timer_wheel(...) is called successfully
+   */
+  inline bool is_timer_wheel_enabled() const LIBCOPP_MACRO_NOEXCEPT { return !!timer_wheel_; }
+
  private:
   void set_timeout_timer(detail::task_manager_node<task_type> &node, time_t timeout_sec, int timeout_nsec) {
     remove_timeout_timer(node);
@@ -1423,6 +2660,13 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
       return;
     }
 
+    if (timer_wheel_) {
+      node.timer_wheel_node = timer_wheel_->insert(
+          node.task_.get_id(), detail::to_timer_wheel_nsec(last_tick_time_.tv_sec + timeout_sec,
+                                                           last_tick_time_.tv_nsec + timeout_nsec));
+      return;
+    }
+
     detail::task_timer_node<id_type> timer_node;
     timer_node.task_id = node.task_.get_id();
     timer_node.expired_time.tv_sec = last_tick_time_.tv_sec + timeout_sec;
@@ -1435,13 +2679,179 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
     }
   }
 
+  inline detail::task_manager_ready_class<detail::task_manager_node<task_type>> &get_ready_class(
+      const detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    // tasks with a unknown class are put into the last class
+    return node.ready_class < ready_classes_.size() ? ready_classes_[node.ready_class] : ready_classes_.back();
+  }
+
+  void push_ready_node(detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class = get_ready_class(node);
+    node.ready_prev = ready_class.tail;
+    node.ready_next = nullptr;
+    if (nullptr != ready_class.tail) {
+      ready_class.tail->ready_next = &node;
+    } else {
+      ready_class.head = &node;
+    }
+    ready_class.tail = &node;
+    node.is_ready = true;
+    ++ready_class.stats.ready_size;
+    ++ready_size_;
+  }
+
+  void remove_ready_node(detail::task_manager_node<task_type> &node) LIBCOPP_MACRO_NOEXCEPT {
+    if (!node.is_ready) {
+      return;
+    }
+
+    detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class = get_ready_class(node);
+    if (nullptr != node.ready_prev) {
+      node.ready_prev->ready_next = node.ready_next;
+    } else {
+      ready_class.head = node.ready_next;
+    }
+    if (nullptr != node.ready_next) {
+      node.ready_next->ready_prev = node.ready_prev;
+    } else {
+      ready_class.tail = node.ready_prev;
+    }
+    node.ready_prev = nullptr;
+    node.ready_next = nullptr;
+    node.is_ready = false;
+    --ready_class.stats.ready_size;
+    --ready_size_;
+  }
+
+  // weighted round-robin, every class runs at most weight tasks in a round, from class 0 to the last one
+  detail::task_manager_node<task_type> *pop_ready_node() LIBCOPP_MACRO_NOEXCEPT {
+    if (0 == ready_size_) {
+      return nullptr;
+    }
+
+    while (true) {
+      detail::task_manager_ready_class<detail::task_manager_node<task_type>> &ready_class =
+          ready_classes_[ready_round_class_];
+      if (nullptr != ready_class.head && ready_round_credit_ > 0) {
+        --ready_round_credit_;
+        ++ready_class.stats.run_count;
+
+        detail::task_manager_node<task_type> *ret = ready_class.head;
+        remove_ready_node(*ret);
+        return ret;
+      }
+
+      ready_round_class_ = (ready_round_class_ + 1) % ready_classes_.size();
+      ready_round_credit_ = ready_classes_[ready_round_class_].stats.weight;
+    }
+  }
+
+  // count of timeout checkpoints which are expired before now_tick_time, lock must be held
+  size_t get_timeout_checkpoint_size(const detail::tickspec_t &now_tick_time) const LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (typename std::set<detail::task_timer_node<id_type>>::const_iterator iter = task_timeout_timer_.begin();
+         iter != task_timeout_timer_.end() && iter->expired_time < now_tick_time; ++iter) {
+      ++ret;
+    }
+    return ret;
+  }
+
   void remove_timeout_timer(detail::task_manager_node<task_type> &node) {
+    if (nullptr != node.timer_wheel_node) {
+      if (timer_wheel_) {
+        timer_wheel_->erase(node.timer_wheel_node);
+      }
+      node.timer_wheel_node = nullptr;
+    }
+
     if (node.timer_node != task_timeout_timer_.end()) {
       task_timeout_timer_.erase(node.timer_node);
       node.timer_node = task_timeout_timer_.end();
     }
   }
 
+  int tick_timer_wheel(const detail::tickspec_t &now_tick_time, size_t max_expire, size_t *pending_count) {
+    std::vector<task_type> timeout_tasks;
+    {
+      // hold lock
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          action_lock_};
+#  endif
+      uint64_t now_nsec = detail::to_timer_wheel_nsec(now_tick_time.tv_sec, now_tick_time.tv_nsec);
+      // first tick, timeout of tasks added before are relative to now
+      if (!timer_wheel_->is_started()) {
+        timer_wheel_->start(now_nsec);
+        last_tick_time_ = now_tick_time;
+        return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+      }
+
+      size_t expired_count = timer_wheel_->advance(now_nsec);
+      if (expired_count > max_expire) {
+        expired_count = max_expire;
+      }
+      timeout_tasks.reserve(expired_count);
+
+      using iter_type = typename container_type::iterator;
+      typename detail::task_timer_wheel<id_type>::node_type *timer_node;
+      for (; expired_count > 0 && nullptr != (timer_node = timer_wheel_->front_expired()); --expired_count) {
+        iter_type iter = tasks_.find(timer_node->task_id);
+        if (tasks_.end() != iter && iter->second.timer_wheel_node == timer_node) {
+          timeout_tasks.push_back(std::move(iter->second.task_));
+          remove_ready_node(iter->second);
+          tasks_.erase(iter);  // remove from container
+        }
+        timer_wheel_->erase(timer_node);
+      }
+
+      // left the rest timeout tasks to the next tick
+      if (timer_wheel_->get_expired_size() > 0) {
+        flags_ |= static_cast<uint32_t>(flag_type::kTimerPendingExpire);
+      } else {
+        flags_ &= ~static_cast<uint32_t>(flag_type::kTimerPendingExpire);
+      }
+      if (nullptr != pending_count) {
+        *pending_count = timer_wheel_->get_expired_size();
+      }
+    }
+
+    kill_timeout_tasks(timeout_tasks);
+
+    last_tick_time_ = now_tick_time;
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  void kill_timeout_tasks(std::vector<task_type> &timeout_tasks) {
+    // task call can not be used when lock is on
+    for (typename std::vector<task_type>::iterator iter = timeout_tasks.begin(); iter != timeout_tasks.end(); ++iter) {
+      task_type &task_inst = *iter;
+      if (!task_inst.is_exiting()) {
+#  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+        using task_manager_helper = typename task_type::task_manager_helper;
+        // already cleanup, there is no need to cleanup again
+        task_manager_helper::cleanup_task_manager(*task_inst.get_context(), reinterpret_cast<void *>(this));
+#  endif
+        task_inst.kill(task_status_type::kTimeout);
+      }
+      defer_reclaim(task_inst);
+    }
+  }
+
+  // keep finished task in reclaim queue, it's destroyed immediately if deferred reclaim is disabled or queue is full
+  void defer_reclaim(task_type &task_inst) {
+    if (0 == reclaim_max_backlog_ || !task_inst.get_context()) {
+      return;
+    }
+
+#  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        reclaim_lock_};
+#  endif
+    if (reclaim_tasks_.size() < reclaim_max_backlog_) {
+      reclaim_tasks_.push_back(std::move(task_inst));
+    }
+  }
+
 #  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
   static void task_cleanup_callback(void *self_ptr, task_context_base<TVALUE> &task_inst) {
     if (nullptr == self_ptr) {
@@ -1456,9 +2866,17 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_manager<task_future<TVALUE, TPRIVATE_DAT
   container_type tasks_;
   detail::tickspec_t last_tick_time_;
   std::set<detail::task_timer_node<id_type>> task_timeout_timer_;
+  std::unique_ptr<detail::task_timer_wheel<id_type>> timer_wheel_;
+  std::vector<detail::task_manager_ready_class<detail::task_manager_node<task_type>>> ready_classes_;
+  size_t ready_size_;
+  size_t ready_round_class_;
+  uint32_t ready_round_credit_;
+  size_t reclaim_max_backlog_;
+  std::vector<task_type> reclaim_tasks_;
 
 #  if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
   LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock action_lock_;
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock reclaim_lock_;
 #  endif
   uint32_t flags_;
 };
@@ -0,0 +1,313 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/atomic_int_type.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <cstddef>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/task_manager.h"
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+namespace detail {
+template <class TTASK_PTR>
+inline auto get_task_manager_task_id(const TTASK_PTR &task, int) -> decltype(task->get_id()) {
+  if (!task) {
+    return 0;
+  }
+  return task->get_id();
+}
+
+template <class TTASK>
+inline auto get_task_manager_task_id(const TTASK &task, long) -> decltype(task.get_id()) {  // NOLINT(runtime/int)
+  return task.get_id();
+}
+}  // namespace detail
+
+/**
+ * @brief sharded task manager, tasks are partitioned into shards by hash of task id
+ * @note every shard is a task_manager with its own lock and timer, so operations on tasks in different shards will
+ *       not block each other. All apis of task_manager are forwarded to the shard of task id, tick(...) and reset()
+ *       will be applied to all shards.
+ */
+template <typename TTask>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_manager_sharded {
+ public:
+  using shard_type = task_manager<TTask>;
+  using shard_ptr_type = std::unique_ptr<shard_type>;
+  using task_type = typename shard_type::task_type;
+  using id_type = typename shard_type::id_type;
+  using self_type = task_manager_sharded<TTask>;
+  using ptr_type = std::shared_ptr<self_type>;
+
+ public:
+  /**
+   * @brief create a sharded task manager
+   * @param shard_count shard count, use std::thread::hardware_concurrency() when it's 0
+   */
+  explicit task_manager_sharded(size_t shard_count = 0) : tick_start_index_(0), run_ready_start_index_(0) {
+    if (0 == shard_count) {
+      shard_count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    if (0 == shard_count) {
+      shard_count = 1;
+    }
+
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+      shards_.push_back(shard_ptr_type(new shard_type()));
+    }
+  }
+
+  /**
+   * @brief create a new sharded task manager
+   * @param shard_count shard count, use std::thread::hardware_concurrency() when it's 0
+   * @return smart pointer of task manager
+   */
+  static ptr_type create(size_t shard_count = 0) { return std::make_shared<self_type>(shard_count); }
+
+  void reset() {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->reset();
+    }
+  }
+
+  /**
+   * @brief add task to the shard of its id
+   * @see task_manager::add_task
+   */
+  template <class TTASK_REF, class... TARGS>
+  inline int add_task(const TTASK_REF &task, TARGS &&...args) {
+    return get_shard_by_id(detail::get_task_manager_task_id(task, 0)).add_task(task, std::forward<TARGS>(args)...);
+  }
+
+  inline int set_timeout(id_type id, time_t timeout_sec, int timeout_nsec) {
+    return get_shard_by_id(id).set_timeout(id, timeout_sec, timeout_nsec);
+  }
+
+  template <class... TARGS>
+  inline int remove_task(id_type id, TARGS &&...args) {
+    return get_shard_by_id(id).remove_task(id, std::forward<TARGS>(args)...);
+  }
+
+  inline auto find_task(id_type id) -> decltype(std::declval<shard_type &>().find_task(id)) {
+    return get_shard_by_id(id).find_task(id);
+  }
+
+  template <class... TARGS>
+  inline int start(id_type id, TARGS &&...args) {
+    return get_shard_by_id(id).start(id, std::forward<TARGS>(args)...);
+  }
+
+  template <class... TARGS>
+  inline int resume(id_type id, TARGS &&...args) {
+    return get_shard_by_id(id).resume(id, std::forward<TARGS>(args)...);
+  }
+
+  template <class... TARGS>
+  inline int cancel(id_type id, TARGS &&...args) {
+    return get_shard_by_id(id).cancel(id, std::forward<TARGS>(args)...);
+  }
+
+  template <class... TARGS>
+  inline int kill(id_type id, TARGS &&...args) {
+    return get_shard_by_id(id).kill(id, std::forward<TARGS>(args)...);
+  }
+
+  inline int mark_ready(id_type id) { return get_shard_by_id(id).mark_ready(id); }
+
+  /**
+   * @brief run ready tasks of all shards, at most max_count tasks in total
+   * @see task_manager::run_ready
+   */
+  template <class... TARGS>
+  size_t run_ready(size_t max_count = std::numeric_limits<size_t>::max(), TARGS &&...args) {
+    size_t ret = 0;
+    // shards are called by turns, and it's safe to be called by multiple threads
+    size_t start_index =
+        run_ready_start_index_.fetch_add(1, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_relaxed) %
+        shards_.size();
+    for (size_t i = 0; i < shards_.size() && ret < max_count; ++i) {
+      ret += shards_[(start_index + i) % shards_.size()]->run_ready(max_count - ret, args...);
+    }
+    return ret;
+  }
+
+  size_t get_ready_size() const LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      ret += shards_[i]->get_ready_size();
+    }
+    return ret;
+  }
+
+  /**
+   * @brief set weights of ready classes in all shards
+   * @see task_manager::set_ready_class_weights
+   */
+  int set_ready_class_weights(const std::vector<uint32_t> &weights) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      int res = shards_[i]->set_ready_class_weights(weights);
+      if (res < 0) {
+        return res;
+      }
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  inline int set_ready_class(id_type id, uint32_t ready_class) {
+    return get_shard_by_id(id).set_ready_class(id, ready_class);
+  }
+
+  inline size_t get_ready_class_count() const LIBCOPP_MACRO_NOEXCEPT { return shards_[0]->get_ready_class_count(); }
+
+  task_manager_ready_class_stats get_ready_class_stats(size_t class_index) const LIBCOPP_MACRO_NOEXCEPT {
+    task_manager_ready_class_stats ret = shards_[0]->get_ready_class_stats(class_index);
+    for (size_t i = 1; i < shards_.size(); ++i) {
+      task_manager_ready_class_stats shard_stats = shards_[i]->get_ready_class_stats(class_index);
+      ret.ready_size += shard_stats.ready_size;
+      ret.mark_count += shard_stats.mark_count;
+      ret.run_count += shard_stats.run_count;
+    }
+    return ret;
+  }
+
+  /**
+   * @brief active tick event of all shards
+   * @param sec current time in second ( unix time stamp recommanded )
+   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @return 0 or the first error code of shards
+   */
+  int tick(time_t sec, int nsec = 0) { return tick(sec, nsec, std::numeric_limits<size_t>::max()); }
+
+  /**
+   * @brief active tick event of all shards, but kill at most max_expire timeout tasks in total
+   * @param sec current time in second ( unix time stamp recommanded )
+   * @param nsec current time in nanosecond ( must be in the range 0-999999999 )
+   * @param max_expire max number of timeout tasks to kill in this call, 0 means just move the clock
+   * @param pending_count if not nullptr, it will be set to the number of timeout tasks left to the next tick
+   * @return 0 or the first error code of shards
+   * @note the first shard to consume the budget is rotated every call, so no shard will starve
+   * @see task_manager::tick
+   */
+  int tick(time_t sec, int nsec, size_t max_expire, size_t *pending_count = nullptr) {
+    int ret = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+    if (nullptr != pending_count) {
+      *pending_count = 0;
+    }
+
+    size_t start_index =
+        tick_start_index_.fetch_add(1, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_relaxed) % shards_.size();
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shard_type &shard = *shards_[(start_index + i) % shards_.size()];
+      size_t shard_pending = 0;
+      size_t before_size = shard.get_tick_checkpoint_size();
+      int res = shard.tick(sec, nsec, max_expire, &shard_pending);
+      if (res < 0 && LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS == ret) {
+        ret = res;
+      }
+
+      // every killed task removes its checkpoint
+      size_t after_size = shard.get_tick_checkpoint_size();
+      if (max_expire != std::numeric_limits<size_t>::max() && before_size > after_size) {
+        max_expire = before_size - after_size >= max_expire ? 0 : max_expire - (before_size - after_size);
+      }
+      if (nullptr != pending_count) {
+        *pending_count += shard_pending;
+      }
+    }
+
+    return ret;
+  }
+
+  /**
+   * @brief use hierarchical timing wheel in all shards
+   * @see task_manager::set_timer_wheel
+   */
+  int set_timer_wheel(const task_timer_wheel_config &conf) {
+    if (!conf.is_valid()) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ARGS_ERROR;
+    }
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      int res = shards_[i]->set_timer_wheel(conf);
+      if (res < 0) {
+        return res;
+      }
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  inline bool is_timer_wheel_enabled() const LIBCOPP_MACRO_NOEXCEPT { return shards_[0]->is_timer_wheel_enabled(); }
+
+  size_t get_tick_checkpoint_size() const LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      ret += shards_[i]->get_tick_checkpoint_size();
+    }
+    return ret;
+  }
+
+  size_t get_task_size() const LIBCOPP_MACRO_NOEXCEPT {
+    size_t ret = 0;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      ret += shards_[i]->get_task_size();
+    }
+    return ret;
+  }
+
+  inline detail::tickspec_t get_last_tick_time() const LIBCOPP_MACRO_NOEXCEPT {
+    return shards_[0]->get_last_tick_time();
+  }
+
+  inline size_t get_shard_count() const LIBCOPP_MACRO_NOEXCEPT { return shards_.size(); }
+
+  inline size_t get_shard_index(id_type id) const LIBCOPP_MACRO_NOEXCEPT {
+    // low bits of ids are sequential, mix all bits before modulo
+    return static_cast<size_t>((static_cast<uint64_t>(id) * static_cast<uint64_t>(0x9E3779B97F4A7C15ULL)) >> 32) %
+           shards_.size();
+  }
+
+  inline shard_type &get_shard(size_t index) LIBCOPP_MACRO_NOEXCEPT { return *shards_[index]; }
+  inline const shard_type &get_shard(size_t index) const LIBCOPP_MACRO_NOEXCEPT { return *shards_[index]; }
+
+  inline shard_type &get_shard_by_id(id_type id) LIBCOPP_MACRO_NOEXCEPT { return *shards_[get_shard_index(id)]; }
+
+ private:
+  task_manager_sharded(const task_manager_sharded &) = delete;
+  task_manager_sharded &operator=(const task_manager_sharded &) = delete;
+
+ private:
+  std::vector<shard_ptr_type> shards_;
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t> tick_start_index_;
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t> run_ready_start_index_;
+#else
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<size_t> >
+      tick_start_index_;
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::unsafe_int_type<size_t> >
+      run_ready_start_index_;
+#endif
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
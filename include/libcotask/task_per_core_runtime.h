@@ -0,0 +1,390 @@
+// Copyright 2023 owent
+
+#pragma once
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/stack/allocator/stack_allocator_pool.h>
+#include <libcopp/stack/stack_allocator.h>
+#include <libcopp/stack/stack_pool.h>
+#include <libcopp/utils/features.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+#include "libcotask/impl/task_bounded_mailbox.h"
+#include "libcotask/task.h"
+#include "libcotask/task_manager.h"
+
+// cores need thread local storage and multi-thread support of this_task
+#if defined(COPP_MACRO_THREAD_LOCAL) && (!defined(LIBCOPP_LOCK_DISABLE_THIS_MT) || !(LIBCOPP_LOCK_DISABLE_THIS_MT))
+#  define LIBCOTASK_MACRO_ENABLE_TASK_PER_CORE_RUNTIME 1
+#else
+#  define LIBCOTASK_MACRO_ENABLE_TASK_PER_CORE_RUNTIME 0
+#endif
+
+#if LIBCOTASK_MACRO_ENABLE_TASK_PER_CORE_RUNTIME
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+
+/**
+ * @brief thread-per-core runtime, every core owns a thread, a task_manager, a stack pool and a mailbox
+ * @note Tasks of a core are created, started and resumed only by its own thread, so no lock is shared between cores.
+ *       Other threads can only interact with a core by its mailbox, which carries "resume task" and "run closure"
+ *       messages. Resumed tasks are queued by task_manager::mark_ready(...) and run by task_manager::run_ready(...).
+ * @note Exceptions thrown by tasks or closures are not caught, they will terminate the process like any other thread.
+ */
+template <typename TSTACK_ALLOCATOR = LIBCOPP_COPP_NAMESPACE_ID::allocator::default_statck_allocator>
+class LIBCOPP_COTASK_API_HEAD_ONLY task_per_core_runtime {
+ public:
+  using self_type = task_per_core_runtime<TSTACK_ALLOCATOR>;
+  using ptr_type = std::shared_ptr<self_type>;
+  using stack_pool_type = LIBCOPP_COPP_NAMESPACE_ID::stack_pool<TSTACK_ALLOCATOR>;
+
+  struct macro_coroutine_type {
+    using stack_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::allocator::stack_allocator_pool<stack_pool_type>;
+    using coroutine_type = LIBCOPP_COPP_NAMESPACE_ID::coroutine_context_container<stack_allocator_type>;
+    using value_type = int;
+  };
+
+  using task_type = task<macro_coroutine_type>;
+  using task_ptr_type = typename task_type::ptr_type;
+  using id_type = typename task_type::id_type;
+  using task_manager_type = task_manager<task_type>;
+  class core_type;
+  using closure_type = std::function<void(core_type &)>;
+
+ private:
+  enum {
+    MAX_MESSAGES_PER_POLL = 256,
+    MAX_READY_PER_POLL = 256,
+    MAX_EXPIRE_PER_POLL = 256,
+    IDLE_SPIN_TIMES = 64,
+  };
+
+  struct message_type {
+    id_type task_id;
+    closure_type closure;
+
+    message_type() : task_id(0) {}
+  };
+
+ public:
+  class LIBCOPP_COTASK_API_HEAD_ONLY core_type {
+   public:
+    core_type(self_type *owner, size_t index, size_t mailbox_capacity)
+        : owner_(owner),
+          index_(index),
+          task_manager_(task_manager_type::create()),
+          stack_pool_(stack_pool_type::create()),
+          mailbox_(mailbox_capacity),
+          pinned_(false),
+          sleeping_(false) {}
+
+    inline size_t get_index() const LIBCOPP_MACRO_NOEXCEPT { return index_; }
+    inline self_type &get_runtime() LIBCOPP_MACRO_NOEXCEPT { return *owner_; }
+    inline task_manager_type &get_task_manager() LIBCOPP_MACRO_NOEXCEPT { return *task_manager_; }
+    inline const typename stack_pool_type::ptr_type &get_stack_pool() const LIBCOPP_MACRO_NOEXCEPT {
+      return stack_pool_;
+    }
+
+    /**
+     * @return true if the thread of this core is bound to a cpu
+     */
+    inline bool is_pinned() const LIBCOPP_MACRO_NOEXCEPT { return pinned_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief create a task which use the stack pool of this core
+     * @note the task should be added to the task_manager of this core and run by this core only
+     * @note size of stack is decided by the stack pool, use get_stack_pool()->set_stack_size(...) to change it
+     */
+    template <class TFUNCTOR>
+    task_ptr_type create_task(TFUNCTOR &&functor, size_t stack_size = 0, size_t private_buffer_size = 0) {
+      typename macro_coroutine_type::stack_allocator_type alloc(stack_pool_);
+      return task_type::create(std::forward<TFUNCTOR>(functor), alloc, stack_size, private_buffer_size);
+    }
+
+   private:
+    friend class task_per_core_runtime;
+
+    core_type(const core_type &) = delete;
+    core_type &operator=(const core_type &) = delete;
+
+    self_type *owner_;
+    size_t index_;
+    typename task_manager_type::ptr_type task_manager_;
+    typename stack_pool_type::ptr_type stack_pool_;
+    detail::task_bounded_mailbox<message_type> mailbox_;
+    // written by the thread of this core and read by others
+    std::atomic<bool> pinned_;
+    std::atomic<bool> sleeping_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::thread thread_;
+  };
+
+ public:
+  /**
+   * @brief create a runtime
+   * @param core_count core count, use std::thread::hardware_concurrency() when it's 0
+   * @param mailbox_capacity max number of messages waiting in the mailbox of every core
+   */
+  explicit task_per_core_runtime(size_t core_count = 0, size_t mailbox_capacity = 4096)
+      : running_(false), pin_threads_(false), stopping_(false) {
+    if (0 == core_count) {
+      core_count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    if (0 == core_count) {
+      core_count = 1;
+    }
+
+    cores_.reserve(core_count);
+    for (size_t i = 0; i < core_count; ++i) {
+      cores_.push_back(std::unique_ptr<core_type>(new core_type(this, i, mailbox_capacity)));
+    }
+  }
+
+  ~task_per_core_runtime() {
+    stop();
+
+    // killed tasks may still post messages to other cores, so release all tasks before any core is destroyed
+    for (size_t i = 0; i < cores_.size(); ++i) {
+      cores_[i]->task_manager_->reset();
+    }
+  }
+
+  /**
+   * @brief create a new runtime
+   * @param core_count core count, use std::thread::hardware_concurrency() when it's 0
+   * @param mailbox_capacity max number of messages waiting in the mailbox of every core
+   * @return smart pointer of runtime
+   */
+  static ptr_type create(size_t core_count = 0, size_t mailbox_capacity = 4096) {
+    return std::make_shared<self_type>(core_count, mailbox_capacity);
+  }
+
+  /**
+   * @brief start threads of all cores
+   * @param pin_threads bind the thread of core N to cpu (N % hardware_concurrency), only linux is supported now
+   * @return 0 or error code
+   */
+  int start(bool pin_threads = true) {
+    if (running_) {
+      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_INITED;
+    }
+
+    running_ = true;
+    pin_threads_ = pin_threads;
+    stopping_.store(false, std::memory_order_release);
+    for (size_t i = 0; i < cores_.size(); ++i) {
+      core_type *core = cores_[i].get();
+      core->thread_ = std::thread([this, core]() { run_core(*core); });
+    }
+
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_SUCCESS;
+  }
+
+  /**
+   * @brief stop and join threads of all cores, messages left in mailboxes will not be handled until next start
+   * @note this can not be called by cores of this runtime
+   */
+  void stop() {
+    if (!running_) {
+      return;
+    }
+
+    stopping_.store(true, std::memory_order_release);
+    for (size_t i = 0; i < cores_.size(); ++i) {
+      std::lock_guard<std::mutex> guard(cores_[i]->sleep_mutex_);
+      cores_[i]->sleep_cv_.notify_all();
+    }
+
+    for (size_t i = 0; i < cores_.size(); ++i) {
+      if (cores_[i]->thread_.joinable()) {
+        cores_[i]->thread_.join();
+      }
+    }
+    running_ = false;
+  }
+
+  /**
+   * @brief send a message to resume a task in the task_manager of a core
+   * @param core_index index of target core
+   * @param task_id id of task, which must be added into the task_manager of target core
+   * @return false if core_index is invalid or the mailbox is full
+   */
+  bool try_post_resume(size_t core_index, id_type task_id) {
+    if (core_index >= cores_.size()) {
+      return false;
+    }
+
+    message_type message;
+    message.task_id = task_id;
+    return post_message(*cores_[core_index], std::move(message));
+  }
+
+  /**
+   * @brief send a closure to run on a core
+   * @param core_index index of target core
+   * @param closure closure to run, the target core is passed as its parameter
+   * @return false if core_index is invalid or the mailbox is full
+   */
+  bool try_post(size_t core_index, closure_type closure) {
+    if (core_index >= cores_.size() || !closure) {
+      return false;
+    }
+
+    message_type message;
+    message.closure = std::move(closure);
+    return post_message(*cores_[core_index], std::move(message));
+  }
+
+  /**
+   * @return the core which current thread belongs to, nullptr if it's not called by a core
+   */
+  static core_type *this_core() LIBCOPP_MACRO_NOEXCEPT { return current_core(); }
+
+  inline bool is_running() const LIBCOPP_MACRO_NOEXCEPT { return running_; }
+
+  inline size_t get_core_count() const LIBCOPP_MACRO_NOEXCEPT { return cores_.size(); }
+
+  inline core_type &get_core(size_t index) LIBCOPP_MACRO_NOEXCEPT { return *cores_[index]; }
+  inline const core_type &get_core(size_t index) const LIBCOPP_MACRO_NOEXCEPT { return *cores_[index]; }
+
+ private:
+  task_per_core_runtime(const task_per_core_runtime &) = delete;
+  task_per_core_runtime &operator=(const task_per_core_runtime &) = delete;
+
+  static core_type *&current_core() LIBCOPP_MACRO_NOEXCEPT {
+    static COPP_MACRO_THREAD_LOCAL core_type *ret = nullptr;
+    return ret;
+  }
+
+  static bool pin_current_thread(size_t index) {
+#  if defined(__linux__)
+    size_t cpu_count = static_cast<size_t>(std::thread::hardware_concurrency());
+    if (0 == cpu_count) {
+      return false;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(static_cast<int>(index % cpu_count), &cpu_set);
+    // pid 0 means the calling thread
+    return 0 == sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#  else
+    (void)index;
+    return false;
+#  endif
+  }
+
+  bool post_message(core_type &core, message_type &&message) {
+    if (!core.mailbox_.try_push(std::move(message))) {
+      return false;
+    }
+
+    // pair with the fence in wait_for_message(), either the core sees the new message or we see it's sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (core.sleeping_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> guard(core.sleep_mutex_);
+      core.sleep_cv_.notify_one();
+    }
+    return true;
+  }
+
+  void wait_for_message(core_type &core) {
+    std::unique_lock<std::mutex> guard(core.sleep_mutex_);
+    core.sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!stopping_.load(std::memory_order_acquire) && core.mailbox_.empty() &&
+        0 == core.task_manager_->get_ready_size()) {
+      if (core.task_manager_->get_tick_checkpoint_size() > 0) {
+        // wake up to tick timers
+        core.sleep_cv_.wait_for(guard, std::chrono::milliseconds(1));
+      } else {
+        core.sleep_cv_.wait(guard);
+      }
+    }
+    core.sleeping_.store(false, std::memory_order_relaxed);
+  }
+
+  size_t poll_core(core_type &core) {
+    // timeout of tasks are based on the last tick time, so tick before tasks are added by closures
+    std::chrono::system_clock::duration now = std::chrono::system_clock::now().time_since_epoch();
+    std::chrono::seconds now_sec = std::chrono::duration_cast<std::chrono::seconds>(now);
+    core.task_manager_->tick(
+        static_cast<time_t>(now_sec.count()),
+        static_cast<int>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - now_sec).count()),
+        MAX_EXPIRE_PER_POLL);
+
+    size_t ret = 0;
+    message_type message;
+    while (ret < MAX_MESSAGES_PER_POLL && core.mailbox_.try_pop(message)) {
+      ++ret;
+      if (message.closure) {
+        message.closure(core);
+        message.closure = nullptr;
+      } else {
+        core.task_manager_->mark_ready(message.task_id);
+      }
+    }
+
+    ret += core.task_manager_->run_ready(MAX_READY_PER_POLL);
+    return ret;
+  }
+
+  void run_core(core_type &core) {
+    current_core() = &core;
+    if (pin_threads_) {
+      core.pinned_.store(pin_current_thread(core.index_), std::memory_order_release);
+    }
+
+    size_t idle_times = 0;
+    while (!stopping_.load(std::memory_order_acquire)) {
+      if (poll_core(core) > 0) {
+        idle_times = 0;
+        continue;
+      }
+
+      if (++idle_times < IDLE_SPIN_TIMES) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      idle_times = 0;
+      wait_for_message(core);
+    }
+
+    current_core() = nullptr;
+  }
+
+ private:
+  std::vector<std::unique_ptr<core_type>> cores_;
+  bool running_;
+  bool pin_threads_;
+  std::atomic<bool> stopping_;
+};
+
+LIBCOPP_COTASK_NAMESPACE_END
+
+#endif
@@ -11,6 +11,7 @@
 #include <libcopp/utils/lock_holder.h>
 #include <libcopp/utils/spin_lock.h>
 #include <libcopp/utils/uint64_id_allocator.h>
+#include <libcopp/utils/uint64_slot_id_allocator.h>
 
 // clang-format off
 #include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
@@ -59,8 +60,13 @@ template <class TVALUE>
 class LIBCOPP_COTASK_API_HEAD_ONLY task_context_base {
  public:
   using value_type = TVALUE;
+#  if defined(LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY) && LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY
+  using id_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_slot_id_allocator::value_type;
+  using id_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_slot_id_allocator;
+#  else
   using id_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_id_allocator::value_type;
   using id_allocator_type = LIBCOPP_COPP_NAMESPACE_ID::util::uint64_id_allocator;
+#  endif
   using handle_delegate = LIBCOPP_COPP_NAMESPACE_ID::promise_caller_manager::handle_delegate;
   using task_status_type = LIBCOPP_COPP_NAMESPACE_ID::promise_status;
   using promise_flag = LIBCOPP_COPP_NAMESPACE_ID::promise_flag;
@@ -87,6 +93,9 @@ class LIBCOPP_COTASK_API_HEAD_ONLY task_context_base {
   ~task_context_base() noexcept {
     force_finish();
     force_destroy();
+
+    id_allocator_type id_allocator;
+    id_allocator.deallocate(id_);
   }
 
   UTIL_FORCEINLINE bool is_ready() const noexcept {
@@ -15,6 +15,32 @@ namespace this_task {
  */
 LIBCOPP_COTASK_API impl::task_impl *get_task() LIBCOPP_MACRO_NOEXCEPT;
 
+/**
+ * @brief get arena of current running task
+ * @note all memory allocated from the arena is released when the task is finished
+ * @return arena of current running task or nullptr when not in task
+ */
+LIBCOPP_COTASK_API task_arena *get_arena() LIBCOPP_MACRO_NOEXCEPT;
+
+/**
+ * @brief get private buffer of current running task
+ * @param buffer_size where to store the size of private buffer, it can be nullptr
+ * @return private buffer of current running task or nullptr when not in task
+ */
+LIBCOPP_COTASK_API void *get_private_buffer(size_t *buffer_size = nullptr) LIBCOPP_MACRO_NOEXCEPT;
+
+/**
+ * @brief get private data of current running task
+ * @note the task should be created by task::create_with_private_data<TPRIVATE_DATA>(...)
+ * @return private data of current running task or nullptr when not in task or private buffer is too small
+ */
+template <typename TPRIVATE_DATA>
+LIBCOPP_COTASK_API_HEAD_ONLY TPRIVATE_DATA *get_private_data() LIBCOPP_MACRO_NOEXCEPT {
+  size_t buffer_size = 0;
+  void *buffer = get_private_buffer(&buffer_size);
+  return impl::task_impl::get_private_data_address<TPRIVATE_DATA>(buffer, buffer_size);
+}
+
 /**
  * @brief get current running task and try to convert type
  * @return current running task or empty pointer when not in task or fail to convert type
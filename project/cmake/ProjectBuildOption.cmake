@@ -62,11 +62,19 @@ option(LIBCOPP_FCONTEXT_USE_TSX "Enable Intel Transactional Synchronisation Exte
 # consequence floating point operations, e.g. store/load of floating point related registers during a fiber (context)
 # switch are disabled.]
 
+# Record run time, switch count and the longest uninterrupted run of each coroutine context
+option(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING "Enable run time and switch accounting of coroutine context." OFF)
+# Thread-local on_switch_in/on_switch_out hooks for tracers and schedulers
+option(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK "Enable switch hooks of coroutine context." OFF)
+
 # libcotask configure
 option(LIBCOTASK_ENABLE "Enable libcotask." ON)
 # libcotask configure
 option(LIBCOTASK_AUTO_CLEANUP_MANAGER
        "Auto cleanup task manager after cotask finished(No need to call task_manager.start/resume())." ON)
+# Allocate task ids by uint64_slot_id_allocator and use slot map as the task registry of task_manager
+option(LIBCOTASK_MACRO_ENABLE_SLOT_MAP_REGISTRY "Use slot-map task registry with generational ids in task_manager."
+       OFF)
 
 # unit test framework
 set(GTEST_ROOT
@@ -0,0 +1,148 @@
+// Copyright 2023 owent
+// static_task benchmark, compare task<> with virtual dispatch and static_task with action type known at compile time
+
+#include <libcopp/stack/stack_pool.h>
+#include <libcotask/static_task.h>
+#include <libcotask/task.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#ifdef LIBCOTASK_MACRO_ENABLED
+
+#  if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#    include <chrono>
+#    define CALC_CLOCK_T std::chrono::steady_clock::time_point
+#    define CALC_CLOCK_NOW() std::chrono::steady_clock::now()
+#    define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#    define CALC_NS_AVG_CLOCK(x, y) \
+      static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#  else
+#    define CALC_CLOCK_T clock_t
+#    define CALC_CLOCK_NOW() clock()
+#    define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#    define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#  endif
+
+int switch_count = 100;
+int max_task_number = 100000;
+size_t stack_size = 16 * 1024;
+
+// yield by the current coroutine, both kinds of tasks run the same code
+struct switch_action {
+  int *finished_count;
+
+  explicit switch_action(int *c) : finished_count(c) {}
+
+  int operator()(void *) {
+    int count = switch_count;
+    copp::coroutine_context *self = copp::this_coroutine::get_coroutine();
+    while (count-- > 0) {
+      self->yield();
+    }
+    ++(*finished_count);
+    return 0;
+  }
+};
+
+typedef copp::stack_pool<copp::allocator::default_statck_allocator> stack_pool_t;
+
+struct stack_pool_macro_coroutine {
+  using stack_allocator_type = copp::allocator::stack_allocator_pool<stack_pool_t>;
+  using coroutine_type = copp::coroutine_context_container<stack_allocator_type>;
+  using value_type = int;
+};
+
+typedef cotask::task<stack_pool_macro_coroutine> dynamic_task_t;
+typedef cotask::static_task<switch_action, stack_pool_macro_coroutine> static_task_t;
+
+template <class TTASK_PTR, class TCREATOR>
+static void benchmark_round(const char *name, int index, TCREATOR &&creator) {
+  std::vector<TTASK_PTR> task_arr;
+  task_arr.reserve(static_cast<size_t>(max_task_number));
+  int finished_count = 0;
+
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  while (task_arr.size() < static_cast<size_t>(max_task_number)) {
+    TTASK_PTR new_task = creator(&finished_count);
+    if (!new_task) {
+      fprintf(stderr, "create coroutine task failed, real size is %d.\n", static_cast<int>(task_arr.size()));
+      fprintf(stderr, "maybe sysconf [vm.max_map_count] extended.\n");
+      max_task_number = static_cast<int>(task_arr.size());
+      break;
+    }
+    task_arr.push_back(new_task);
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("%s round %d, create %d task(s), cost time: %d ms, avg: %lld ns\n", name, index, max_task_number,
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, max_task_number));
+
+  begin_clock = end_clock;
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    task_arr[i]->start();
+  }
+  while (finished_count < max_task_number) {
+    for (size_t i = 0; i < task_arr.size(); ++i) {
+      task_arr[i]->resume();
+    }
+  }
+  end_clock = CALC_CLOCK_NOW();
+  long long total_switch_times = static_cast<long long>(max_task_number) * (switch_count + 1);
+  printf("%s round %d, switch %lld time(s), cost time: %d ms, avg: %lld ns\n", name, index, total_switch_times,
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, total_switch_times));
+
+  begin_clock = end_clock;
+  task_arr.clear();
+  end_clock = CALC_CLOCK_NOW();
+  printf("%s round %d, release %d task(s), cost time: %d ms, avg: %lld ns\n", name, index, max_task_number,
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, max_task_number));
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### static_task - devirtualized task ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    switch_count = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    stack_size = static_cast<size_t>(atoi(argv[3]) * 1024);
+  }
+
+  stack_pool_t::ptr_t stack_pool = stack_pool_t::create();
+  stack_pool->set_stack_size(stack_size);
+  stack_pool->set_min_stack_number(static_cast<size_t>(max_task_number));
+
+  for (int i = 1; i <= 2; ++i) {
+    benchmark_round<dynamic_task_t::ptr_t>("task<>", i, [&stack_pool](int *finished_count) {
+      copp::allocator::stack_allocator_pool<stack_pool_t> alloc(stack_pool);
+      return dynamic_task_t::create(switch_action(finished_count), alloc, stack_size);
+    });
+
+    benchmark_round<static_task_t::ptr_type>("static_task", i, [&stack_pool](int *finished_count) {
+      copp::allocator::stack_allocator_pool<stack_pool_t> alloc(stack_pool);
+      return static_task_t::create(switch_action(finished_count), alloc, stack_size);
+    });
+  }
+  return 0;
+}
+#else
+int main() {
+  puts("cotask disabled.");
+  return 0;
+}
+#endif
@@ -0,0 +1,142 @@
+// Copyright 2023 owent
+// task_executor benchmark, scaling of work-stealing workers from 1 to all cores with uneven workloads
+
+#include <libcotask/task.h>
+#include <libcotask/task_executor.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#if defined(LIBCOTASK_MACRO_ENABLED) && LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR
+
+#  if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#    include <chrono>
+#    define CALC_CLOCK_T std::chrono::steady_clock::time_point
+#    define CALC_CLOCK_NOW() std::chrono::steady_clock::now()
+#    define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#    define CALC_NS_AVG_CLOCK(x, y) \
+      static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#  else
+#    define CALC_CLOCK_T clock_t
+#    define CALC_CLOCK_NOW() clock()
+#    define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#    define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#  endif
+
+using benchmark_executor_type = cotask::task_executor<>;
+using benchmark_task_type = benchmark_executor_type::task_type;
+
+int switch_count = 100;
+// every stack uses 2 mappings with the guard page, keep the default far below vm.max_map_count(65530 by default), or
+// workers may fail to allocate memory when running
+int max_task_number = 20000;
+size_t stack_size = 16 * 1024;
+
+// some cpu work between two switches
+static uint64_t busy_work(uint64_t seed) {
+  for (int i = 0; i < 64; ++i) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+  }
+  return seed;
+}
+
+static std::atomic<uint64_t> g_benchmark_result(0);
+
+static void benchmark_round(size_t worker_count) {
+  benchmark_executor_type::ptr_type executor = benchmark_executor_type::create(worker_count);
+  // start workers before creating tasks, stacks of tasks may use up all mappings
+  executor->start();
+
+  std::vector<benchmark_task_type::ptr_t> task_arr;
+  task_arr.reserve(static_cast<size_t>(max_task_number));
+
+  long long total_switch_times = 0;
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  for (int i = 0; i < max_task_number; ++i) {
+    // uneven workload, every 16th task switches 8 times more than others
+    int count = 0 == i % 16 ? switch_count * 8 : switch_count;
+    benchmark_task_type::ptr_t new_task = benchmark_task_type::create(
+        [count](void *) {
+          uint64_t seed = static_cast<uint64_t>(count) + 1;
+          for (int j = 0; j < count; ++j) {
+            seed = busy_work(seed);
+            benchmark_executor_type::yield();
+          }
+          g_benchmark_result.fetch_add(seed, std::memory_order_relaxed);
+          return 0;
+        },
+        stack_size);
+    if (!new_task) {
+      fprintf(stderr, "create coroutine task failed, real size is %d.\n", static_cast<int>(task_arr.size()));
+      fprintf(stderr, "maybe sysconf [vm.max_map_count] extended.\n");
+      max_task_number = static_cast<int>(task_arr.size());
+      break;
+    }
+
+    total_switch_times += count;
+    task_arr.push_back(new_task);
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("create %d task(s), cost time: %d ms\n", max_task_number, CALC_MS_CLOCK(end_clock - begin_clock));
+
+  begin_clock = CALC_CLOCK_NOW();
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    executor->post(task_arr[i]);
+  }
+  executor->wait_idle();
+  end_clock = CALC_CLOCK_NOW();
+  printf("%d worker(s), switch %lld time(s), steal %llu time(s), cost time: %d ms, avg: %lld ns\n",
+         static_cast<int>(worker_count), total_switch_times,
+         static_cast<unsigned long long>(executor->get_steal_count()), CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, total_switch_times));
+
+  executor->stop();
+  task_arr.clear();
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task_executor - work stealing ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    switch_count = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    stack_size = static_cast<size_t>(atoi(argv[3]) * 1024);
+  }
+
+  size_t max_worker_count = static_cast<size_t>(std::thread::hardware_concurrency());
+  if (0 == max_worker_count) {
+    max_worker_count = 1;
+  }
+
+  for (size_t worker_count = 1; worker_count < max_worker_count; worker_count <<= 1) {
+    benchmark_round(worker_count);
+  }
+  benchmark_round(max_worker_count);
+  return 0;
+}
+#else
+int main() {
+  puts("task_executor disabled.");
+  return 0;
+}
+#endif
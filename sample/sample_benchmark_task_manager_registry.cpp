@@ -0,0 +1,151 @@
+// Copyright 2023 owent
+// task registry benchmark, std::unordered_map vs slot map with generational ids
+
+#include <libcopp/utils/uint64_id_allocator.h>
+#include <libcopp/utils/uint64_slot_id_allocator.h>
+#include <libcotask/impl/task_slot_map.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#  include <chrono>
+#  define CALC_CLOCK_T std::chrono::system_clock::time_point
+#  define CALC_CLOCK_NOW() std::chrono::system_clock::now()
+#  define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#  define CALC_NS_AVG_CLOCK(x, y) \
+    static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#else
+#  define CALC_CLOCK_T clock_t
+#  define CALC_CLOCK_NOW() clock()
+#  define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#  define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#endif
+
+// the same layout as task_manager_node of task<>
+struct benchmark_registry_node {
+  std::shared_ptr<int> task_;
+  void *timer_node;
+};
+
+int max_task_number = 1000000;
+int lookup_round = 10;
+// slot ids are allocated by a global allocator, so the registry of one manager only holds a few of all living ids
+int sparse_step = 300;
+
+template <class TCONTAINER>
+static void benchmark_registry(const char *name, const std::vector<uint64_t> &ids,
+                               const std::vector<uint64_t> &lookup_order) {
+  printf("### %s ###\n", name);
+  std::shared_ptr<int> task_inst = std::make_shared<int>(0);
+  TCONTAINER container;
+
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  for (uint64_t id : ids) {
+    benchmark_registry_node node;
+    node.task_ = task_inst;
+    node.timer_node = nullptr;
+    container.insert(typename TCONTAINER::value_type(id, node));
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("insert %d task(s), clock time: %d ms, avg: %lld ns\n", static_cast<int>(ids.size()),
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, ids.size()));
+
+  size_t found = 0;
+  long long lookup_times = static_cast<long long>(lookup_order.size()) * lookup_round;
+  begin_clock = CALC_CLOCK_NOW();
+  for (int i = 0; i < lookup_round; ++i) {
+    for (uint64_t id : lookup_order) {
+      typename TCONTAINER::iterator iter = container.find(id);
+      if (iter != container.end() && iter->second.task_) {
+        ++found;
+      }
+    }
+  }
+  end_clock = CALC_CLOCK_NOW();
+  printf("find %lld time(s) in random order(found %lld), clock time: %d ms, avg: %lld ns\n", lookup_times,
+         static_cast<long long>(found), CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, lookup_times));
+
+  begin_clock = CALC_CLOCK_NOW();
+  for (uint64_t id : lookup_order) {
+    typename TCONTAINER::iterator iter = container.find(id);
+    if (iter != container.end()) {
+      container.erase(iter);
+    }
+  }
+  end_clock = CALC_CLOCK_NOW();
+  printf("erase %d task(s), clock time: %d ms, avg: %lld ns\n", static_cast<int>(lookup_order.size()),
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, lookup_order.size()));
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task registry - unordered_map vs slot map ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    lookup_round = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    sparse_step = atoi(argv[3]);
+  }
+  if (sparse_step <= 0) {
+    sparse_step = 1;
+  }
+
+  std::mt19937 rnd(static_cast<std::mt19937::result_type>(max_task_number));
+  std::vector<uint64_t> ids;
+  ids.reserve(static_cast<size_t>(max_task_number));
+  for (int i = 0; i < max_task_number; ++i) {
+    ids.push_back(copp::util::uint64_id_allocator::allocate());
+  }
+  std::vector<uint64_t> lookup_order = ids;
+  std::shuffle(lookup_order.begin(), lookup_order.end(), rnd);
+  benchmark_registry<std::unordered_map<uint64_t, benchmark_registry_node>>("std::unordered_map", ids, lookup_order);
+
+  ids.clear();
+  for (int i = 0; i < max_task_number; ++i) {
+    ids.push_back(copp::util::uint64_slot_id_allocator::allocate());
+  }
+  lookup_order = ids;
+  std::shuffle(lookup_order.begin(), lookup_order.end(), rnd);
+  benchmark_registry<cotask::detail::task_slot_map<uint64_t, benchmark_registry_node>>("task_slot_map", ids,
+                                                                                        lookup_order);
+
+  // only one of sparse_step living ids is in the registry, erase must not scan the empty slots
+  std::vector<uint64_t> sparse_ids;
+  sparse_ids.reserve(ids.size() / static_cast<size_t>(sparse_step) + 1);
+  for (size_t i = 0; i < ids.size(); i += static_cast<size_t>(sparse_step)) {
+    sparse_ids.push_back(ids[i]);
+  }
+  lookup_order = sparse_ids;
+  std::shuffle(lookup_order.begin(), lookup_order.end(), rnd);
+  benchmark_registry<std::unordered_map<uint64_t, benchmark_registry_node>>("std::unordered_map(sparse)", sparse_ids,
+                                                                            lookup_order);
+  benchmark_registry<cotask::detail::task_slot_map<uint64_t, benchmark_registry_node>>("task_slot_map(sparse)",
+                                                                                        sparse_ids, lookup_order);
+
+  for (uint64_t id : ids) {
+    copp::util::uint64_slot_id_allocator::deallocate(id);
+  }
+
+  return 0;
+}
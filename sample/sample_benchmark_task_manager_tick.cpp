@@ -0,0 +1,122 @@
+// Copyright 2023 owent
+// task_manager expiration benchmark, cost of every timeout task killed by tick(...)
+
+#include <libcotask/task_manager.h>
+#include <libcotask/task_promise.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <vector>
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_COROUTINE) && LIBCOPP_MACRO_ENABLE_STD_COROUTINE
+
+#  ifdef LIBCOTASK_MACRO_ENABLED
+
+#    if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#      include <chrono>
+#      define CALC_CLOCK_T std::chrono::system_clock::time_point
+#      define CALC_CLOCK_NOW() std::chrono::system_clock::now()
+#      define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#      define CALC_NS_AVG_CLOCK(x, y) \
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#    else
+#      define CALC_CLOCK_T clock_t
+#      define CALC_CLOCK_NOW() clock()
+#      define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#      define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#    endif
+
+using benchmark_task_future_type = cotask::task_future<int64_t, void>;
+using benchmark_task_manager_type = cotask::task_manager<benchmark_task_future_type>;
+
+int max_task_number = 1000000;
+int max_expire_per_tick = 0;
+
+static benchmark_task_future_type run_benchmark() { co_return 0; }
+
+static void benchmark_round(bool use_timer_wheel, size_t max_expire) {
+  if (max_expire == std::numeric_limits<size_t>::max()) {
+    printf("### %s, kill all timeout tasks in one tick ###\n", use_timer_wheel ? "timing wheel" : "std::set checkpoints");
+  } else {
+    printf("### %s, kill at most %llu timeout task(s) per tick ###\n",
+           use_timer_wheel ? "timing wheel" : "std::set checkpoints", static_cast<unsigned long long>(max_expire));
+  }
+
+  std::vector<benchmark_task_future_type> task_list;
+  task_list.reserve(static_cast<size_t>(max_task_number));
+  while (task_list.size() < static_cast<size_t>(max_task_number)) {
+    task_list.push_back(run_benchmark());
+  }
+
+  benchmark_task_manager_type::ptr_type task_mgr = benchmark_task_manager_type::create();
+  if (use_timer_wheel) {
+    task_mgr->set_timer_wheel(cotask::task_timer_wheel_config());
+  }
+  task_mgr->tick(1, 0);
+
+  // all tasks timeout at the same time, just like a clock jump
+  for (auto &task_inst : task_list) {
+    task_mgr->add_task(task_inst, 1, 0);
+  }
+
+  long long tick_times = 0;
+  long long max_tick_ns = 0;
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  while (task_mgr->get_task_size() > 0) {
+    CALC_CLOCK_T tick_begin_clock = CALC_CLOCK_NOW();
+    task_mgr->tick(3, 0, max_expire);
+    CALC_CLOCK_T tick_end_clock = CALC_CLOCK_NOW();
+    long long tick_ns = CALC_NS_AVG_CLOCK(tick_end_clock - tick_begin_clock, 1);
+    if (tick_ns > max_tick_ns) {
+      max_tick_ns = tick_ns;
+    }
+    ++tick_times;
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("tick %lld time(s) and timeout %d task(s), clock time: %d ms, avg: %lld ns per task, max: %lld ns per tick\n",
+         tick_times, max_task_number, CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, max_task_number), max_tick_ns);
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task_manager - tick expiration ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    max_expire_per_tick = atoi(argv[2]);
+  }
+
+  benchmark_round(false, std::numeric_limits<size_t>::max());
+  benchmark_round(true, std::numeric_limits<size_t>::max());
+  if (max_expire_per_tick > 0) {
+    benchmark_round(false, static_cast<size_t>(max_expire_per_tick));
+    benchmark_round(true, static_cast<size_t>(max_expire_per_tick));
+  }
+  return 0;
+}
+#  else
+int main() {
+  puts("task_future disabled.");
+  return 0;
+}
+#  endif
+
+#else
+int main() {
+  puts("std coroutine is not supported by current compiler.");
+  return 0;
+}
+#endif
@@ -0,0 +1,141 @@
+// Copyright 2023 owent
+// task_manager timer churn benchmark, std::set checkpoints vs hierarchical timing wheel
+
+#include <libcotask/task_manager.h>
+#include <libcotask/task_promise.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <vector>
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_COROUTINE) && LIBCOPP_MACRO_ENABLE_STD_COROUTINE
+
+#  ifdef LIBCOTASK_MACRO_ENABLED
+
+#    if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#      include <chrono>
+#      define CALC_CLOCK_T std::chrono::system_clock::time_point
+#      define CALC_CLOCK_NOW() std::chrono::system_clock::now()
+#      define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#      define CALC_NS_AVG_CLOCK(x, y) \
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#    else
+#      define CALC_CLOCK_T clock_t
+#      define CALC_CLOCK_NOW() clock()
+#      define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#      define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#    endif
+
+using benchmark_task_future_type = cotask::task_future<int64_t, void>;
+using benchmark_task_manager_type = cotask::task_manager<benchmark_task_future_type>;
+
+int max_task_number = 1000000;
+int churn_count = 4;
+int max_timeout_sec = 60;
+
+static benchmark_task_future_type run_benchmark() { co_return 0; }
+
+static void benchmark_round(bool use_timer_wheel) {
+  printf("### %s ###\n", use_timer_wheel ? "timing wheel" : "std::set checkpoints");
+
+  std::mt19937 rnd(static_cast<std::mt19937::result_type>(max_task_number));
+  std::vector<benchmark_task_future_type> task_list;
+  task_list.reserve(static_cast<size_t>(max_task_number));
+  while (task_list.size() < static_cast<size_t>(max_task_number)) {
+    task_list.push_back(run_benchmark());
+  }
+
+  benchmark_task_manager_type::ptr_type task_mgr = benchmark_task_manager_type::create();
+  if (use_timer_wheel) {
+    task_mgr->set_timer_wheel(cotask::task_timer_wheel_config());
+  }
+  time_t now_sec = 1;
+  int now_nsec = 0;
+  task_mgr->tick(now_sec, now_nsec);
+
+  // add tasks with timeout
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  for (auto &task_inst : task_list) {
+    task_mgr->add_task(task_inst, static_cast<time_t>(rnd() % static_cast<uint32_t>(max_timeout_sec)) + 1,
+                       static_cast<int>(rnd() % 1000000000));
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("add %d task(s) with timeout, clock time: %d ms, avg: %lld ns\n", max_task_number,
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, max_task_number));
+
+  // update timeout of all tasks
+  long long churn_times = static_cast<long long>(max_task_number) * churn_count;
+  begin_clock = CALC_CLOCK_NOW();
+  for (int i = 0; i < churn_count; ++i) {
+    for (auto &task_inst : task_list) {
+      time_t timeout_sec = static_cast<time_t>(rnd() % static_cast<uint32_t>(max_timeout_sec)) + 1;
+      task_mgr->set_timeout(task_inst.get_id(), timeout_sec, static_cast<int>(rnd() % 1000000000));
+    }
+  }
+  end_clock = CALC_CLOCK_NOW();
+  printf("update timeout of %d task(s) for %d time(s), clock time: %d ms, avg: %lld ns\n", max_task_number,
+         churn_count, CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, churn_times));
+
+  // tick every 10ms until all tasks timeout
+  long long tick_times = 0;
+  begin_clock = CALC_CLOCK_NOW();
+  while (task_mgr->get_task_size() > 0) {
+    now_nsec += 10000000;
+    if (now_nsec >= 1000000000) {
+      now_nsec -= 1000000000;
+      ++now_sec;
+    }
+    task_mgr->tick(now_sec, now_nsec);
+    ++tick_times;
+  }
+  end_clock = CALC_CLOCK_NOW();
+  printf("tick %lld time(s) and timeout %d task(s), clock time: %d ms, avg: %lld ns per task\n", tick_times,
+         max_task_number, CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, max_task_number));
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task_manager - timer churn ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    churn_count = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    max_timeout_sec = atoi(argv[3]);
+  }
+  if (max_timeout_sec <= 0) {
+    max_timeout_sec = 1;
+  }
+
+  benchmark_round(false);
+  benchmark_round(true);
+  return 0;
+}
+#  else
+int main() {
+  puts("task_future disabled.");
+  return 0;
+}
+#  endif
+
+#else
+int main() {
+  puts("std coroutine is not supported by current compiler.");
+  return 0;
+}
+#endif
@@ -0,0 +1,179 @@
+// Copyright 2023 owent
+// task_per_core_runtime benchmark, ping-pong latency of tasks on two cores through mailboxes
+
+#include <libcotask/task.h>
+#include <libcotask/task_per_core_runtime.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#if defined(LIBCOTASK_MACRO_ENABLED) && LIBCOTASK_MACRO_ENABLE_TASK_PER_CORE_RUNTIME
+
+#  if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#    include <chrono>
+#    define CALC_CLOCK_T std::chrono::steady_clock::time_point
+#    define CALC_CLOCK_NOW() std::chrono::steady_clock::now()
+#    define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#    define CALC_NS_AVG_CLOCK(x, y) \
+      static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#  else
+#    define CALC_CLOCK_T clock_t
+#    define CALC_CLOCK_NOW() clock()
+#    define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#    define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#  endif
+
+using benchmark_runtime_type = cotask::task_per_core_runtime<>;
+
+int max_pair_number = 1000;
+std::atomic<int> real_pair_number(0);
+int round_trip_count = 1000;
+size_t stack_size = 16 * 1024;
+
+// ids of tasks, ping tasks run on core 0 and pong tasks run on core 1
+std::vector<benchmark_runtime_type::id_type> ping_ids;
+std::vector<benchmark_runtime_type::id_type> pong_ids;
+std::atomic<int> ready_count(0);
+std::atomic<int> finished_count(0);
+std::atomic<long long> post_failed_count(0);
+
+static void post_resume(benchmark_runtime_type::core_type &core, size_t core_index,
+                        benchmark_runtime_type::id_type task_id) {
+  // mailbox is large enough for all pairs, this should not happen
+  if (!core.get_runtime().try_post_resume(core_index, task_id)) {
+    ++post_failed_count;
+  }
+}
+
+static void create_pong_tasks(benchmark_runtime_type::core_type &core) {
+  core.get_stack_pool()->set_stack_size(stack_size);
+  real_pair_number.store(0);
+  for (int i = 0; i < max_pair_number; ++i) {
+    size_t index = static_cast<size_t>(i);
+    benchmark_runtime_type::task_ptr_type task_inst = core.create_task(
+        [&core, index](void *) {
+          for (int j = 0; j < round_trip_count; ++j) {
+            cotask::this_task::get_task()->yield();
+            post_resume(core, 0, ping_ids[index]);
+          }
+          return 0;
+        },
+        stack_size);
+    if (!task_inst) {
+      fprintf(stderr, "create coroutine task failed, real pair number is %d.\n", real_pair_number.load());
+      break;
+    }
+    pong_ids[index] = task_inst->get_id();
+    core.get_task_manager().add_task(task_inst);
+    core.get_task_manager().start(task_inst->get_id());
+    ++real_pair_number;
+  }
+  ++ready_count;
+}
+
+static void create_ping_tasks(benchmark_runtime_type::core_type &core) {
+  core.get_stack_pool()->set_stack_size(stack_size);
+  std::vector<benchmark_runtime_type::task_ptr_type> task_arr;
+  int pair_number = real_pair_number.load();
+  task_arr.reserve(static_cast<size_t>(pair_number));
+  for (int i = 0; i < pair_number; ++i) {
+    size_t index = static_cast<size_t>(i);
+    benchmark_runtime_type::task_ptr_type task_inst = core.create_task(
+        [&core, index](void *) {
+          for (int j = 0; j < round_trip_count; ++j) {
+            post_resume(core, 1, pong_ids[index]);
+            cotask::this_task::get_task()->yield();
+          }
+          ++finished_count;
+          return 0;
+        },
+        stack_size);
+    if (!task_inst) {
+      fprintf(stderr, "create coroutine task failed, real pair number is %d.\n", i);
+      // pong tasks without ping just wait until the runtime is destroyed
+      real_pair_number.store(i);
+      break;
+    }
+    ping_ids[index] = task_inst->get_id();
+    core.get_task_manager().add_task(task_inst);
+    task_arr.push_back(task_inst);
+  }
+
+  // all ids are set before any ping is sent
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    core.get_task_manager().start(task_arr[i]->get_id());
+  }
+}
+
+static void benchmark_round(bool pin_threads) {
+  printf("### ping-pong between 2 cores, %s ###\n", pin_threads ? "pinned" : "not pinned");
+  ping_ids.assign(static_cast<size_t>(max_pair_number), 0);
+  pong_ids.assign(static_cast<size_t>(max_pair_number), 0);
+  ready_count.store(0);
+  finished_count.store(0);
+  post_failed_count.store(0);
+
+  // every pair has at most one message in flight
+  size_t mailbox_capacity = static_cast<size_t>(max_pair_number) + 1;
+  benchmark_runtime_type::ptr_type runtime = benchmark_runtime_type::create(2, mailbox_capacity);
+  runtime->start(pin_threads);
+
+  runtime->try_post(1, create_pong_tasks);
+  while (ready_count.load() < 1) {
+    std::this_thread::yield();
+  }
+
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  runtime->try_post(0, create_ping_tasks);
+  while (finished_count.load() < real_pair_number.load()) {
+    std::this_thread::yield();
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+
+  long long total_round_trips = static_cast<long long>(real_pair_number.load()) * round_trip_count;
+  printf("core 0 pinned: %s, core 1 pinned: %s\n", runtime->get_core(0).is_pinned() ? "yes" : "no",
+         runtime->get_core(1).is_pinned() ? "yes" : "no");
+  printf("%d pair(s), %lld round trip(s), post failed %lld time(s), cost time: %d ms, avg: %lld ns per round trip\n",
+         real_pair_number.load(), total_round_trips, post_failed_count.load(), CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, total_round_trips));
+
+  runtime->stop();
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task_per_core_runtime - ping-pong ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_pair_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    round_trip_count = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    stack_size = static_cast<size_t>(atoi(argv[3]) * 1024);
+  }
+
+  benchmark_round(false);
+  benchmark_round(true);
+  return 0;
+}
+#else
+int main() {
+  puts("task_per_core_runtime disabled.");
+  return 0;
+}
+#endif
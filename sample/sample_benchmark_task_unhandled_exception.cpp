@@ -0,0 +1,189 @@
+// Copyright 2023 owent
+// task benchmark, count memory allocations of start/resume/kill, unhandled exceptions are collected inline
+
+#include <libcopp/stack/stack_pool.h>
+#include <libcotask/task.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <vector>
+
+#if defined(LIBCOTASK_MACRO_ENABLED) && defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && \
+    LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+
+#  if defined(PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO) && PROJECT_LIBCOPP_SAMPLE_HAS_CHRONO
+#    include <chrono>
+#    define CALC_CLOCK_T std::chrono::steady_clock::time_point
+#    define CALC_CLOCK_NOW() std::chrono::steady_clock::now()
+#    define CALC_MS_CLOCK(x) static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(x).count())
+#    define CALC_NS_AVG_CLOCK(x, y) \
+      static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(x).count() / (y ? y : 1))
+#  else
+#    define CALC_CLOCK_T clock_t
+#    define CALC_CLOCK_NOW() clock()
+#    define CALC_MS_CLOCK(x) static_cast<int>((x) / (CLOCKS_PER_SEC / 1000))
+#    define CALC_NS_AVG_CLOCK(x, y) (1000000LL * static_cast<long long>((x) / (CLOCKS_PER_SEC / 1000)) / (y ? y : 1))
+#  endif
+
+static std::atomic<long long> g_allocation_count(0);
+
+void *operator new(size_t sz) {
+  ++g_allocation_count;
+  void *ret = malloc(sz > 0 ? sz : 1);
+  if (nullptr == ret) {
+    throw std::bad_alloc();
+  }
+  return ret;
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+typedef copp::stack_pool<copp::allocator::default_statck_allocator> stack_pool_t;
+
+struct stack_pool_macro_coroutine {
+  using stack_allocator_type = copp::allocator::stack_allocator_pool<stack_pool_t>;
+  using coroutine_type = copp::coroutine_context_container<stack_allocator_type>;
+  using value_type = int;
+};
+
+typedef cotask::task<stack_pool_macro_coroutine> benchmark_task_t;
+
+int switch_count = 100;
+int max_task_number = 100000;
+size_t stack_size = 16 * 1024;
+
+static int yield_action(void *) {
+  int count = switch_count;
+  while (count-- > 0) {
+    cotask::this_task::get_task()->yield();
+  }
+  return 0;
+}
+
+// std::runtime_error allocates its message, use an exception without memory allocation
+struct benchmark_exception {
+  int code;
+};
+
+static int throw_action(void *) { throw benchmark_exception{1}; }
+
+static void create_tasks(stack_pool_t::ptr_t &stack_pool, std::vector<benchmark_task_t::ptr_t> &task_arr,
+                         int (*fn)(void *)) {
+  task_arr.reserve(static_cast<size_t>(max_task_number));
+  while (task_arr.size() < static_cast<size_t>(max_task_number)) {
+    copp::allocator::stack_allocator_pool<stack_pool_t> alloc(stack_pool);
+    benchmark_task_t::ptr_t new_task = benchmark_task_t::create(fn, alloc, stack_size);
+    if (!new_task) {
+      fprintf(stderr, "create coroutine task failed, real size is %d.\n", static_cast<int>(task_arr.size()));
+      fprintf(stderr, "maybe sysconf [vm.max_map_count] extended.\n");
+      max_task_number = static_cast<int>(task_arr.size());
+      break;
+    }
+    task_arr.push_back(new_task);
+  }
+}
+
+static void benchmark_success_path(stack_pool_t::ptr_t &stack_pool) {
+  std::vector<benchmark_task_t::ptr_t> task_arr;
+  create_tasks(stack_pool, task_arr, yield_action);
+
+  long long allocation_count = g_allocation_count.load();
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    task_arr[i]->start();
+  }
+  bool is_continue = true;
+  while (is_continue) {
+    is_continue = false;
+    for (size_t i = 0; i < task_arr.size(); ++i) {
+      if (!task_arr[i]->is_completed()) {
+        task_arr[i]->resume();
+        is_continue = true;
+      }
+    }
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+
+  long long total_switch_times = static_cast<long long>(task_arr.size()) * (switch_count + 1);
+  printf("start/resume %lld time(s), cost time: %d ms, avg: %lld ns, allocation count: %lld\n", total_switch_times,
+         CALC_MS_CLOCK(end_clock - begin_clock), CALC_NS_AVG_CLOCK(end_clock - begin_clock, total_switch_times),
+         g_allocation_count.load() - allocation_count);
+
+  // kill suspended tasks
+  task_arr.clear();
+  create_tasks(stack_pool, task_arr, yield_action);
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    task_arr[i]->start();
+  }
+
+  allocation_count = g_allocation_count.load();
+  begin_clock = CALC_CLOCK_NOW();
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    task_arr[i]->kill(cotask::EN_TS_KILLED);
+  }
+  end_clock = CALC_CLOCK_NOW();
+  printf("kill %d task(s), cost time: %d ms, avg: %lld ns, allocation count: %lld\n",
+         static_cast<int>(task_arr.size()), CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, task_arr.size()), g_allocation_count.load() - allocation_count);
+}
+
+static void benchmark_exception_path(stack_pool_t::ptr_t &stack_pool) {
+  std::vector<benchmark_task_t::ptr_t> task_arr;
+  create_tasks(stack_pool, task_arr, throw_action);
+
+  long long caught_count = 0;
+  long long allocation_count = g_allocation_count.load();
+  CALC_CLOCK_T begin_clock = CALC_CLOCK_NOW();
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    cotask::unhandled_exception_list eptrs;
+    task_arr[i]->start(eptrs, nullptr);
+    caught_count += static_cast<long long>(eptrs.size());
+  }
+  CALC_CLOCK_T end_clock = CALC_CLOCK_NOW();
+  printf("collect %lld unhandled exception(s), cost time: %d ms, avg: %lld ns, allocation count: %lld\n",
+         caught_count, CALC_MS_CLOCK(end_clock - begin_clock),
+         CALC_NS_AVG_CLOCK(end_clock - begin_clock, task_arr.size()), g_allocation_count.load() - allocation_count);
+}
+
+int main(int argc, char *argv[]) {
+  puts("###################### task - unhandled exception ###################");
+  printf("########## Cmd:");
+  for (int i = 0; i < argc; ++i) {
+    printf(" %s", argv[i]);
+  }
+  puts("");
+
+  if (argc > 1) {
+    max_task_number = atoi(argv[1]);
+  }
+
+  if (argc > 2) {
+    switch_count = atoi(argv[2]);
+  }
+
+  if (argc > 3) {
+    stack_size = static_cast<size_t>(atoi(argv[3]) * 1024);
+  }
+
+  stack_pool_t::ptr_t stack_pool = stack_pool_t::create();
+  stack_pool->set_stack_size(stack_size);
+  stack_pool->set_min_stack_number(static_cast<size_t>(max_task_number));
+
+  benchmark_success_path(stack_pool);
+  benchmark_exception_path(stack_pool);
+  return 0;
+}
+#else
+int main() {
+  puts("cotask or std::exception_ptr disabled.");
+  return 0;
+}
+#endif
@@ -65,15 +65,52 @@ static inline coroutine_context_base *get_this_coroutine_context() {
   return reinterpret_cast<coroutine_context_base *>(pthread_getspecific(gt_coroutine_tls_key));
 #endif
 }
+
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+#  if defined(LIBCOPP_LOCK_DISABLE_THIS_MT) && LIBCOPP_LOCK_DISABLE_THIS_MT
+static const coroutine_context_base::switch_hook_type *gt_switch_hook = nullptr;
+#  elif defined(COPP_MACRO_THREAD_LOCAL)
+static COPP_MACRO_THREAD_LOCAL const coroutine_context_base::switch_hook_type *gt_switch_hook = nullptr;
+#  else
+static pthread_once_t gt_switch_hook_init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t gt_switch_hook_tls_key;
+static void init_pthread_switch_hook() { (void)pthread_key_create(&gt_switch_hook_tls_key, nullptr); }
+#  endif
+
+static inline void set_switch_hook(const coroutine_context_base::switch_hook_type *hook) {
+#  if (defined(LIBCOPP_LOCK_DISABLE_THIS_MT) && LIBCOPP_LOCK_DISABLE_THIS_MT) || defined(COPP_MACRO_THREAD_LOCAL)
+  gt_switch_hook = hook;
+#  else
+  (void)pthread_once(&gt_switch_hook_init_once, init_pthread_switch_hook);
+  pthread_setspecific(gt_switch_hook_tls_key, const_cast<coroutine_context_base::switch_hook_type *>(hook));
+#  endif
+}
+
+static inline const coroutine_context_base::switch_hook_type *get_switch_hook() {
+#  if (defined(LIBCOPP_LOCK_DISABLE_THIS_MT) && LIBCOPP_LOCK_DISABLE_THIS_MT) || defined(COPP_MACRO_THREAD_LOCAL)
+  return gt_switch_hook;
+#  else
+  (void)pthread_once(&gt_switch_hook_init_once, init_pthread_switch_hook);
+  return reinterpret_cast<const coroutine_context_base::switch_hook_type *>(
+      pthread_getspecific(gt_switch_hook_tls_key));
+#  endif
+}
+#endif
 }  // namespace detail
 
 LIBCOPP_COPP_API coroutine_context_base::coroutine_context_base() LIBCOPP_MACRO_NOEXCEPT
-    : runner_ret_code_(0),
+    : status_(status_type::EN_CRS_INVALID),
       flags_(0),
-      runner_(nullptr),
+      caller_(nullptr),
+      callee_(nullptr),
       priv_data_(nullptr),
       private_buffer_size_(0),
-      status_(status_type::EN_CRS_INVALID) {}
+      runner_ret_code_(0),
+      runner_(nullptr) {
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  accounting_ = accounting_type();
+#endif
+}
 
 LIBCOPP_COPP_API coroutine_context_base::~coroutine_context_base() {}
 
@@ -129,6 +166,20 @@ LIBCOPP_COPP_API void coroutine_context_base::set_this_coroutine_base(coroutine_
   detail::set_this_coroutine_context(ctx);
 }
 
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+LIBCOPP_COPP_API const coroutine_context_base::switch_hook_type *coroutine_context_base::set_switch_hook(
+    const switch_hook_type *hook) LIBCOPP_MACRO_NOEXCEPT {
+  const switch_hook_type *ret = detail::get_switch_hook();
+  detail::set_switch_hook(hook);
+  return ret;
+}
+
+LIBCOPP_COPP_API const coroutine_context_base::switch_hook_type *coroutine_context_base::get_switch_hook()
+    LIBCOPP_MACRO_NOEXCEPT {
+  return detail::get_switch_hook();
+}
+#endif
+
 struct libcopp_internal_api_set {
   using jump_src_data_t = coroutine_context::jump_src_data_t;
 
@@ -161,6 +212,9 @@ struct libcopp_internal_api_set {
   }
 #endif
 
+  static int start_from(coroutine_context &co, coroutine_context *from_co, void *priv_data,
+                        void **yield_data) LIBCOPP_MACRO_NOEXCEPT;
+
   static void coroutine_context_callback(LIBCOPP_COPP_NAMESPACE_ID::fcontext::transfer_t src_ctx) {
     assert(src_ctx.data);
     if (nullptr == src_ctx.data) {
@@ -268,9 +322,78 @@ static inline void jump_to(fcontext::fcontext_t &to_fctx, EXPLICIT_UNUSED_ATTR s
   detail::set_this_coroutine_context(jump_transfer.from_co);
 }
 
+int libcopp_internal_api_set::start_from(coroutine_context &co, coroutine_context *from_co, void *priv_data,
+                                         void **yield_data) LIBCOPP_MACRO_NOEXCEPT {
+  if (nullptr == co.callee_) {
+    return COPP_EC_NOT_INITED;
+  }
+
+  int from_status = coroutine_context::status_type::EN_CRS_READY;
+  do {
+    if (from_status < coroutine_context::status_type::EN_CRS_READY) {
+      return COPP_EC_NOT_INITED;
+    }
+
+    if (co.status_.compare_exchange_strong(from_status, coroutine_context::status_type::EN_CRS_RUNNING,
+                                           LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+                                           LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+      break;
+    } else {
+      // finished or stoped
+      if (from_status > coroutine_context::status_type::EN_CRS_RUNNING) {
+        return COPP_EC_NOT_READY;
+      }
+
+      // already running
+      if (coroutine_context::status_type::EN_CRS_RUNNING == from_status) {
+        return COPP_EC_IS_RUNNING;
+      }
+    }
+  } while (true);
+
+  jump_src_data_t jump_data;
+  jump_data.from_co = from_co;
+  jump_data.to_co = &co;
+  jump_data.priv_data = priv_data;
+
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  coroutine_context::invoke_switch_in_hook(detail::get_switch_hook(), from_co, &co);
+#endif
+
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  coroutine_context::accounting_before_resume(from_co, co);
+#endif
+
+#ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
+  jump_to(co.callee_, co.caller_stack_, co.callee_stack_, jump_data);
+#else
+  jump_to(co.callee_, co.callee_stack_, co.callee_stack_, jump_data);
+#endif
+
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  coroutine_context::accounting_after_resume(from_co, co);
+#endif
+
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  // the hook may be changed by the coroutine
+  coroutine_context::invoke_switch_out_hook(detail::get_switch_hook(), &co, from_co);
+#endif
+
+  if (nullptr != yield_data) {
+    *yield_data = jump_data.priv_data;
+  }
+
+  // Move changing status to EN_CRS_EXITED is finished
+  if (co.check_flags(coroutine_context::flag_type::EN_CFT_FINISHED)) {
+    // if in finished status, change it to exited
+    co.status_.store(coroutine_context::status_type::EN_CRS_EXITED,
+                     LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+  }
+
+  return COPP_EC_SUCCESS;
+}
+
 LIBCOPP_COPP_API coroutine_context::coroutine_context() LIBCOPP_MACRO_NOEXCEPT : coroutine_context_base(),
-                                                                                 caller_(nullptr),
-                                                                                 callee_(nullptr),
                                                                                  callee_stack_()
 #ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
     ,
@@ -346,62 +469,58 @@ LIBCOPP_COPP_API int coroutine_context::start(std::exception_ptr &unhandled, voi
 #else
 LIBCOPP_COPP_API int coroutine_context::start(void *priv_data) {
 #endif
-  if (nullptr == callee_) {
-    return COPP_EC_NOT_INITED;
-  }
-
+  coroutine_context_base *this_ctx = detail::get_this_coroutine_context();
 #if defined(LIBCOPP_MACRO_ENABLE_WIN_FIBER) && LIBCOPP_MACRO_ENABLE_WIN_FIBER
-  {
-    coroutine_context_base *this_ctx = detail::get_this_coroutine_context();
-    if (this_ctx && this_ctx->check_flags(flag_type::EN_CFT_IS_FIBER)) {
-      return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER;
-    }
+  if (this_ctx && this_ctx->check_flags(flag_type::EN_CFT_IS_FIBER)) {
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER;
   }
 #endif
 
-  int from_status = status_type::EN_CRS_READY;
-  do {
-    if (from_status < status_type::EN_CRS_READY) {
-      return COPP_EC_NOT_INITED;
-    }
+  int ret =
+      libcopp_internal_api_set::start_from(*this, static_cast<coroutine_context *>(this_ctx), priv_data, nullptr);
 
-    if (status_.compare_exchange_strong(from_status, status_type::EN_CRS_RUNNING,
-                                        LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
-                                        LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
-      break;
-    } else {
-      // finished or stoped
-      if (from_status > status_type::EN_CRS_RUNNING) {
-        return COPP_EC_NOT_READY;
-      }
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+  COPP_UNLIKELY_IF (unhandle_exception_) {
+    std::swap(unhandled, unhandle_exception_);
+  }
+#endif
 
-      // already running
-      if (status_type::EN_CRS_RUNNING == from_status) {
-        return COPP_EC_IS_RUNNING;
-      }
-    }
-  } while (true);
+  return ret;
+}
 
-  jump_src_data_t jump_data;
-#if defined(LIBCOPP_MACRO_ENABLE_WIN_FIBER) && LIBCOPP_MACRO_ENABLE_WIN_FIBER
-  jump_data.from_co = LIBCOPP_COPP_NAMESPACE_ID::this_coroutine::get_coroutine();
-#else
-  jump_data.from_co = static_cast<coroutine_context *>(detail::get_this_coroutine_context());
+LIBCOPP_COPP_API int coroutine_context::resume(void *priv_data) { return start(priv_data); }
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+LIBCOPP_COPP_API int coroutine_context::resume(std::exception_ptr &unhandled, void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
+  return start(unhandled, priv_data);
+}
 #endif
-  jump_data.to_co = this;
-  jump_data.priv_data = priv_data;
 
-#ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
-  jump_to(callee_, caller_stack_, callee_stack_, jump_data);
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+LIBCOPP_COPP_API int coroutine_context::resume_transfer(void *priv_data, void **yield_data) {
+  std::exception_ptr eptr;
+  int ret = resume_transfer(eptr, priv_data, yield_data);
+  maybe_rethrow(eptr);
+  return ret;
+}
+
+LIBCOPP_COPP_API int coroutine_context::resume_transfer(std::exception_ptr &unhandled, void *priv_data,
+                                                        void **yield_data) LIBCOPP_MACRO_NOEXCEPT {
 #else
-  jump_to(callee_, callee_stack_, callee_stack_, jump_data);
+LIBCOPP_COPP_API int coroutine_context::resume_transfer(void *priv_data, void **yield_data) {
 #endif
+  if (nullptr != yield_data) {
+    *yield_data = nullptr;
+  }
 
-  // Move changing status to EN_CRS_EXITED is finished
-  if (check_flags(flag_type::EN_CFT_FINISHED)) {
-    // if in finished status, change it to exited
-    status_.store(status_type::EN_CRS_EXITED, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+  coroutine_context_base *this_ctx = detail::get_this_coroutine_context();
+#if defined(LIBCOPP_MACRO_ENABLE_WIN_FIBER) && LIBCOPP_MACRO_ENABLE_WIN_FIBER
+  if (this_ctx && this_ctx->check_flags(flag_type::EN_CFT_IS_FIBER)) {
+    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER;
   }
+#endif
+
+  int ret =
+      libcopp_internal_api_set::start_from(*this, static_cast<coroutine_context *>(this_ctx), priv_data, yield_data);
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   COPP_UNLIKELY_IF (unhandle_exception_) {
@@ -409,17 +528,92 @@ LIBCOPP_COPP_API int coroutine_context::start(void *priv_data) {
   }
 #endif
 
-  return COPP_EC_SUCCESS;
+  return ret;
 }
 
-LIBCOPP_COPP_API int coroutine_context::resume(void *priv_data) { return start(priv_data); }
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-LIBCOPP_COPP_API int coroutine_context::resume(std::exception_ptr &unhandled, void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
-  return start(unhandled, priv_data);
+LIBCOPP_COPP_API size_t coroutine_context::resume_batch(gsl::span<coroutine_context *const> contexts,
+                                                        gsl::span<int> ret_codes, void *priv_data) {
+  std::exception_ptr eptr;
+  size_t ret = resume_batch(gsl::span<std::exception_ptr>(&eptr, 1), contexts, ret_codes, priv_data);
+  maybe_rethrow(eptr);
+  return ret;
 }
+
+LIBCOPP_COPP_API size_t coroutine_context::resume_batch(gsl::span<std::exception_ptr> unhandled,
+                                                        gsl::span<coroutine_context *const> contexts,
+                                                        gsl::span<int> ret_codes,
+                                                        void *priv_data) LIBCOPP_MACRO_NOEXCEPT {
+#else
+LIBCOPP_COPP_API size_t coroutine_context::resume_batch(gsl::span<coroutine_context *const> contexts,
+                                                        gsl::span<int> ret_codes, void *priv_data) {
+#endif
+  size_t count = contexts.size() < ret_codes.size() ? contexts.size() : ret_codes.size();
+  if (0 == count) {
+    return 0;
+  }
+
+  coroutine_context_base *this_ctx = detail::get_this_coroutine_context();
+#if defined(LIBCOPP_MACRO_ENABLE_WIN_FIBER) && LIBCOPP_MACRO_ENABLE_WIN_FIBER
+  if (this_ctx && this_ctx->check_flags(flag_type::EN_CFT_IS_FIBER)) {
+    for (size_t i = 0; i < count; ++i) {
+      ret_codes[i] = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_CAN_NOT_USE_CROSS_FCONTEXT_AND_FIBER;
+    }
+    return 0;
+  }
 #endif
+  coroutine_context *from_co = static_cast<coroutine_context *>(this_ctx);
+
+  size_t ret = 0;
+  if (nullptr != contexts[0]) {
+    COPP_MACRO_PREFETCH(contexts[0]->callee_);
+  }
+  if (count > 1 && nullptr != contexts[1]) {
+    COPP_MACRO_PREFETCH(contexts[1]);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    // The header of contexts[i + 1] is prefetched in the last round, prefetch the saved context on its stack and the
+    // header of contexts[i + 2] now.
+    if (i + 1 < count && nullptr != contexts[i + 1]) {
+      COPP_MACRO_PREFETCH(contexts[i + 1]->callee_);
+    }
+    if (i + 2 < count && nullptr != contexts[i + 2]) {
+      COPP_MACRO_PREFETCH(contexts[i + 2]);
+    }
+
+    coroutine_context *co = contexts[i];
+    COPP_UNLIKELY_IF (nullptr == co) {
+      ret_codes[i] = COPP_EC_ARGS_ERROR;
+      continue;
+    }
+
+    ret_codes[i] = libcopp_internal_api_set::start_from(*co, from_co, priv_data, nullptr);
+    if (COPP_EC_SUCCESS == ret_codes[i]) {
+      ++ret;
+    }
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+    COPP_UNLIKELY_IF (co->unhandle_exception_) {
+      if (i < unhandled.size()) {
+        std::swap(unhandled[i], co->unhandle_exception_);
+      } else if (1 == unhandled.size() && !unhandled[0]) {
+        std::swap(unhandled[0], co->unhandle_exception_);
+      } else {
+        co->unhandle_exception_ = std::exception_ptr();
+      }
+    }
+#endif
+  }
+
+  return ret;
+}
 
 LIBCOPP_COPP_API int coroutine_context::yield(void **priv_data) LIBCOPP_MACRO_NOEXCEPT {
+  return yield_transfer(nullptr, priv_data);
+}
+
+LIBCOPP_COPP_API int coroutine_context::yield_transfer(void *yield_data, void **priv_data) LIBCOPP_MACRO_NOEXCEPT {
   if (nullptr == callee_) {
     return COPP_EC_NOT_INITED;
   }
@@ -449,6 +643,7 @@ LIBCOPP_COPP_API int coroutine_context::yield(void **priv_data) LIBCOPP_MACRO_NO
   jump_src_data_t jump_data;
   jump_data.from_co = this;
   jump_data.to_co = nullptr;
+  jump_data.priv_data = yield_data;
 
 #ifdef LIBCOPP_MACRO_USE_SEGMENTED_STACKS
   jump_to(caller_, callee_stack_, caller_stack_, jump_data);
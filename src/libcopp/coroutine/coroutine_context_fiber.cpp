@@ -175,8 +175,6 @@ static inline void jump_to(LPVOID to_fiber,
 }
 
 LIBCOPP_COPP_API coroutine_context_fiber::coroutine_context_fiber() LIBCOPP_MACRO_NOEXCEPT : coroutine_context_base(),
-                                                                                             caller_(nullptr),
-                                                                                             callee_(nullptr),
                                                                                              callee_stack_() {
   flags_ |= flag_type::EN_CFT_IS_FIBER;
   // set_flags(flag_type::EN_CFT_IS_FIBER); // can not use set_flags to set a coroutine context's flag here
@@ -290,7 +288,19 @@ LIBCOPP_COPP_API int coroutine_context_fiber::start(void *priv_data) {
 
   libcopp_fiber_internal_api_set::jump_src_data_t jump_src =
       libcopp_fiber_internal_api_set::build_this_fiber_jump_src(*this, priv_data);
+#  if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  invoke_switch_in_hook(get_switch_hook(), this_ctx, this);
+#  endif
+#  if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  accounting_before_resume(this_ctx, *this);
+#  endif
   jump_to(callee_, jump_src);
+#  if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+  accounting_after_resume(this_ctx, *this);
+#  endif
+#  if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+  invoke_switch_out_hook(get_switch_hook(), this, this_ctx);
+#  endif
 
   // Move changing status to EN_CRS_EXITED is finished
   if (check_flags(flag_type::EN_CFT_FINISHED)) {
@@ -0,0 +1,233 @@
+// Copyright 2023 owent
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/atomic_int_type.h>
+#include <libcopp/utils/lock_holder.h>
+#include <libcopp/utils/spin_lock.h>
+#include <libcopp/utils/uint64_slot_id_allocator.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#if defined(THREAD_TLS_USE_PTHREAD) && THREAD_TLS_USE_PTHREAD
+#  include <pthread.h>
+#endif
+#include <vector>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COPP_NAMESPACE_BEGIN
+namespace util {
+namespace details {
+
+// generations are stored by chunks which are never moved or released, so they can be accessed without lock
+static constexpr const size_t uint64_slot_id_chunk_bits = 16;
+static constexpr const size_t uint64_slot_id_chunk_size = static_cast<size_t>(1) << uint64_slot_id_chunk_bits;
+static constexpr const size_t uint64_slot_id_max_chunk_number =
+    (static_cast<size_t>(1) << uint64_slot_id_allocator::index_bits) >> uint64_slot_id_chunk_bits;
+
+// free indexes cached by every thread, half of them are moved to the shared pool when it's full
+static constexpr const size_t uint64_slot_id_tls_cache_size = 64;
+
+using uint64_slot_id_generation_t = LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<uint32_t>;
+
+struct uint64_slot_id_allocator_pool_t {
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock lock;
+  // count of indexes ever allocated, it's increased after the generation chunk is ready
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::atomic_int_type<size_t> capacity;
+  std::vector<uint32_t> free_indexes;
+  // only chunks of allocated indexes are initialized, the others are never accessed
+  uint64_slot_id_generation_t *generation_chunks[uint64_slot_id_max_chunk_number];
+
+  uint64_slot_id_allocator_pool_t() : capacity(0) {}
+
+  inline uint64_slot_id_generation_t &get_generation(uint32_t index) LIBCOPP_MACRO_NOEXCEPT {
+    return generation_chunks[index >> uint64_slot_id_chunk_bits][index & (uint64_slot_id_chunk_size - 1)];
+  }
+};
+
+static uint64_slot_id_allocator_pool_t *get_uint64_slot_id_allocator_pool() {
+  // never destroyed, tasks may be destroyed after static variables
+  static uint64_slot_id_allocator_pool_t *ret = new uint64_slot_id_allocator_pool_t();
+  return ret;
+}
+
+struct uint64_slot_id_allocator_tls_cache_t {
+  size_t count;
+  uint32_t indexes[uint64_slot_id_tls_cache_size];
+
+  uint64_slot_id_allocator_tls_cache_t() : count(0) {}
+
+  // give back all cached indexes when thread exits
+  ~uint64_slot_id_allocator_tls_cache_t() { flush(count); }
+
+  // move the oldest n indexes to the shared pool, the most recently released ones are kept
+  void flush(size_t n) LIBCOPP_MACRO_NOEXCEPT {
+    if (0 == n) {
+      return;
+    }
+
+    uint64_slot_id_allocator_pool_t *pool = get_uint64_slot_id_allocator_pool();
+    {
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+          pool->lock};
+      pool->free_indexes.insert(pool->free_indexes.end(), indexes, indexes + n);
+    }
+
+    for (size_t i = n; i < count; ++i) {
+      indexes[i - n] = indexes[i];
+    }
+    count -= n;
+  }
+};
+
+#if defined(THREAD_TLS_USE_PTHREAD) && THREAD_TLS_USE_PTHREAD
+static pthread_once_t gt_uint64_slot_id_allocator_tls_once = PTHREAD_ONCE_INIT;
+static pthread_key_t gt_uint64_slot_id_allocator_tls_key;
+
+static void dtor_pthread_uint64_slot_id_allocator_tls(void *p) {
+  uint64_slot_id_allocator_tls_cache_t *cache = reinterpret_cast<uint64_slot_id_allocator_tls_cache_t *>(p);
+  if (nullptr != cache) {
+    delete cache;
+  }
+}
+
+static void init_pthread_uint64_slot_id_allocator_tls() {
+  (void)pthread_key_create(&gt_uint64_slot_id_allocator_tls_key, dtor_pthread_uint64_slot_id_allocator_tls);
+}
+
+struct gt_uint64_slot_id_allocator_tls_cache_main_thread_dtor_t {
+  gt_uint64_slot_id_allocator_tls_cache_main_thread_dtor_t() {}
+
+  ~gt_uint64_slot_id_allocator_tls_cache_main_thread_dtor_t() {
+    void *cache_ptr = pthread_getspecific(gt_uint64_slot_id_allocator_tls_key);
+    pthread_setspecific(gt_uint64_slot_id_allocator_tls_key, nullptr);
+    dtor_pthread_uint64_slot_id_allocator_tls(cache_ptr);
+  }
+};
+static void init_pthread_uint64_slot_id_allocator_tls_main_thread_dtor() {
+  static gt_uint64_slot_id_allocator_tls_cache_main_thread_dtor_t main_thread_dtor;
+  (void)main_thread_dtor;
+}
+
+static uint64_slot_id_allocator_tls_cache_t *get_uint64_slot_id_allocator_tls_cache() {
+  init_pthread_uint64_slot_id_allocator_tls_main_thread_dtor();
+  (void)pthread_once(&gt_uint64_slot_id_allocator_tls_once, init_pthread_uint64_slot_id_allocator_tls);
+  uint64_slot_id_allocator_tls_cache_t *ret = reinterpret_cast<uint64_slot_id_allocator_tls_cache_t *>(
+      pthread_getspecific(gt_uint64_slot_id_allocator_tls_key));
+  if (nullptr == ret) {
+    ret = new uint64_slot_id_allocator_tls_cache_t();
+    pthread_setspecific(gt_uint64_slot_id_allocator_tls_key, ret);
+  }
+  return ret;
+}
+
+#else
+static uint64_slot_id_allocator_tls_cache_t *get_uint64_slot_id_allocator_tls_cache() {
+  static thread_local uint64_slot_id_allocator_tls_cache_t ret;
+  return &ret;
+}
+#endif
+
+// refill the cache of current thread from the shared pool, or allocate a new index
+static uint32_t allocate_uint64_slot_index(uint64_slot_id_allocator_tls_cache_t *cache) LIBCOPP_MACRO_NOEXCEPT {
+  uint64_slot_id_allocator_pool_t *pool = get_uint64_slot_id_allocator_pool();
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+      pool->lock};
+
+  if (!pool->free_indexes.empty()) {
+    // reuse the last released index, it's more likely to be in cache
+    uint32_t ret = pool->free_indexes.back();
+    pool->free_indexes.pop_back();
+
+    // take a batch, so the next allocations of this thread do not need the lock
+    while (nullptr != cache && cache->count < uint64_slot_id_tls_cache_size / 2 && !pool->free_indexes.empty()) {
+      cache->indexes[cache->count++] = pool->free_indexes.back();
+      pool->free_indexes.pop_back();
+    }
+    return ret;
+  }
+
+  size_t capacity = pool->capacity.load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_relaxed);
+  if (capacity >= static_cast<size_t>(static_cast<uint32_t>(-1))) {
+    return static_cast<uint32_t>(-1);
+  }
+
+  uint32_t ret = static_cast<uint32_t>(capacity);
+  if (0 == (capacity & (uint64_slot_id_chunk_size - 1))) {
+    pool->generation_chunks[capacity >> uint64_slot_id_chunk_bits] =
+        new uint64_slot_id_generation_t[uint64_slot_id_chunk_size]();
+  }
+  pool->get_generation(ret).store(1, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_relaxed);
+  pool->capacity.store(capacity + 1, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_release);
+  return ret;
+}
+
+}  // namespace details
+
+LIBCOPP_COPP_API uint64_slot_id_allocator::value_type uint64_slot_id_allocator::allocate() LIBCOPP_MACRO_NOEXCEPT {
+  details::uint64_slot_id_allocator_pool_t *pool = details::get_uint64_slot_id_allocator_pool();
+  details::uint64_slot_id_allocator_tls_cache_t *cache = details::get_uint64_slot_id_allocator_tls_cache();
+
+  uint32_t index;
+  if (nullptr != cache && cache->count > 0) {
+    // reuse the last released index of this thread without lock
+    index = cache->indexes[--cache->count];
+  } else {
+    index = details::allocate_uint64_slot_index(cache);
+    if (static_cast<uint32_t>(-1) == index) {
+      return npos;
+    }
+  }
+
+  uint32_t generation = pool->get_generation(index).load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire);
+  return (static_cast<value_type>(generation) << index_bits) | index;
+}
+
+LIBCOPP_COPP_API void uint64_slot_id_allocator::deallocate(value_type id) LIBCOPP_MACRO_NOEXCEPT {
+  if (npos == id) {
+    return;
+  }
+
+  details::uint64_slot_id_allocator_pool_t *pool = details::get_uint64_slot_id_allocator_pool();
+  uint32_t index = get_index(id);
+  if (index >= pool->capacity.load(LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+    return;
+  }
+
+  // generation 0 is never used, so id will never be npos
+  uint32_t generation = get_generation(id);
+  uint32_t next_generation = generation + 1;
+  if (0 == next_generation) {
+    next_generation = 1;
+  }
+
+  // only one of expired ids or repeated deallocations wins
+  if (!pool->get_generation(index).compare_exchange_strong(
+          generation, next_generation, LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acq_rel,
+          LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire)) {
+    return;
+  }
+
+  details::uint64_slot_id_allocator_tls_cache_t *cache = details::get_uint64_slot_id_allocator_tls_cache();
+  if (nullptr == cache) {
+    LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard{
+        pool->lock};
+    pool->free_indexes.push_back(index);
+    return;
+  }
+
+  if (cache->count >= details::uint64_slot_id_tls_cache_size) {
+    cache->flush(details::uint64_slot_id_tls_cache_size / 2);
+  }
+  cache->indexes[cache->count++] = index;
+}
+
+LIBCOPP_COPP_API size_t uint64_slot_id_allocator::get_capacity() LIBCOPP_MACRO_NOEXCEPT {
+  return details::get_uint64_slot_id_allocator_pool()->capacity.load(
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::memory_order_acquire);
+}
+}  // namespace util
+LIBCOPP_COPP_NAMESPACE_END
@@ -7,6 +7,7 @@
 
 #include <libcotask/impl/task_action_impl.h>
 #include <libcotask/impl/task_impl.h>
+#include <libcotask/task_arena.h>
 
 // clang-format off
 #include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
@@ -21,7 +22,7 @@
 LIBCOPP_COTASK_NAMESPACE_BEGIN
 namespace impl {
 LIBCOPP_COTASK_API task_impl::task_impl()
-    : action_(nullptr), id_(0), finish_priv_data_(nullptr), status_(EN_TS_CREATED) {
+    : action_(nullptr), id_(0), arena_(nullptr), finish_priv_data_(nullptr), status_(EN_TS_CREATED) {
   id_allocator_t id_alloc_;
   ((void)id_alloc_);
   id_ = id_alloc_.allocate();
@@ -31,6 +32,9 @@ LIBCOPP_COTASK_API task_impl::~task_impl() {
   assert(status_ <= EN_TS_CREATED || status_ >= EN_TS_DONE);
 
   // free resource
+  task_arena::destroy(arena_);
+  arena_ = nullptr;
+
   id_allocator_t id_alloc_;
   ((void)id_alloc_);
   id_alloc_.deallocate(id_);
@@ -62,6 +66,20 @@ LIBCOPP_COTASK_API task_impl *task_impl::this_task() {
   return *reinterpret_cast<task_impl **>(this_co->get_private_buffer());
 }
 
+LIBCOPP_COTASK_API task_arena *task_impl::get_arena() LIBCOPP_MACRO_NOEXCEPT {
+  if (nullptr == arena_) {
+    arena_ = task_arena::create();
+  }
+
+  return arena_;
+}
+
+LIBCOPP_COTASK_API task_arena *task_impl::_detach_arena() LIBCOPP_MACRO_NOEXCEPT {
+  task_arena *ret = arena_;
+  arena_ = nullptr;
+  return ret;
+}
+
 LIBCOPP_COTASK_API void task_impl::_set_action(action_ptr_type action) { action_ = action; }
 
 LIBCOPP_COTASK_API task_impl::action_ptr_type task_impl::_get_action() { return action_; }
@@ -76,26 +94,41 @@ LIBCOPP_COTASK_API bool task_impl::_cas_status(EN_TASK_STATUS &expected, EN_TASK
 }
 
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-LIBCOPP_COTASK_API int task_impl::_notify_finished(std::list<std::exception_ptr> &unhandled, void *priv_data) {
+LIBCOPP_COTASK_API int task_impl::_notify_finished(unhandled_exception_list &unhandled, void *priv_data) {
 #else
 LIBCOPP_COTASK_API int task_impl::_notify_finished(void *priv_data) {
 #endif
   finish_priv_data_ = priv_data;
 
+  int ret;
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
   try {
 #endif
     _get_action()->on_finished(*this);
-    int ret = on_finished();
+    ret = on_finished();
 #if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
-    return ret;
   } catch (...) {
     unhandled.emplace_back(std::current_exception());
-    return LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_HAS_UNHANDLE_EXCEPTION;
+    ret = LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_HAS_UNHANDLE_EXCEPTION;
   }
-#else
-  return ret;
 #endif
+
+  // all blocks allocated by this task are released at once, the arena itself is kept until the task is destroyed,
+  // because the action and the private data may still deallocate from it in their destructors
+  if (nullptr != arena_) {
+    arena_->release();
+  }
+
+  return ret;
+}
+
+#if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+LIBCOPP_COTASK_API int task_impl::_notify_finished(std::list<std::exception_ptr> &unhandled, void *priv_data) {
+  unhandled_exception_list eptrs;
+  int ret = _notify_finished(eptrs, priv_data);
+  eptrs.move_to(unhandled);
+  return ret;
 }
+#endif
 }  // namespace impl
 LIBCOPP_COTASK_NAMESPACE_END
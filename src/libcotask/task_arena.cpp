@@ -0,0 +1,202 @@
+// Copyright 2023 owent
+
+#include <libcopp/utils/config/libcopp_build_features.h>
+
+#include <libcopp/utils/lock_holder.h>
+#include <libcopp/utils/spin_lock.h>
+
+#include <libcotask/task_arena.h>
+
+// clang-format off
+#include <libcopp/utils/config/stl_include_prefix.h>  // NOLINT(build/include_order)
+// clang-format on
+#include <stdint.h>
+#include <cstdlib>
+#include <new>
+// clang-format off
+#include <libcopp/utils/config/stl_include_suffix.h>  // NOLINT(build/include_order)
+// clang-format on
+
+LIBCOPP_COTASK_NAMESPACE_BEGIN
+namespace {
+// recycle blocks of task_arena::BLOCK_SIZE
+struct task_arena_block_pool {
+  enum { MAX_FREE_NUMBER = 256 };
+
+  struct free_node {
+    free_node *next;
+  };
+
+  free_node *free_head;
+  size_t free_number;
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+  LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock lock;
+#endif
+
+  task_arena_block_pool() : free_head(nullptr), free_number(0) {}
+
+  static task_arena_block_pool &instance() {
+    // never destroyed, tasks may be released after static variables are destroyed
+    static task_arena_block_pool *ret = new task_arena_block_pool();
+    return *ret;
+  }
+
+  void *allocate() LIBCOPP_MACRO_NOEXCEPT {
+    {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+          lock);
+#endif
+      if (nullptr != free_head) {
+        free_node *ret = free_head;
+        free_head = ret->next;
+        --free_number;
+        return ret;
+      }
+    }
+
+    return malloc(task_arena::BLOCK_SIZE);
+  }
+
+  void deallocate(void *block) LIBCOPP_MACRO_NOEXCEPT {
+    {
+#if !defined(LIBCOPP_DISABLE_ATOMIC_LOCK) || !(LIBCOPP_DISABLE_ATOMIC_LOCK)
+      LIBCOPP_COPP_NAMESPACE_ID::util::lock::lock_holder<LIBCOPP_COPP_NAMESPACE_ID::util::lock::spin_lock> lock_guard(
+          lock);
+#endif
+      if (free_number < MAX_FREE_NUMBER) {
+        free_node *node = reinterpret_cast<free_node *>(block);
+        node->next = free_head;
+        free_head = node;
+        ++free_number;
+        return;
+      }
+    }
+
+    free(block);
+  }
+};
+
+static inline unsigned char *task_arena_align(unsigned char *p, size_t alignment) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<unsigned char *>((addr + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+}  // namespace
+
+#if !((defined(__cplusplus) && __cplusplus >= 201703L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+constexpr const size_t task_arena::BLOCK_SIZE;
+#endif
+
+LIBCOPP_COTASK_API task_arena::task_arena(unsigned char *begin, unsigned char *end) LIBCOPP_MACRO_NOEXCEPT
+    : blocks_(nullptr),
+      first_begin_(begin),
+      cursor_(begin),
+      end_(end),
+      allocated_size_(0),
+      block_count_(1) {}
+
+LIBCOPP_COTASK_API task_arena::~task_arena() { release(); }
+
+LIBCOPP_COTASK_API task_arena *task_arena::create() LIBCOPP_MACRO_NOEXCEPT {
+  unsigned char *block = reinterpret_cast<unsigned char *>(task_arena_block_pool::instance().allocate());
+  if (nullptr == block) {
+    return nullptr;
+  }
+
+  unsigned char *begin = task_arena_align(block + sizeof(task_arena), alignof(std::max_align_t));
+  return new (block) task_arena(begin, block + BLOCK_SIZE);
+}
+
+LIBCOPP_COTASK_API void task_arena::destroy(task_arena *arena) LIBCOPP_MACRO_NOEXCEPT {
+  if (nullptr == arena) {
+    return;
+  }
+
+  arena->~task_arena();
+  task_arena_block_pool::instance().deallocate(arena);
+}
+
+LIBCOPP_COTASK_API void *task_arena::allocate(size_t bytes, size_t alignment) LIBCOPP_MACRO_NOEXCEPT {
+  if (0 == alignment || 0 != (alignment & (alignment - 1))) {
+    return nullptr;
+  }
+
+  if (0 == bytes) {
+    bytes = 1;
+  }
+
+  unsigned char *ret = task_arena_align(cursor_, alignment);
+  if (ret <= end_ && static_cast<size_t>(end_ - ret) >= bytes) {
+    cursor_ = ret + bytes;
+    allocated_size_ += bytes;
+    return ret;
+  }
+
+  size_t header_size = sizeof(block_header);
+  size_t need_size = header_size + bytes + alignment;
+  bool use_pool = need_size <= BLOCK_SIZE;
+  block_header *block;
+  if (use_pool) {
+    block = reinterpret_cast<block_header *>(task_arena_block_pool::instance().allocate());
+  } else {
+    block = reinterpret_cast<block_header *>(malloc(need_size));
+  }
+  if (nullptr == block) {
+    return nullptr;
+  }
+
+  block->size = use_pool ? BLOCK_SIZE : need_size;
+  block->next = blocks_;
+  blocks_ = block;
+  ++block_count_;
+
+  unsigned char *begin = reinterpret_cast<unsigned char *>(block) + header_size;
+  ret = task_arena_align(begin, alignment);
+  allocated_size_ += bytes;
+
+  // dedicated block is used only once, keep the space left in current block
+  if (use_pool) {
+    cursor_ = ret + bytes;
+    end_ = reinterpret_cast<unsigned char *>(block) + BLOCK_SIZE;
+  }
+  return ret;
+}
+
+LIBCOPP_COTASK_API void task_arena::deallocate(void *p, size_t bytes) LIBCOPP_MACRO_NOEXCEPT {
+  if (nullptr == p) {
+    return;
+  }
+
+  if (0 == bytes) {
+    bytes = 1;
+  }
+
+  if (allocated_size_ >= bytes) {
+    allocated_size_ -= bytes;
+  } else {
+    allocated_size_ = 0;
+  }
+
+  // roll back the last allocation
+  if (reinterpret_cast<unsigned char *>(p) + bytes == cursor_) {
+    cursor_ = reinterpret_cast<unsigned char *>(p);
+  }
+}
+
+LIBCOPP_COTASK_API void task_arena::release() LIBCOPP_MACRO_NOEXCEPT {
+  while (nullptr != blocks_) {
+    block_header *block = blocks_;
+    blocks_ = block->next;
+    if (BLOCK_SIZE == block->size) {
+      task_arena_block_pool::instance().deallocate(block);
+    } else {
+      free(block);
+    }
+  }
+
+  cursor_ = first_begin_;
+  end_ = reinterpret_cast<unsigned char *>(this) + BLOCK_SIZE;
+  allocated_size_ = 0;
+  block_count_ = 1;
+}
+LIBCOPP_COTASK_NAMESPACE_END
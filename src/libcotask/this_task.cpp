@@ -2,10 +2,43 @@
 
 #include <libcopp/utils/config/libcopp_build_features.h>
 
+#include <libcopp/coroutine/coroutine_context_base.h>
+
 #include <libcotask/this_task.h>
 
 LIBCOPP_COTASK_NAMESPACE_BEGIN
 namespace this_task {
 LIBCOPP_COTASK_API impl::task_impl *get_task() LIBCOPP_MACRO_NOEXCEPT { return impl::task_impl::this_task(); }
+
+LIBCOPP_COTASK_API task_arena *get_arena() LIBCOPP_MACRO_NOEXCEPT {
+  impl::task_impl *task = impl::task_impl::this_task();
+  if (nullptr == task) {
+    return nullptr;
+  }
+
+  return task->get_arena();
+}
+
+LIBCOPP_COTASK_API void *get_private_buffer(size_t *buffer_size) LIBCOPP_MACRO_NOEXCEPT {
+  if (nullptr != buffer_size) {
+    *buffer_size = 0;
+  }
+
+  // the first pointer of private buffer is the task, it's also skipped by task::get_private_buffer()
+  LIBCOPP_COPP_NAMESPACE_ID::coroutine_context_base *this_co =
+      LIBCOPP_COPP_NAMESPACE_ID::coroutine_context_base::get_this_coroutine_base();
+  if (nullptr == this_co || nullptr == impl::task_impl::this_task()) {
+    return nullptr;
+  }
+
+  if (this_co->get_private_buffer_size() < sizeof(impl::task_impl *)) {
+    return nullptr;
+  }
+
+  if (nullptr != buffer_size) {
+    *buffer_size = this_co->get_private_buffer_size() - sizeof(impl::task_impl *);
+  }
+  return reinterpret_cast<unsigned char *>(this_co->get_private_buffer()) + sizeof(impl::task_impl *);
+}
 }  // namespace this_task
 LIBCOPP_COTASK_NAMESPACE_END
@@ -5,6 +5,8 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "frame/test_macros.h"
 
@@ -132,6 +134,212 @@ CASE_TEST(coroutine, shared_runner) {
   delete[] stack_buff;
 }
 
+CASE_TEST(coroutine, resume_batch) {
+  const int stack_len = 128 * 1024;
+  unsigned char *stack_buff = new unsigned char[4 * stack_len];
+  g_test_coroutine_base_status = 0;
+
+  test_context_base_foo_runner runner;
+  runner.call_times = 0;
+
+  {
+    test_context_base_coroutine_context_test_type::ptr_t co[4];
+    copp::coroutine_context *batch[5];
+    int ret_codes[5] = {0};
+    for (int i = 0; i < 4; ++i) {
+      copp::allocator::stack_allocator_memory alloc(stack_buff + i * stack_len, stack_len);
+      co[i] = test_context_base_coroutine_context_test_type::create(&runner, alloc);
+      batch[i] = co[i].get();
+    }
+    batch[4] = nullptr;
+
+    CASE_EXPECT_EQ(static_cast<size_t>(4), copp::coroutine_context::resume_batch(batch, ret_codes));
+    CASE_EXPECT_EQ(g_test_coroutine_base_status, 4);
+    CASE_EXPECT_EQ(runner.call_times, 4);
+    for (int i = 0; i < 4; ++i) {
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, ret_codes[i]);
+      CASE_EXPECT_FALSE(co[i]->is_finished());
+    }
+    CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, ret_codes[4]);
+
+    // only resume the first 2 coroutines
+    CASE_EXPECT_EQ(static_cast<size_t>(2),
+                   copp::coroutine_context::resume_batch(batch, copp::gsl::span<int>(ret_codes, 2)));
+    CASE_EXPECT_EQ(g_test_coroutine_base_status, 6);
+    CASE_EXPECT_TRUE(co[0]->is_finished());
+    CASE_EXPECT_TRUE(co[1]->is_finished());
+    CASE_EXPECT_FALSE(co[2]->is_finished());
+
+    CASE_EXPECT_EQ(static_cast<size_t>(2), copp::coroutine_context::resume_batch(batch, ret_codes));
+    CASE_EXPECT_EQ(g_test_coroutine_base_status, 8);
+    CASE_EXPECT_EQ(copp::COPP_EC_NOT_READY, ret_codes[0]);
+    CASE_EXPECT_EQ(copp::COPP_EC_NOT_READY, ret_codes[1]);
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, ret_codes[2]);
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, ret_codes[3]);
+    for (int i = 0; i < 4; ++i) {
+      CASE_EXPECT_TRUE(co[i]->is_finished());
+    }
+  }
+
+  delete[] stack_buff;
+}
+
+CASE_TEST(coroutine, cache_line_aligned) {
+  const int stack_len = 128 * 1024;
+  unsigned char *stack_buff = new unsigned char[stack_len + 64];
+  g_test_coroutine_base_status = 0;
+
+  test_context_base_foo_runner runner;
+  runner.call_times = 0;
+
+  // the top of stack may be not aligned to cache line
+  for (size_t offset = 0; offset < 64; offset += 16) {
+    copp::allocator::stack_allocator_memory alloc(stack_buff + offset, stack_len);
+    test_context_base_coroutine_context_test_type::ptr_t co =
+        test_context_base_coroutine_context_test_type::create(&runner, alloc, 0, 24);
+    CASE_EXPECT_TRUE(!!co);
+    if (!co) {
+      continue;
+    }
+
+    CASE_EXPECT_EQ(0, static_cast<int>(reinterpret_cast<uintptr_t>(co.get()) % COROUTINE_CONTEXT_CACHE_LINE_SIZE));
+    // private buffer is still after the object
+    CASE_EXPECT_TRUE(reinterpret_cast<unsigned char *>(co->get_private_buffer()) >=
+                     reinterpret_cast<unsigned char *>(co.get()) + sizeof(test_context_base_coroutine_context_test_type));
+
+    CASE_EXPECT_EQ(0, co->start());
+    CASE_EXPECT_EQ(0, co->resume());
+    CASE_EXPECT_TRUE(co->is_finished());
+  }
+  CASE_EXPECT_EQ(runner.call_times, 4);
+  CASE_EXPECT_EQ(g_test_coroutine_base_status, 8);
+
+  delete[] stack_buff;
+}
+
+#if defined(LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING) && LIBCOPP_MACRO_ENABLE_COROUTINE_ACCOUNTING
+namespace {
+struct test_context_base_accounting_runner {
+  copp::coroutine_context *nested;
+
+  int operator()(void *) {
+    copp::coroutine_context *self = copp::this_coroutine::get_coroutine();
+    for (int i = 0; i < 3; ++i) {
+      if (nullptr != nested) {
+        nested->resume();
+      }
+      self->yield();
+    }
+    return 0;
+  }
+};
+}  // namespace
+
+CASE_TEST(coroutine, accounting) {
+  test_context_base_accounting_runner inner_runner;
+  inner_runner.nested = nullptr;
+  copp::coroutine_context_default::ptr_t inner =
+      copp::coroutine_context_default::create(&inner_runner, 64 * 1024);
+
+  test_context_base_accounting_runner outer_runner;
+  outer_runner.nested = inner.get();
+  copp::coroutine_context_default::ptr_t outer =
+      copp::coroutine_context_default::create(&outer_runner, 64 * 1024);
+
+  CASE_EXPECT_EQ(static_cast<uint64_t>(0), outer->get_accounting().switch_in_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(0), outer->get_accounting().run_ticks);
+
+  while (!outer->is_finished()) {
+    outer->resume();
+  }
+
+  // outer: 4 resumes from caller and 3 returns from inner coroutine
+  CASE_EXPECT_EQ(static_cast<uint64_t>(7), outer->get_accounting().switch_in_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(7), outer->get_accounting().switch_out_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(3), inner->get_accounting().switch_in_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(3), inner->get_accounting().switch_out_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(0), outer->get_accounting().last_switch_in);
+  CASE_EXPECT_TRUE(outer->get_accounting().longest_run_ticks <= outer->get_accounting().run_ticks);
+  CASE_EXPECT_TRUE(inner->get_accounting().longest_run_ticks <= inner->get_accounting().run_ticks);
+
+  outer->reset_accounting();
+  CASE_EXPECT_EQ(static_cast<uint64_t>(0), outer->get_accounting().switch_in_count);
+  CASE_EXPECT_EQ(static_cast<uint64_t>(0), outer->get_accounting().run_ticks);
+}
+#endif
+
+#if defined(LIBCOPP_MACRO_ENABLE_SWITCH_HOOK) && LIBCOPP_MACRO_ENABLE_SWITCH_HOOK
+namespace {
+struct test_context_base_switch_hook_record {
+  std::vector<std::pair<copp::coroutine_context_base *, copp::coroutine_context_base *> > switch_in;
+  std::vector<std::pair<copp::coroutine_context_base *, copp::coroutine_context_base *> > switch_out;
+};
+
+static void test_context_base_on_switch_in(copp::coroutine_context_base *from, copp::coroutine_context_base *to,
+                                           void *user_data) {
+  reinterpret_cast<test_context_base_switch_hook_record *>(user_data)->switch_in.push_back(std::make_pair(from, to));
+}
+
+static void test_context_base_on_switch_out(copp::coroutine_context_base *from, copp::coroutine_context_base *to,
+                                            void *user_data) {
+  reinterpret_cast<test_context_base_switch_hook_record *>(user_data)->switch_out.push_back(
+      std::make_pair(from, to));
+}
+
+static copp::coroutine_context *g_test_context_base_switch_hook_nested = nullptr;
+static int test_context_base_switch_hook_runner(void *) {
+  if (nullptr != g_test_context_base_switch_hook_nested) {
+    g_test_context_base_switch_hook_nested->start();
+  }
+  copp::this_coroutine::yield();
+  return 0;
+}
+}  // namespace
+
+CASE_TEST(coroutine, switch_hook) {
+  test_context_base_switch_hook_record record;
+  copp::coroutine_context_base::switch_hook_type hook;
+  hook.on_switch_in = test_context_base_on_switch_in;
+  hook.on_switch_out = test_context_base_on_switch_out;
+  hook.user_data = &record;
+
+  g_test_context_base_switch_hook_nested = nullptr;
+  copp::coroutine_context_default::ptr_t inner =
+      copp::coroutine_context_default::create(test_context_base_switch_hook_runner, 64 * 1024);
+  g_test_context_base_switch_hook_nested = inner.get();
+  copp::coroutine_context_default::ptr_t outer =
+      copp::coroutine_context_default::create(test_context_base_switch_hook_runner, 64 * 1024);
+
+  CASE_EXPECT_EQ(nullptr, copp::coroutine_context_base::set_switch_hook(&hook));
+  CASE_EXPECT_EQ(&hook, copp::coroutine_context_base::get_switch_hook());
+
+  outer->start();
+  CASE_EXPECT_EQ(static_cast<size_t>(2), record.switch_in.size());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), record.switch_out.size());
+  if (2 == record.switch_in.size() && 2 == record.switch_out.size()) {
+    CASE_EXPECT_TRUE(nullptr == record.switch_in[0].first);
+    CASE_EXPECT_TRUE(outer.get() == record.switch_in[0].second);
+    CASE_EXPECT_TRUE(outer.get() == record.switch_in[1].first);
+    CASE_EXPECT_TRUE(inner.get() == record.switch_in[1].second);
+
+    CASE_EXPECT_TRUE(inner.get() == record.switch_out[0].first);
+    CASE_EXPECT_TRUE(outer.get() == record.switch_out[0].second);
+    CASE_EXPECT_TRUE(outer.get() == record.switch_out[1].first);
+    CASE_EXPECT_TRUE(nullptr == record.switch_out[1].second);
+  }
+
+  // remove hooks
+  CASE_EXPECT_EQ(&hook, copp::coroutine_context_base::set_switch_hook(nullptr));
+  outer->resume();
+  inner->resume();
+  CASE_EXPECT_TRUE(outer->is_finished());
+  CASE_EXPECT_TRUE(inner->is_finished());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), record.switch_in.size());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), record.switch_out.size());
+  g_test_context_base_switch_hook_nested = nullptr;
+}
+#endif
+
 CASE_TEST(coroutine, coroutine_context_container_create_failed) {
   unsigned char *stack_buff = new unsigned char[128 * 1024];
 
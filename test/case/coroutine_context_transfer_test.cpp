@@ -0,0 +1,151 @@
+// Copyright 2023 owent
+
+#include <libcopp/coroutine/coroutine_context_container.h>
+#include <libcopp/coroutine/stackful_generator.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+namespace {
+struct test_context_transfer_move_only {
+  explicit test_context_transfer_move_only(int v) : value(v) {}
+  test_context_transfer_move_only(test_context_transfer_move_only &&other) : value(other.value) { other.value = 0; }
+  test_context_transfer_move_only &operator=(test_context_transfer_move_only &&other) {
+    value = other.value;
+    other.value = 0;
+    return *this;
+  }
+
+  test_context_transfer_move_only(const test_context_transfer_move_only &) = delete;
+  test_context_transfer_move_only &operator=(const test_context_transfer_move_only &) = delete;
+
+  int value;
+};
+
+static int test_context_transfer_echo_runner(void *priv_data) {
+  // the first value is passed by start
+  test_context_transfer_move_only *recv = static_cast<test_context_transfer_move_only *>(priv_data);
+  int sum = 0;
+  while (nullptr != recv) {
+    // take the value from caller without copying
+    test_context_transfer_move_only keep = std::move(*recv);
+    sum += keep.value;
+
+    std::string reply = std::to_string(sum);
+    copp::this_coroutine::yield_with(reply, &recv);
+  }
+
+  return sum;
+}
+}  // namespace
+
+CASE_TEST(coroutine_transfer, resume_with_and_yield_with) {
+  copp::coroutine_context_default::ptr_t co =
+      copp::coroutine_context_default::create(test_context_transfer_echo_runner, 64 * 1024);
+  CASE_EXPECT_TRUE(!!co);
+
+  std::string *reply = nullptr;
+  test_context_transfer_move_only v1(3);
+  CASE_EXPECT_EQ(0, co->resume_with(v1, &reply));
+  CASE_EXPECT_EQ(0, v1.value);
+  CASE_EXPECT_TRUE(nullptr != reply);
+  if (nullptr != reply) {
+    CASE_EXPECT_EQ("3", *reply);
+  }
+
+  CASE_EXPECT_EQ(0, co->resume_with(test_context_transfer_move_only(5), &reply));
+  CASE_EXPECT_TRUE(nullptr != reply);
+  if (nullptr != reply) {
+    CASE_EXPECT_EQ("8", *reply);
+  }
+
+  // resume without data, the coroutine will finish and nothing will be yielded
+  void *finish_data = &reply;
+  CASE_EXPECT_EQ(0, co->resume_transfer(nullptr, &finish_data));
+  CASE_EXPECT_EQ(nullptr, finish_data);
+  CASE_EXPECT_TRUE(co->is_finished());
+  CASE_EXPECT_EQ(8, co->get_ret_code());
+}
+
+namespace {
+static int test_context_transfer_receive_runner(void *) {
+  int sum = 0;
+  int *value = nullptr;
+  while (nullptr != (value = copp::this_coroutine::yield_receive<int>())) {
+    sum += *value;
+  }
+  return sum;
+}
+}  // namespace
+
+CASE_TEST(coroutine_transfer, yield_receive) {
+  copp::coroutine_context_default::ptr_t co =
+      copp::coroutine_context_default::create(test_context_transfer_receive_runner, 64 * 1024);
+  CASE_EXPECT_TRUE(!!co);
+
+  CASE_EXPECT_EQ(0, co->start());
+  for (int i = 1; i <= 10; ++i) {
+    CASE_EXPECT_EQ(0, co->resume_with(i));
+  }
+  CASE_EXPECT_FALSE(co->is_finished());
+  CASE_EXPECT_EQ(0, co->resume());
+  CASE_EXPECT_TRUE(co->is_finished());
+  CASE_EXPECT_EQ(55, co->get_ret_code());
+
+  CASE_EXPECT_EQ(nullptr, copp::this_coroutine::yield_receive<int>());
+  CASE_EXPECT_EQ(copp::COPP_EC_NOT_RUNNING, copp::this_coroutine::yield_with(1));
+}
+
+CASE_TEST(coroutine_transfer, stackful_generator) {
+  using generator_type = copp::stackful_generator<int>;
+  generator_type gen(
+      [](generator_type::sink_type &sink) {
+        for (int i = 0; i < 5; ++i) {
+          sink(i * i);
+        }
+      },
+      64 * 1024);
+
+  std::vector<int> values;
+  for (int &v : gen) {
+    values.push_back(v);
+  }
+
+  CASE_EXPECT_EQ(5, static_cast<int>(values.size()));
+  for (size_t i = 0; i < values.size(); ++i) {
+    CASE_EXPECT_EQ(static_cast<int>(i * i), values[i]);
+  }
+  CASE_EXPECT_TRUE(gen.is_finished());
+  CASE_EXPECT_TRUE(gen.begin() == gen.end());
+}
+
+CASE_TEST(coroutine_transfer, stackful_generator_move_only) {
+  using generator_type = copp::stackful_generator<std::unique_ptr<std::string>>;
+  generator_type gen(
+      [](generator_type::sink_type &sink) {
+        std::unique_ptr<std::string> kept(new std::string("kept"));
+        sink(kept);
+        CASE_EXPECT_TRUE(!!kept);
+
+        sink(std::unique_ptr<std::string>(new std::string("moved")));
+      },
+      64 * 1024);
+
+  generator_type moved_gen(std::move(gen));
+  generator_type::iterator iter = moved_gen.begin();
+  CASE_EXPECT_TRUE(iter != moved_gen.end());
+  CASE_EXPECT_EQ("kept", **iter);
+  ++iter;
+  CASE_EXPECT_TRUE(iter != moved_gen.end());
+  std::unique_ptr<std::string> took = std::move(*iter);
+  CASE_EXPECT_EQ("moved", *took);
+  ++iter;
+  CASE_EXPECT_TRUE(iter == moved_gen.end());
+  CASE_EXPECT_TRUE(moved_gen.is_finished());
+}
@@ -0,0 +1,96 @@
+// Copyright 2023 owent
+
+#include <libcotask/static_task.h>
+#include <libcotask/task.h>
+#include <libcotask/task_manager.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "frame/test_macros.h"
+
+#ifdef LIBCOTASK_MACRO_ENABLED
+
+namespace {
+struct test_static_task_action {
+  int *counter;
+  int step;
+
+  test_static_task_action(int *c, int s) : counter(c), step(s) {}
+
+  int operator()(void *priv_data) {
+    using static_task_type = cotask::static_task<test_static_task_action>;
+    static_task_type *self = static_task_type::this_task();
+    CASE_EXPECT_TRUE(nullptr != self);
+    if (nullptr == self) {
+      return -1;
+    }
+
+    CASE_EXPECT_EQ(counter, self->get_action().counter);
+    *counter += step;
+    self->yield(&priv_data);
+    *counter += step;
+
+    return *reinterpret_cast<int *>(priv_data);
+  }
+};
+
+struct test_static_task_void_action {
+  int *counter;
+
+  void operator()() { ++(*counter); }
+};
+}  // namespace
+
+CASE_TEST(coroutine_static_task, start_and_resume) {
+  using static_task_type = cotask::static_task<test_static_task_action>;
+  int counter = 0;
+  int ret_code = 7;
+
+  static_task_type::ptr_type task_inst = static_task_type::create_with(64 * 1024, 0, &counter, 3);
+  CASE_EXPECT_TRUE(!!task_inst);
+  CASE_EXPECT_EQ(cotask::EN_TS_CREATED, task_inst->get_status());
+
+  CASE_EXPECT_EQ(0, task_inst->start());
+  CASE_EXPECT_EQ(3, counter);
+  CASE_EXPECT_EQ(cotask::EN_TS_WAITING, task_inst->get_status());
+
+  CASE_EXPECT_EQ(0, task_inst->resume(&ret_code));
+  CASE_EXPECT_EQ(6, counter);
+  CASE_EXPECT_TRUE(task_inst->is_completed());
+  CASE_EXPECT_EQ(7, task_inst->get_ret_code());
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_FINISHED, task_inst->start());
+}
+
+CASE_TEST(coroutine_static_task, work_with_task) {
+  using static_task_type = cotask::static_task<test_static_task_void_action>;
+  using task_manager_type = cotask::task_manager<cotask::task<> >;
+  int counter = 0;
+
+  test_static_task_void_action action;
+  action.counter = &counter;
+  static_task_type::ptr_type first = static_task_type::create(action, 64 * 1024);
+  static_task_type::ptr_type second = static_task_type::create(action, 64 * 1024);
+  CASE_EXPECT_TRUE(first && second);
+
+  // static_task can be used as task<>
+  cotask::task<>::ptr_type base_ptr = first;
+  static_task_type::base_ptr_type second_base_ptr = second;
+  CASE_EXPECT_EQ(second_base_ptr, base_ptr->next(second_base_ptr));
+
+  task_manager_type::ptr_type mgr = task_manager_type::create();
+  CASE_EXPECT_EQ(0, mgr->add_task(base_ptr));
+  CASE_EXPECT_EQ(0, mgr->start(first->get_id()));
+  CASE_EXPECT_EQ(2, counter);
+  CASE_EXPECT_TRUE(first->is_completed());
+  CASE_EXPECT_TRUE(second->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), mgr->get_task_size());
+
+  // unfinished static_task is killed when released
+  static_task_type::ptr_type killed = static_task_type::create(action, 64 * 1024);
+  CASE_EXPECT_EQ(0, killed->kill());
+  CASE_EXPECT_EQ(cotask::EN_TS_KILLED, killed->get_status());
+}
+
+#endif
@@ -0,0 +1,181 @@
+// Copyright 2023 owent
+
+#include <libcotask/task.h>
+#include <libcotask/task_arena.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+#ifdef LIBCOTASK_MACRO_ENABLED
+
+CASE_TEST(coroutine_task_arena, allocate) {
+  cotask::task_arena *arena = cotask::task_arena::create();
+  CASE_EXPECT_TRUE(nullptr != arena);
+  if (nullptr == arena) {
+    return;
+  }
+
+  void *p1 = arena->allocate(24);
+  void *p2 = arena->allocate(8, 64);
+  CASE_EXPECT_TRUE(nullptr != p1 && nullptr != p2);
+  CASE_EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p2) % 64);
+  CASE_EXPECT_EQ(32, arena->get_allocated_size());
+  CASE_EXPECT_EQ(1, arena->get_block_count());
+  CASE_EXPECT_TRUE(nullptr == arena->allocate(8, 3));
+
+  // the last allocation can be reused
+  arena->deallocate(p2, 8);
+  CASE_EXPECT_EQ(p2, arena->allocate(8, 64));
+
+  // large allocation uses a dedicated block
+  void *large = arena->allocate(cotask::task_arena::BLOCK_SIZE * 2);
+  CASE_EXPECT_TRUE(nullptr != large);
+  memset(large, 0, cotask::task_arena::BLOCK_SIZE * 2);
+  CASE_EXPECT_EQ(2, arena->get_block_count());
+
+  for (int i = 0; i < 64; ++i) {
+    CASE_EXPECT_TRUE(nullptr != arena->allocate(256));
+  }
+  CASE_EXPECT_GT(arena->get_block_count(), 2);
+
+  arena->release();
+  CASE_EXPECT_EQ(0, arena->get_allocated_size());
+  CASE_EXPECT_EQ(1, arena->get_block_count());
+  CASE_EXPECT_EQ(p1, arena->allocate(24));
+
+  cotask::task_arena::destroy(arena);
+}
+
+CASE_TEST(coroutine_task_arena, this_task) {
+  CASE_EXPECT_TRUE(nullptr == cotask::this_task::get_arena());
+
+  cotask::task_arena *task_arena = nullptr;
+  size_t sum = 0;
+  cotask::task<>::ptr_type task_inst = cotask::task<>::create(
+      [&task_arena, &sum](void *) {
+        task_arena = cotask::this_task::get_arena();
+        CASE_EXPECT_TRUE(nullptr != task_arena);
+        CASE_EXPECT_EQ(task_arena, cotask::this_task::get_arena());
+
+        using allocator_type = cotask::task_arena_allocator<size_t>;
+        std::vector<size_t, allocator_type> values((allocator_type(task_arena)));
+        for (size_t i = 0; i < 1000; ++i) {
+          values.push_back(i);
+        }
+        CASE_EXPECT_GT(task_arena->get_block_count(), 1);
+
+        cotask::this_task::get_task()->yield();
+        for (size_t i = 0; i < values.size(); ++i) {
+          sum += values[i];
+        }
+        return 0;
+      },
+      64 * 1024);
+
+  CASE_EXPECT_EQ(0, task_inst->start());
+  CASE_EXPECT_TRUE(nullptr != task_arena);
+  CASE_EXPECT_EQ(task_arena, task_inst->get_arena());
+
+  CASE_EXPECT_EQ(0, task_inst->resume());
+  CASE_EXPECT_TRUE(task_inst->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(999 * 1000 / 2), sum);
+}
+
+namespace {
+struct test_task_arena_private_data {
+  using allocator_type = cotask::task_arena_allocator<int>;
+  using vector_type = std::vector<int, allocator_type>;
+
+  std::unique_ptr<vector_type> values;
+};
+}  // namespace
+
+CASE_TEST(coroutine_task_arena, private_data) {
+  cotask::task_arena *holder_arena = nullptr;
+  cotask::task<>::ptr_type holder = cotask::task<>::create_with_private_data<test_task_arena_private_data>(
+      [&holder_arena](void *) {
+        test_task_arena_private_data *private_data =
+            cotask::this_task::get_private_data<test_task_arena_private_data>();
+        CASE_EXPECT_TRUE(nullptr != private_data);
+        if (nullptr == private_data) {
+          return 0;
+        }
+
+        // memory of values is released with the task, the vector itself is destroyed with private data later
+        holder_arena = cotask::this_task::get_arena();
+        private_data->values.reset(
+            new test_task_arena_private_data::vector_type(test_task_arena_private_data::allocator_type(holder_arena)));
+        private_data->values->reserve(250);
+        for (int i = 0; i < 250; ++i) {
+          private_data->values->push_back(i);
+        }
+        return 0;
+      },
+      64 * 1024);
+  CASE_EXPECT_TRUE(!!holder);
+  if (!holder) {
+    return;
+  }
+
+  CASE_EXPECT_EQ(0, holder->start());
+  CASE_EXPECT_TRUE(holder->is_completed());
+  CASE_EXPECT_TRUE(nullptr != holder_arena);
+
+  cotask::task_arena *other_arena = nullptr;
+  cotask::task<>::ptr_type other = cotask::task<>::create(
+      [&other_arena](void *) {
+        other_arena = cotask::this_task::get_arena();
+        CASE_EXPECT_TRUE(nullptr != other_arena);
+        if (nullptr == other_arena) {
+          return 0;
+        }
+
+        CASE_EXPECT_TRUE(nullptr != other_arena->allocate(1000));
+        cotask::this_task::get_task()->yield();
+        return 0;
+      },
+      64 * 1024);
+  CASE_EXPECT_EQ(0, other->start());
+  CASE_EXPECT_TRUE(nullptr != other_arena);
+  CASE_EXPECT_NE(holder_arena, other_arena);
+  if (nullptr == other_arena) {
+    return;
+  }
+  CASE_EXPECT_EQ(1000, other_arena->get_allocated_size());
+
+  // destroying private data of the finished task must not touch the arena of other tasks
+  holder.reset();
+  CASE_EXPECT_EQ(1000, other_arena->get_allocated_size());
+
+  CASE_EXPECT_EQ(0, other->resume());
+  CASE_EXPECT_TRUE(other->is_completed());
+}
+
+#  if defined(LIBCOTASK_MACRO_ENABLE_TASK_ARENA_PMR) && LIBCOTASK_MACRO_ENABLE_TASK_ARENA_PMR
+CASE_TEST(coroutine_task_arena, memory_resource) {
+  size_t allocated_size = 0;
+  cotask::task<>::ptr_type task_inst = cotask::task<>::create(
+      [&allocated_size](void *) {
+        cotask::task_arena_memory_resource mr(cotask::this_task::get_arena());
+        std::pmr::vector<int> values(&mr);
+        values.reserve(128);
+        for (int i = 0; i < 128; ++i) {
+          values.push_back(i);
+        }
+        allocated_size = mr.get_arena()->get_allocated_size();
+        return 0;
+      },
+      64 * 1024);
+
+  CASE_EXPECT_EQ(0, task_inst->start());
+  CASE_EXPECT_TRUE(task_inst->is_completed());
+  CASE_EXPECT_EQ(128 * sizeof(int), allocated_size);
+}
+#  endif
+
+#endif
@@ -0,0 +1,160 @@
+// Copyright 2023 owent
+
+#include <libcotask/task.h>
+#include <libcotask/task_dag.h>
+#include <libcotask/task_executor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+#ifdef LIBCOTASK_MACRO_ENABLED
+
+using test_task_dag_type = cotask::task_dag<>;
+
+namespace {
+struct test_task_dag_record_action {
+  std::vector<int> *order;
+  int value;
+
+  test_task_dag_record_action(std::vector<int> *o, int v) : order(o), value(v) {}
+
+  int operator()(void *) {
+    order->push_back(value);
+    return 0;
+  }
+};
+}  // namespace
+
+CASE_TEST(coroutine_task_dag, run_loop) {
+  std::vector<int> order;
+  test_task_dag_type::ptr_type dag = test_task_dag_type::create();
+
+  // a -> (b, c) -> d, c yields once and is resumed later
+  size_t a = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 1)), "a");
+  size_t b = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 2)), "b");
+  cotask::task<>::ptr_type c_task = cotask::task<>::create([&order](void *) {
+    order.push_back(3);
+    cotask::this_task::get_task()->yield();
+    order.push_back(4);
+    return 0;
+  });
+  size_t c = dag->add_node(c_task, "c");
+  size_t d = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 5)), "d");
+  CASE_EXPECT_EQ(static_cast<size_t>(4), dag->get_node_count());
+  CASE_EXPECT_EQ(test_task_dag_type::npos, dag->add_node(cotask::task<>::ptr_type()));
+
+  CASE_EXPECT_EQ(0, dag->add_edge(a, b));
+  CASE_EXPECT_EQ(0, dag->add_edge(a, c));
+  CASE_EXPECT_EQ(0, dag->add_edge(b, d));
+  CASE_EXPECT_EQ(0, dag->add_edge(c, d));
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, dag->add_edge(a, a));
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, dag->add_edge(a, 4));
+
+  CASE_EXPECT_EQ(0, dag->run());
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_INITED, dag->run());
+  CASE_EXPECT_EQ(copp::COPP_EC_IS_RUNNING, dag->add_edge(b, c));
+  CASE_EXPECT_FALSE(dag->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), dag->get_finished_count());
+  CASE_EXPECT_EQ(static_cast<size_t>(3), order.size());
+
+  // d is ready after c finished
+  c_task->resume();
+  CASE_EXPECT_EQ(static_cast<size_t>(1), dag->run_ready());
+  CASE_EXPECT_TRUE(dag->is_completed());
+
+  std::vector<int> expect_order = {1, 2, 3, 4, 5};
+  CASE_EXPECT_TRUE(expect_order == order);
+
+  for (size_t i = 0; i < dag->get_node_count(); ++i) {
+    CASE_EXPECT_TRUE(dag->get_node_timing(i).finish_time >= dag->get_node_timing(i).ready_time);
+  }
+  CASE_EXPECT_TRUE(dag->get_node_timing(d).ready_time >= dag->get_node_timing(c).finish_time);
+
+  // c waits for the resume, so it's on the critical path
+  test_task_dag_type::critical_path_type critical_path = dag->get_critical_path();
+  std::vector<size_t> expect_path = {a, c, d};
+  CASE_EXPECT_TRUE(expect_path == critical_path.nodes);
+  CASE_EXPECT_TRUE(critical_path.duration <= dag->get_total_duration());
+  CASE_EXPECT_EQ("c", dag->get_node_name(critical_path.nodes[1]));
+}
+
+CASE_TEST(coroutine_task_dag, cycle) {
+  std::vector<int> order;
+  test_task_dag_type::ptr_type dag = test_task_dag_type::create();
+  size_t a = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 1)));
+  size_t b = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 2)));
+  size_t c = dag->add_node(cotask::task<>::create(test_task_dag_record_action(&order, 3)));
+  CASE_EXPECT_EQ(0, dag->add_edge(a, b));
+  CASE_EXPECT_EQ(0, dag->add_edge(b, c));
+  CASE_EXPECT_EQ(0, dag->add_edge(c, b));
+
+  CASE_EXPECT_EQ(copp::COPP_EC_TASK_DAG_HAS_CYCLE, dag->run());
+  CASE_EXPECT_FALSE(dag->is_started());
+  CASE_EXPECT_TRUE(order.empty());
+  CASE_EXPECT_TRUE(dag->get_critical_path().nodes.empty());
+}
+
+#  if defined(LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR) && LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR
+CASE_TEST(coroutine_task_dag, executor) {
+  using test_task_executor_type = cotask::task_executor<>;
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(4);
+  CASE_EXPECT_EQ(0, executor->start());
+
+  // root -> 16 independent branches -> sink
+  const size_t branch_count = 16;
+  std::atomic<int> branch_finished(0);
+  std::atomic<int> error_count(0);
+  test_task_dag_type::ptr_type dag = test_task_dag_type::create();
+  size_t root = dag->add_node(cotask::task<>::create([](void *) { return 0; }, 64 * 1024));
+  size_t sink = dag->add_node(cotask::task<>::create(
+      [&branch_finished, &error_count, branch_count](void *) {
+        if (branch_finished.load() != static_cast<int>(branch_count)) {
+          ++error_count;
+        }
+        return 0;
+      },
+      64 * 1024));
+  for (size_t i = 0; i < branch_count; ++i) {
+    size_t branch = dag->add_node(cotask::task<>::create(
+        [&branch_finished](void *) {
+          cotask::this_task::get_task()->yield();
+          ++branch_finished;
+          return 0;
+        },
+        64 * 1024));
+    dag->add_edge(root, branch);
+    dag->add_edge(branch, sink);
+  }
+
+  CASE_EXPECT_EQ(0, dag->run([&executor](const test_task_dag_type::task_ptr_type &task_inst) {
+    executor->post(task_inst);
+  }));
+
+  // branches yield and are resumed by the executor
+  for (int i = 0; i < 10000 && !dag->is_completed(); ++i) {
+    executor->wait_idle();
+    for (size_t j = 0; j < dag->get_node_count(); ++j) {
+      if (cotask::EN_TS_WAITING == dag->get_node_task(j)->get_status()) {
+        executor->post(dag->get_node_task(j));
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  CASE_EXPECT_TRUE(dag->is_completed());
+  CASE_EXPECT_EQ(static_cast<int>(branch_count), branch_finished.load());
+  CASE_EXPECT_EQ(0, error_count.load());
+  CASE_EXPECT_EQ(static_cast<size_t>(3), dag->get_critical_path().nodes.size());
+
+  executor->stop();
+}
+#  endif
+
+#endif
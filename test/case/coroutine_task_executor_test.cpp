@@ -0,0 +1,344 @@
+// Copyright 2023 owent
+
+#include <libcotask/task.h>
+#include <libcotask/task_executor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+#if defined(LIBCOTASK_MACRO_ENABLED) && LIBCOTASK_MACRO_ENABLE_TASK_EXECUTOR
+
+using test_task_executor_type = cotask::task_executor<>;
+
+CASE_TEST(coroutine_task_executor, work_stealing_deque_st) {
+  cotask::detail::task_work_stealing_deque<int> deque(16);
+  std::vector<int> values;
+  values.resize(100);
+  for (int i = 0; i < 100; ++i) {
+    values[static_cast<size_t>(i)] = i;
+  }
+
+  CASE_EXPECT_TRUE(nullptr == deque.pop());
+  CASE_EXPECT_TRUE(nullptr == deque.steal());
+
+  // grow
+  for (size_t i = 0; i < values.size(); ++i) {
+    deque.push(&values[i]);
+  }
+  CASE_EXPECT_EQ(values.size(), deque.size());
+  CASE_EXPECT_GE(deque.capacity(), values.size());
+
+  // pop from bottom and steal from top
+  CASE_EXPECT_EQ(99, *deque.pop());
+  CASE_EXPECT_EQ(0, *deque.steal());
+  CASE_EXPECT_EQ(98, *deque.pop());
+  CASE_EXPECT_EQ(1, *deque.steal());
+  CASE_EXPECT_EQ(static_cast<size_t>(96), deque.size());
+
+  size_t count = 0;
+  while (nullptr != deque.pop()) {
+    ++count;
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(96), count);
+  CASE_EXPECT_TRUE(deque.empty());
+}
+
+CASE_TEST(coroutine_task_executor, work_stealing_deque_mt) {
+  cotask::detail::task_work_stealing_deque<int> deque(16);
+  const size_t value_count = 100000;
+  std::vector<int> values;
+  values.resize(value_count);
+  std::unique_ptr<std::atomic<int>[]> taken(new std::atomic<int>[value_count]);
+  for (size_t i = 0; i < value_count; ++i) {
+    values[i] = static_cast<int>(i);
+    taken[i].store(0);
+  }
+
+  std::atomic<bool> finished(false);
+  std::unique_ptr<std::thread> thieves[3];
+  for (int i = 0; i < 3; ++i) {
+    thieves[i].reset(new std::thread([&deque, &finished, &taken]() {
+      while (true) {
+        int *value = deque.steal();
+        if (nullptr != value) {
+          taken[static_cast<size_t>(*value)].fetch_add(1);
+        } else if (finished.load() && deque.empty()) {
+          break;
+        }
+      }
+    }));
+  }
+
+  // owner pushes and pops at the same time
+  for (size_t i = 0; i < value_count; ++i) {
+    deque.push(&values[i]);
+    if (0 == i % 3) {
+      int *value = deque.pop();
+      if (nullptr != value) {
+        taken[static_cast<size_t>(*value)].fetch_add(1);
+      }
+    }
+  }
+  finished.store(true);
+
+  for (int i = 0; i < 3; ++i) {
+    thieves[i]->join();
+  }
+
+  size_t bad_count = 0;
+  for (size_t i = 0; i < value_count; ++i) {
+    if (1 != taken[i].load()) {
+      ++bad_count;
+    }
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(0), bad_count);
+}
+
+namespace {
+struct test_task_executor_context {
+  std::atomic<int> step_count;
+  std::atomic<int> finished_count;
+  std::atomic<int> error_count;
+  test_task_executor_type *executor;
+
+  explicit test_task_executor_context(test_task_executor_type *e)
+      : step_count(0), finished_count(0), error_count(0), executor(e) {}
+};
+}  // namespace
+
+CASE_TEST(coroutine_task_executor, yield_and_steal) {
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(4);
+  CASE_EXPECT_EQ(static_cast<size_t>(4), executor->get_worker_count());
+
+  test_task_executor_context context(executor.get());
+  std::vector<test_task_executor_type::task_ptr_type> tasks;
+  for (int i = 0; i < 256; ++i) {
+    // uneven workload
+    int yield_times = 0 == i % 16 ? 64 : 4;
+    tasks.push_back(test_task_executor_type::task_type::create(
+        [&context, yield_times](void *) {
+          for (int j = 0; j < yield_times; ++j) {
+            if (test_task_executor_type::this_executor() != context.executor) {
+              ++context.error_count;
+            }
+            if (nullptr == cotask::this_task::get_task()) {
+              ++context.error_count;
+            }
+
+            ++context.step_count;
+            test_task_executor_type::yield();
+          }
+
+          ++context.finished_count;
+          return 0;
+        },
+        16 * 1024));
+  }
+
+  // post before start will use the injection queue
+  for (size_t i = 0; i < tasks.size() / 2; ++i) {
+    CASE_EXPECT_EQ(0, executor->post(tasks[i]));
+  }
+  CASE_EXPECT_EQ(tasks.size() / 2, executor->get_pending_count());
+  CASE_EXPECT_EQ(0, executor->start());
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_INITED, executor->start());
+  for (size_t i = tasks.size() / 2; i < tasks.size(); ++i) {
+    CASE_EXPECT_EQ(0, executor->post(tasks[i]));
+  }
+
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+  CASE_EXPECT_EQ(256, context.finished_count.load());
+  CASE_EXPECT_EQ(16 * 64 + 240 * 4, context.step_count.load());
+  CASE_EXPECT_EQ(0, context.error_count.load());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), executor->get_pending_count());
+  CASE_EXPECT_EQ(static_cast<uint64_t>(256 + 16 * 64 + 240 * 4), executor->get_executed_count());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    CASE_EXPECT_TRUE(tasks[i]->is_completed());
+  }
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_FINISHED, executor->post(tasks[0]));
+  CASE_EXPECT_TRUE(nullptr == test_task_executor_type::this_executor());
+  CASE_EXPECT_EQ(copp::COPP_EC_NOT_RUNNING, test_task_executor_type::yield());
+
+  executor->stop();
+  CASE_EXPECT_FALSE(executor->is_running());
+}
+
+CASE_TEST(coroutine_task_executor, post_by_worker) {
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(2);
+  test_task_executor_context context(executor.get());
+  CASE_EXPECT_EQ(0, executor->start());
+
+  // every parent task spawns children into the deque of its worker
+  std::vector<test_task_executor_type::task_ptr_type> parents;
+  for (int i = 0; i < 8; ++i) {
+    parents.push_back(test_task_executor_type::task_type::create(
+        [&context](void *) {
+          for (int j = 0; j < 32; ++j) {
+            test_task_executor_type::task_ptr_type child = test_task_executor_type::task_type::create(
+                [&context](void *) {
+                  ++context.step_count;
+                  test_task_executor_type::yield();
+                  ++context.finished_count;
+                  return 0;
+                },
+                16 * 1024);
+            if (0 != context.executor->post(child)) {
+              ++context.error_count;
+            }
+          }
+          ++context.finished_count;
+          return 0;
+        },
+        16 * 1024));
+  }
+  for (size_t i = 0; i < parents.size(); ++i) {
+    CASE_EXPECT_EQ(0, executor->post(parents[i]));
+  }
+
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+  CASE_EXPECT_EQ(8 + 8 * 32, context.finished_count.load());
+  CASE_EXPECT_EQ(8 * 32, context.step_count.load());
+  CASE_EXPECT_EQ(0, context.error_count.load());
+}
+
+CASE_TEST(coroutine_task_executor, resume_waiting_task) {
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(2);
+  test_task_executor_context context(executor.get());
+  CASE_EXPECT_EQ(0, executor->start());
+
+  // task yields by itself, and will be posted again by another thread
+  test_task_executor_type::task_ptr_type task_inst = test_task_executor_type::task_type::create(
+      [&context](void *) {
+        ++context.step_count;
+        cotask::this_task::get_task()->yield();
+        ++context.finished_count;
+        return 0;
+      },
+      16 * 1024);
+
+  CASE_EXPECT_EQ(0, executor->post(task_inst));
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+  CASE_EXPECT_EQ(1, context.step_count.load());
+  CASE_EXPECT_EQ(0, context.finished_count.load());
+  CASE_EXPECT_EQ(cotask::EN_TS_WAITING, task_inst->get_status());
+
+  CASE_EXPECT_EQ(0, executor->post(task_inst));
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+  CASE_EXPECT_EQ(1, context.finished_count.load());
+  CASE_EXPECT_TRUE(task_inst->is_completed());
+}
+
+CASE_TEST(coroutine_task_executor, post_before_yield) {
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(2);
+  test_task_executor_context context(executor.get());
+  CASE_EXPECT_EQ(0, executor->start());
+
+  const int task_count = 500;
+  std::unique_ptr<std::atomic<bool>[]> posted(new std::atomic<bool>[task_count]);
+  for (int i = 0; i < task_count; ++i) {
+    posted[i].store(false);
+  }
+
+  // like an async completion thread, it posts tasks back as soon as it gets them, before they yield
+  std::mutex completion_lock;
+  std::vector<std::pair<test_task_executor_type::task_ptr_type, int>> completion_queue;
+  std::atomic<bool> completion_stop(false);
+  std::thread completion_thread([&]() {
+    std::vector<std::pair<test_task_executor_type::task_ptr_type, int>> tasks;
+    while (!completion_stop.load()) {
+      {
+        std::lock_guard<std::mutex> guard(completion_lock);
+        tasks.swap(completion_queue);
+      }
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        if (0 != context.executor->post(tasks[i].first)) {
+          ++context.error_count;
+        }
+        posted[tasks[i].second].store(true);
+      }
+      tasks.clear();
+    }
+  });
+
+  std::vector<test_task_executor_type::task_ptr_type> tasks;
+  for (int i = 0; i < task_count; ++i) {
+    tasks.push_back(test_task_executor_type::task_type::create(
+        [&, i](void *) {
+          ++context.step_count;
+          {
+            std::lock_guard<std::mutex> guard(completion_lock);
+            completion_queue.push_back(std::make_pair(
+                test_task_executor_type::task_ptr_type(test_task_executor_type::task_type::this_task()), i));
+          }
+          // make sure it's posted when it's still running
+          while (!posted[i].load()) {
+            std::this_thread::yield();
+          }
+          cotask::this_task::get_task()->yield();
+          ++context.finished_count;
+          return 0;
+        },
+        16 * 1024));
+  }
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    CASE_EXPECT_EQ(0, executor->post(tasks[i]));
+  }
+
+  // lost tasks never finish
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (context.finished_count.load() < task_count && std::chrono::steady_clock::now() < deadline) {
+    CASE_EXPECT_EQ(0, executor->wait_idle());
+    std::this_thread::yield();
+  }
+  completion_stop.store(true);
+  completion_thread.join();
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+
+  CASE_EXPECT_EQ(task_count, context.step_count.load());
+  CASE_EXPECT_EQ(task_count, context.finished_count.load());
+  CASE_EXPECT_EQ(0, context.error_count.load());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    CASE_EXPECT_TRUE(tasks[i]->is_completed());
+  }
+}
+
+CASE_TEST(coroutine_task_executor, stop_with_pending_tasks) {
+  test_task_executor_type::ptr_type executor = test_task_executor_type::create(1);
+  test_task_executor_context context(executor.get());
+
+  test_task_executor_type::task_ptr_type task_inst = test_task_executor_type::task_type::create(
+      [&context](void *) {
+        ++context.finished_count;
+        return 0;
+      },
+      16 * 1024);
+
+  // not started, tasks are just released
+  CASE_EXPECT_EQ(0, executor->post(task_inst));
+  CASE_EXPECT_EQ(copp::COPP_EC_NOT_RUNNING, executor->wait_idle());
+  executor->stop();
+  CASE_EXPECT_EQ(static_cast<size_t>(0), executor->get_pending_count());
+  CASE_EXPECT_EQ(0, context.finished_count.load());
+  CASE_EXPECT_EQ(cotask::EN_TS_CREATED, task_inst->get_status());
+
+  CASE_EXPECT_EQ(0, executor->start());
+  CASE_EXPECT_EQ(0, executor->post(task_inst));
+  CASE_EXPECT_EQ(0, executor->wait_idle());
+  executor->stop();
+  CASE_EXPECT_EQ(1, context.finished_count.load());
+  CASE_EXPECT_TRUE(task_inst->is_completed());
+}
+
+#endif
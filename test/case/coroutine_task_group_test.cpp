@@ -0,0 +1,177 @@
+// Copyright 2023 owent
+
+#include <libcotask/task.h>
+#include <libcotask/task_group.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+#ifdef LIBCOTASK_MACRO_ENABLED
+
+using test_task_group_type = cotask::task_group<>;
+
+namespace {
+struct test_task_group_child_action {
+  int *finished;
+
+  explicit test_task_group_child_action(int *f) : finished(f) {}
+
+  int operator()(void *) {
+    cotask::task<> *self = cotask::task<>::this_task();
+    self->yield(nullptr);
+    // killed task is also resumed
+    if (!self->is_exiting()) {
+      ++(*finished);
+    }
+    return 0;
+  }
+};
+}  // namespace
+
+CASE_TEST(coroutine_task_group, join) {
+  const int child_count = 8;
+  int finished = 0;
+  int wakeup_count = 0;
+  int join_ret = -1;
+  std::vector<cotask::task<>::ptr_type> children;
+  test_task_group_type::ptr_type group = test_task_group_type::create();
+
+  cotask::task<>::ptr_type parent = cotask::task<>::create([&](void *) {
+    for (int i = 0; i < child_count; ++i) {
+      children.push_back(cotask::task<>::create(test_task_group_child_action(&finished), 64 * 1024));
+      CASE_EXPECT_EQ(0, group->spawn(children.back()));
+    }
+    // a finished child is not added
+    cotask::task<>::ptr_type done = cotask::task<>::create([](void *) { return 0; }, 64 * 1024);
+    done->start();
+    CASE_EXPECT_EQ(copp::COPP_EC_TASK_IS_EXITING, group->add(done));
+
+    join_ret = group->join();
+    ++wakeup_count;
+    return 0;
+  });
+
+  CASE_EXPECT_EQ(copp::COPP_EC_TASK_NOT_IN_ACTION, group->join());
+  CASE_EXPECT_EQ(0, parent->start());
+  CASE_EXPECT_EQ(static_cast<size_t>(child_count), group->get_pending_count());
+  CASE_EXPECT_EQ(cotask::EN_TS_WAITING, parent->get_status());
+
+  // parent is not woken up until the last child is finished
+  for (int i = 0; i < child_count; ++i) {
+    CASE_EXPECT_EQ(0, wakeup_count);
+    CASE_EXPECT_EQ(0, children[static_cast<size_t>(i)]->resume());
+  }
+
+  CASE_EXPECT_EQ(child_count, finished);
+  CASE_EXPECT_EQ(1, wakeup_count);
+  CASE_EXPECT_EQ(0, join_ret);
+  CASE_EXPECT_TRUE(parent->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), group->get_pending_count());
+}
+
+CASE_TEST(coroutine_task_group, kill_parent) {
+  int finished = 0;
+  int join_ret = 0;
+  std::vector<cotask::task<>::ptr_type> children;
+  test_task_group_type::ptr_type group = test_task_group_type::create();
+
+  cotask::task<>::ptr_type parent = cotask::task<>::create([&](void *) {
+    for (int i = 0; i < 4; ++i) {
+      children.push_back(cotask::task<>::create(test_task_group_child_action(&finished), 64 * 1024));
+      group->spawn(children.back());
+    }
+    join_ret = group->join();
+    return 0;
+  });
+
+  CASE_EXPECT_EQ(0, parent->start());
+  CASE_EXPECT_EQ(0, children[0]->resume());
+  CASE_EXPECT_EQ(static_cast<size_t>(3), group->get_pending_count());
+
+  // killing parent kills all unfinished children
+  CASE_EXPECT_EQ(0, parent->kill());
+  CASE_EXPECT_EQ(copp::COPP_EC_TASK_IS_EXITING, join_ret);
+  CASE_EXPECT_EQ(1, finished);
+  CASE_EXPECT_EQ(static_cast<size_t>(0), group->get_pending_count());
+  CASE_EXPECT_EQ(cotask::EN_TS_DONE, children[0]->get_status());
+  for (size_t i = 1; i < children.size(); ++i) {
+    CASE_EXPECT_EQ(cotask::EN_TS_KILLED, children[i]->get_status());
+  }
+}
+
+CASE_TEST(coroutine_task_group, bind_parent) {
+  int finished = 0;
+  test_task_group_type::ptr_type group = test_task_group_type::create();
+  cotask::task<>::ptr_type child = cotask::task<>::create(test_task_group_child_action(&finished), 64 * 1024);
+
+  // parent exits without join, and child is killed
+  cotask::task<>::ptr_type parent = cotask::task<>::create([&](void *) {
+    CASE_EXPECT_EQ(0, group->spawn(child));
+    cotask::this_task::get_task()->yield();
+    return 0;
+  });
+  CASE_EXPECT_EQ(0, group->bind_parent(parent));
+  CASE_EXPECT_EQ(0, parent->start());
+  CASE_EXPECT_EQ(static_cast<size_t>(1), group->get_pending_count());
+
+  CASE_EXPECT_EQ(0, parent->resume());
+  CASE_EXPECT_TRUE(parent->is_completed());
+  CASE_EXPECT_EQ(cotask::EN_TS_KILLED, child->get_status());
+  CASE_EXPECT_EQ(0, finished);
+  CASE_EXPECT_EQ(static_cast<size_t>(0), group->get_pending_count());
+}
+
+CASE_TEST(coroutine_task_group, join_cross_thread) {
+  const int loop_count = 1000;
+  int finished = 0;
+  int completed_parents = 0;
+
+  for (int i = 0; i < loop_count; ++i) {
+    std::atomic<bool> joining(false);
+    test_task_group_type::ptr_type group = test_task_group_type::create();
+    cotask::task<>::ptr_type child = cotask::task<>::create(test_task_group_child_action(&finished), 64 * 1024);
+
+    cotask::task<>::ptr_type parent = cotask::task<>::create([&](void *) {
+      group->spawn(child);
+      joining.store(true);
+      // the last child may be finished by another thread before parent switches out
+      return group->join();
+    });
+
+    std::thread finisher([&]() {
+      while (!joining.load()) {
+        std::this_thread::yield();
+      }
+      child->resume();
+    });
+
+    CASE_EXPECT_EQ(0, parent->start());
+
+    // wait for the wakeup from finisher, and do not hang the whole test if it's lost
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!parent->is_completed() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    finisher.join();
+
+    if (!parent->is_completed()) {
+      CASE_EXPECT_TRUE(parent->is_completed());
+      // release the lost parent
+      parent->kill();
+      break;
+    }
+    ++completed_parents;
+  }
+
+  CASE_EXPECT_EQ(loop_count, completed_parents);
+  CASE_EXPECT_EQ(completed_parents, finished);
+}
+
+#endif
@@ -2,11 +2,13 @@
 
 #include <libcotask/task.h>
 #include <libcotask/task_manager.h>
+#include <libcotask/task_manager_sharded.h>
 
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "frame/test_macros.h"
 
@@ -172,6 +174,82 @@ CASE_TEST(coroutine_task_manager, add_and_timeout) {
   task_mgr.reset();
 }
 
+CASE_TEST(coroutine_task_manager, add_tasks) {
+  using task_ptr_type = cotask::task<>::ptr_t;
+  using mgr_t = cotask::task_manager<cotask::task<> >;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+
+  std::vector<task_ptr_type> tasks = cotask::task<>::create_many(
+      8, [](size_t) { return test_context_task_manager_action(); }, 64 * 1024);
+  CASE_EXPECT_EQ(8, tasks.size());
+  // invalid and duplicated tasks are skipped
+  tasks.push_back(task_ptr_type());
+  tasks.push_back(tasks[0]);
+
+  CASE_EXPECT_EQ(8, task_mgr->add_tasks(tasks, 5, 0));
+  CASE_EXPECT_EQ(8, task_mgr->get_task_size());
+  CASE_EXPECT_EQ(8, task_mgr->get_tick_checkpoint_size());
+  CASE_EXPECT_EQ(0, task_mgr->add_tasks(tasks));
+
+  int check_status = g_test_coroutine_task_manager_status;
+  for (size_t i = 0; i < 8; ++i) {
+    CASE_EXPECT_EQ(0, task_mgr->start(tasks[i]->get_id()));
+    CASE_EXPECT_EQ(0, task_mgr->resume(tasks[i]->get_id()));
+  }
+  CASE_EXPECT_EQ(check_status + 16, g_test_coroutine_task_manager_status);
+  CASE_EXPECT_EQ(0, task_mgr->get_task_size());
+}
+
+namespace {
+struct test_context_task_manager_reclaim_data {
+  int *destroy_count;
+
+  explicit test_context_task_manager_reclaim_data(int *c) : destroy_count(c) {}
+  ~test_context_task_manager_reclaim_data() { ++(*destroy_count); }
+};
+}  // namespace
+
+CASE_TEST(coroutine_task_manager, deferred_reclaim) {
+  using mgr_t = cotask::task_manager<cotask::task<> >;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+  task_mgr->set_deferred_reclaim(3);
+  CASE_EXPECT_EQ(3, task_mgr->get_deferred_reclaim_backlog());
+
+  int destroy_count = 0;
+  std::vector<cotask::task<>::id_t> task_ids;
+  for (int i = 0; i < 4; ++i) {
+    cotask::task<>::ptr_t co_task = cotask::task<>::create_with_private_data<test_context_task_manager_reclaim_data>(
+        [](void *) {
+          cotask::this_task::get_task()->yield();
+          return 0;
+        },
+        64 * 1024, &destroy_count);
+    task_ids.push_back(co_task->get_id());
+    CASE_EXPECT_EQ(0, task_mgr->add_task(co_task));
+    CASE_EXPECT_EQ(0, task_mgr->start(co_task->get_id()));
+  }
+
+  for (size_t i = 0; i < task_ids.size(); ++i) {
+    CASE_EXPECT_EQ(0, task_mgr->resume(task_ids[i]));
+  }
+
+  // the last one is destroyed immediately because the reclaim queue is full
+  CASE_EXPECT_EQ(0, task_mgr->get_task_size());
+  CASE_EXPECT_EQ(3, task_mgr->get_reclaim_size());
+  CASE_EXPECT_EQ(1, destroy_count);
+
+  std::vector<cotask::task<>::ptr_t> detached;
+  CASE_EXPECT_EQ(1, task_mgr->detach_reclaim_batch(detached, 1));
+  CASE_EXPECT_EQ(2, task_mgr->get_reclaim_size());
+  CASE_EXPECT_EQ(1, destroy_count);
+  detached.clear();
+  CASE_EXPECT_EQ(2, destroy_count);
+
+  CASE_EXPECT_EQ(2, task_mgr->reclaim());
+  CASE_EXPECT_EQ(0, task_mgr->get_reclaim_size());
+  CASE_EXPECT_EQ(4, destroy_count);
+}
+
 CASE_TEST(coroutine_task_manager, kill) {
   typedef cotask::task<>::ptr_t task_ptr_type;
   task_ptr_type co_task = cotask::task<>::create(test_context_task_manager_action());
@@ -264,6 +342,452 @@ CASE_TEST(coroutine_task_manager, update_timeout) {
   CASE_EXPECT_EQ(2, g_test_coroutine_task_manager_status);
 }
 
+CASE_TEST(coroutine_task_manager, task_timer_wheel) {
+  // 4 slots and 2 levels, timers after 16 ticks will be put into overflow list
+  cotask::detail::task_timer_wheel<uint64_t> wheel(cotask::task_timer_wheel_config(1, 2, 2));
+  std::vector<cotask::detail::task_timer_wheel_node<uint64_t> *> nodes;
+  for (uint64_t i = 0; i < 64; ++i) {
+    nodes.push_back(wheel.insert(i, i * 3));
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(64), wheel.size());
+
+  // timers are relative to start time before started
+  wheel.start(10);
+  for (uint64_t i = 0; i < 64; i += 4) {
+    wheel.erase(nodes[i]);
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(48), wheel.size());
+
+  // all timers should expire exactly when now is greater than expired time
+  for (uint64_t now = 11; now <= 210; now += 7) {
+    wheel.advance(now);
+    cotask::detail::task_timer_wheel_node<uint64_t> *node;
+    while (nullptr != (node = wheel.front_expired())) {
+      CASE_EXPECT_TRUE(node->expired_nsec < now);
+      CASE_EXPECT_TRUE(node->expired_nsec + 7 >= now);
+      CASE_EXPECT_EQ(node->task_id * 3 + 10, node->expired_nsec);
+      CASE_EXPECT_NE(0, static_cast<int>(node->task_id % 4));
+      wheel.erase(node);
+    }
+    CASE_EXPECT_EQ(static_cast<size_t>(0), wheel.get_expired_size());
+  }
+  CASE_EXPECT_TRUE(wheel.empty());
+
+  // timers expired already
+  wheel.insert(100, 5);
+  CASE_EXPECT_EQ(static_cast<size_t>(1), wheel.get_expired_size());
+  wheel.clear();
+  CASE_EXPECT_TRUE(wheel.empty());
+  CASE_EXPECT_FALSE(wheel.is_started());
+}
+
+CASE_TEST(coroutine_task_manager, task_slot_map) {
+  using alloc_type = copp::util::uint64_slot_id_allocator;
+  using map_type = cotask::detail::task_slot_map<uint64_t, std::shared_ptr<int> >;
+  map_type slot_map;
+
+  std::vector<uint64_t> ids;
+  for (int i = 0; i < 2000; ++i) {
+    ids.push_back(alloc_type::allocate());
+    std::pair<map_type::iterator, bool> res =
+        slot_map.insert(map_type::value_type(ids.back(), std::make_shared<int>(i)));
+    CASE_EXPECT_TRUE(res.second);
+    CASE_EXPECT_EQ(i, *res.first->second);
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(2000), slot_map.size());
+  CASE_EXPECT_FALSE(slot_map.insert(map_type::value_type(ids[0], std::make_shared<int>(0))).second);
+
+  // ids not allocated by uint64_slot_id_allocator can not be inserted
+  CASE_EXPECT_FALSE(slot_map.insert(map_type::value_type(0xFFFFFFF0, std::make_shared<int>(0))).second);
+
+  for (size_t i = 0; i < ids.size(); i += 2) {
+    map_type::iterator iter = slot_map.find(ids[i]);
+    CASE_EXPECT_TRUE(iter != slot_map.end());
+    slot_map.erase(iter);
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(1000), slot_map.size());
+
+  // id with the same slot index but another generation must not be found
+  alloc_type::deallocate(ids[0]);
+  uint64_t reuse_id = alloc_type::allocate();
+  CASE_EXPECT_EQ(alloc_type::get_index(ids[0]), alloc_type::get_index(reuse_id));
+  CASE_EXPECT_TRUE(slot_map.end() == slot_map.find(ids[0]));
+  CASE_EXPECT_TRUE(slot_map.end() == slot_map.find(reuse_id));
+  CASE_EXPECT_TRUE(slot_map.insert(map_type::value_type(reuse_id, std::make_shared<int>(-1))).second);
+  ids[0] = reuse_id;
+
+  int sum = 0;
+  size_t count = 0;
+  for (const map_type::value_type &value : static_cast<const map_type &>(slot_map)) {
+    sum += *value.second;
+    ++count;
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(1001), count);
+  CASE_EXPECT_EQ(1000 * 1000 - 1, sum);
+
+  slot_map.clear();
+  CASE_EXPECT_TRUE(slot_map.empty());
+  CASE_EXPECT_TRUE(slot_map.begin() == slot_map.end());
+  for (uint64_t id : ids) {
+    alloc_type::deallocate(id);
+  }
+}
+
+CASE_TEST(coroutine_task_manager, timer_wheel) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  task_ptr_type co_task = cotask::task<>::create(test_context_task_manager_action());
+  task_ptr_type co_another_task = cotask::task<>::create(test_context_task_manager_action());  // share action
+
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config(0, 8, 4)));
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config(1, 16, 4)));
+  CASE_EXPECT_FALSE(task_mgr->is_timer_wheel_enabled());
+  // 1ms per slot
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+  CASE_EXPECT_TRUE(task_mgr->is_timer_wheel_enabled());
+
+  g_test_coroutine_task_manager_status = 0;
+  task_mgr->add_task(co_task, 5, 0);
+  task_mgr->add_task(co_another_task, 30, 0);
+  CASE_EXPECT_EQ(copp::COPP_EC_IS_RUNNING, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+  CASE_EXPECT_EQ(2, (int)task_mgr->get_tick_checkpoint_size());
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_checkpoints().size());
+
+  task_mgr->tick(3);
+  task_mgr->start(co_another_task->get_id());
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timeout(co_another_task->get_id(), 10, 0));
+
+  // tick reset timeout: 3 + 5 = 8, timeout tasks may be killed one granularity later
+  task_mgr->tick(8, 999999);
+  CASE_EXPECT_EQ(2, (int)task_mgr->get_task_size());
+  CASE_EXPECT_FALSE(cotask::EN_TS_TIMEOUT == co_task->get_status());
+
+  task_mgr->tick(8, 1000000);
+  CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+  CASE_EXPECT_EQ(1, (int)task_mgr->get_tick_checkpoint_size());
+  CASE_EXPECT_TRUE(cotask::EN_TS_TIMEOUT == co_task->get_status());
+
+  task_mgr->tick(13, 0);
+  CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+  task_mgr->tick(13, 1000000);
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_tick_checkpoint_size());
+  CASE_EXPECT_TRUE(cotask::EN_TS_TIMEOUT == co_another_task->get_status());
+  CASE_EXPECT_EQ(4, g_test_coroutine_task_manager_status);
+
+  // remove task also remove timer
+  task_ptr_type co_third_task = cotask::task<>::create(test_context_task_manager_action());
+  task_mgr->add_task(co_third_task, 1, 0);
+  CASE_EXPECT_EQ(1, (int)task_mgr->get_tick_checkpoint_size());
+  task_mgr->remove_task(co_third_task->get_id());
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_tick_checkpoint_size());
+  task_mgr->tick(20);
+  CASE_EXPECT_FALSE(cotask::EN_TS_TIMEOUT == co_third_task->get_status());
+}
+
+CASE_TEST(coroutine_task_manager, tick_with_max_expire) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+
+  for (int use_timer_wheel = 0; use_timer_wheel < 2; ++use_timer_wheel) {
+    mgr_t::ptr_t task_mgr = mgr_t::create();
+    if (use_timer_wheel) {
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+    }
+
+    std::vector<task_ptr_type> tasks;
+    for (int i = 0; i < 7; ++i) {
+      tasks.push_back(cotask::task<>::create(test_context_task_manager_action()));
+      task_mgr->add_task(tasks.back(), 5, 0);
+    }
+    task_ptr_type co_later_task = cotask::task<>::create(test_context_task_manager_action());
+    task_mgr->add_task(co_later_task, 20, 0);
+
+    size_t pending_count = 0;
+    task_mgr->tick(3, 0, 3, &pending_count);
+    CASE_EXPECT_EQ(static_cast<size_t>(0), pending_count);
+
+    // 3 + 5 = 8, kill at most 3 timeout tasks per tick
+    task_mgr->tick(9, 0, 3, &pending_count);
+    CASE_EXPECT_EQ(5, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(4), pending_count);
+
+    // the same time, continue to kill the rest timeout tasks
+    task_mgr->tick(9, 0, 3, &pending_count);
+    CASE_EXPECT_EQ(2, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(1), pending_count);
+
+    // 0 means just move the clock
+    task_mgr->tick(10, 0, 0, &pending_count);
+    CASE_EXPECT_EQ(2, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(1), pending_count);
+
+    task_mgr->tick(10, 0, 3, &pending_count);
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(0), pending_count);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_TRUE(cotask::EN_TS_TIMEOUT == tasks[i]->get_status());
+    }
+
+    // nothing left, tick at the same time do nothing
+    task_mgr->tick(10, 0, 3, &pending_count);
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+    CASE_EXPECT_FALSE(cotask::EN_TS_TIMEOUT == co_later_task->get_status());
+
+    task_mgr->tick(30);
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_TRUE(cotask::EN_TS_TIMEOUT == co_later_task->get_status());
+  }
+}
+
+static std::vector<int> g_test_coroutine_task_manager_ready_order;
+class test_context_task_manager_action_ready : public cotask::impl::task_action_impl {
+ public:
+  explicit test_context_task_manager_action_ready(int tag) : tag_(tag) {}
+
+  int operator()(void *) {
+    g_test_coroutine_task_manager_ready_order.push_back(tag_);
+    cotask::this_task::get_task()->yield();
+    g_test_coroutine_task_manager_ready_order.push_back(tag_);
+    return 0;
+  }
+
+ private:
+  int tag_;
+};
+
+CASE_TEST(coroutine_task_manager, ready_queue) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+  g_test_coroutine_task_manager_ready_order.clear();
+
+  std::vector<task_ptr_type> tasks;
+  for (int i = 0; i < 4; ++i) {
+    tasks.push_back(cotask::task<>::create(test_context_task_manager_action_ready(i)));
+    task_mgr->add_task(tasks.back());
+  }
+
+  CASE_EXPECT_EQ(copp::COPP_EC_NOT_FOUND, task_mgr->mark_ready(0));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[2]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[0]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[3]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[1]->get_id()));
+  // mark ready again do nothing
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[2]->get_id()));
+  CASE_EXPECT_EQ(static_cast<size_t>(4), task_mgr->get_ready_size());
+
+  // removed task is also removed from ready queue
+  task_mgr->remove_task(tasks[3]->get_id());
+  CASE_EXPECT_EQ(static_cast<size_t>(3), task_mgr->get_ready_size());
+
+  // FIFO
+  CASE_EXPECT_EQ(static_cast<size_t>(2), task_mgr->run_ready(2));
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_ready_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), g_test_coroutine_task_manager_ready_order.size());
+  if (g_test_coroutine_task_manager_ready_order.size() >= 2) {
+    CASE_EXPECT_EQ(2, g_test_coroutine_task_manager_ready_order[0]);
+    CASE_EXPECT_EQ(0, g_test_coroutine_task_manager_ready_order[1]);
+  }
+
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[2]->get_id()));
+  CASE_EXPECT_EQ(static_cast<size_t>(2), task_mgr->run_ready());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_ready_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(4), g_test_coroutine_task_manager_ready_order.size());
+  if (g_test_coroutine_task_manager_ready_order.size() >= 4) {
+    CASE_EXPECT_EQ(1, g_test_coroutine_task_manager_ready_order[2]);
+    CASE_EXPECT_EQ(2, g_test_coroutine_task_manager_ready_order[3]);
+  }
+
+  // finished task is removed
+  CASE_EXPECT_TRUE(tasks[2]->is_completed());
+  CASE_EXPECT_EQ(2, (int)task_mgr->get_task_size());
+
+  // timeout task is also removed from ready queue
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timeout(tasks[0]->get_id(), 1, 0));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[0]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[1]->get_id()));
+  task_mgr->tick(3);
+  task_mgr->tick(5);
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_ready_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->run_ready());
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+}
+
+CASE_TEST(coroutine_task_manager, ready_class) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+  g_test_coroutine_task_manager_ready_order.clear();
+
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_ready_class_count());
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->set_ready_class_weights(std::vector<uint32_t>()));
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->set_ready_class_weights(std::vector<uint32_t>{3, 0}));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_ready_class_weights(std::vector<uint32_t>{3, 1}));
+  CASE_EXPECT_EQ(static_cast<size_t>(2), task_mgr->get_ready_class_count());
+
+  // background tasks are marked ready first
+  std::vector<task_ptr_type> tasks;
+  for (int i = 0; i < 8; ++i) {
+    tasks.push_back(cotask::task<>::create(test_context_task_manager_action_ready(100 + i)));
+    // unknown class will be put into the last class
+    task_mgr->add_task(tasks.back(), 0, 0, 1 + static_cast<uint32_t>(i & 1));
+    task_mgr->mark_ready(tasks.back()->get_id());
+  }
+  for (int i = 0; i < 6; ++i) {
+    tasks.push_back(cotask::task<>::create(test_context_task_manager_action_ready(i)));
+    task_mgr->add_task(tasks.back(), 0, 0, 0);
+    task_mgr->mark_ready(tasks.back()->get_id());
+  }
+  CASE_EXPECT_EQ(copp::COPP_EC_IS_RUNNING, task_mgr->set_ready_class_weights(std::vector<uint32_t>{1}));
+  CASE_EXPECT_EQ(static_cast<size_t>(6), task_mgr->get_ready_class_stats(0).ready_size);
+  CASE_EXPECT_EQ(static_cast<size_t>(8), task_mgr->get_ready_class_stats(1).ready_size);
+
+  CASE_EXPECT_EQ(static_cast<size_t>(8), task_mgr->run_ready(8));
+  int expect_order[] = {0, 1, 2, 100, 3, 4, 5, 101};
+  CASE_EXPECT_EQ(static_cast<size_t>(8), g_test_coroutine_task_manager_ready_order.size());
+  for (size_t i = 0; i < 8 && i < g_test_coroutine_task_manager_ready_order.size(); ++i) {
+    CASE_EXPECT_EQ(expect_order[i], g_test_coroutine_task_manager_ready_order[i]);
+  }
+
+  cotask::task_manager_ready_class_stats stats = task_mgr->get_ready_class_stats(0);
+  CASE_EXPECT_EQ(3, (int)stats.weight);
+  CASE_EXPECT_EQ(static_cast<size_t>(0), stats.ready_size);
+  CASE_EXPECT_EQ(6, (int)stats.mark_count);
+  CASE_EXPECT_EQ(6, (int)stats.run_count);
+  stats = task_mgr->get_ready_class_stats(1);
+  CASE_EXPECT_EQ(static_cast<size_t>(6), stats.ready_size);
+  CASE_EXPECT_EQ(8, (int)stats.mark_count);
+  CASE_EXPECT_EQ(2, (int)stats.run_count);
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_ready_class_stats(2).weight);
+
+  // move to high priority class
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_ready_class(tasks[7]->get_id(), 0));
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->run_ready(1));
+  CASE_EXPECT_EQ(107, g_test_coroutine_task_manager_ready_order.back());
+
+  CASE_EXPECT_EQ(static_cast<size_t>(5), task_mgr->run_ready());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_ready_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(14), g_test_coroutine_task_manager_ready_order.size());
+  task_mgr->reset();
+}
+
+class test_context_task_manager_action_remote_resume : public cotask::impl::task_action_impl {
+ public:
+  test_context_task_manager_action_remote_resume(int yield_times, int *resume_sum)
+      : yield_times_(yield_times), resume_sum_(resume_sum) {}
+
+  int operator()(void *) {
+    for (int i = 0; i < yield_times_; ++i) {
+      void *priv_data = nullptr;
+      cotask::this_task::get_task()->yield(&priv_data);
+      if (nullptr != priv_data) {
+        *resume_sum_ += *reinterpret_cast<int *>(priv_data);
+      }
+    }
+    return 0;
+  }
+
+ private:
+  int yield_times_;
+  int *resume_sum_;
+};
+
+CASE_TEST(coroutine_task_manager, remote_resume) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+
+  int resume_sum = 0;
+  int resume_value = 3;
+  task_ptr_type co_task = cotask::task<>::create(test_context_task_manager_action_remote_resume(8, &resume_sum));
+  task_mgr->add_task(co_task);
+  task_mgr->start(co_task->get_id());
+
+  CASE_EXPECT_EQ(copp::COPP_EC_NOT_INITED, task_mgr->post_remote_resume(co_task->get_id()));
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->drain_remote_resume());
+  CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->init_remote_resume_queue(0));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->init_remote_resume_queue(4));
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_INITED, task_mgr->init_remote_resume_queue(4));
+
+  for (int i = 0; i < 4; ++i) {
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->post_remote_resume(co_task->get_id(), &resume_value));
+  }
+  CASE_EXPECT_EQ(copp::COPP_EC_QUEUE_FULL, task_mgr->post_remote_resume(co_task->get_id(), &resume_value));
+  CASE_EXPECT_EQ(static_cast<size_t>(4), task_mgr->get_remote_resume_size());
+
+  CASE_EXPECT_EQ(static_cast<size_t>(3), task_mgr->drain_remote_resume(3));
+  CASE_EXPECT_EQ(9, resume_sum);
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_remote_resume_size());
+
+  // requests of unknown tasks are just dropped
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->post_remote_resume(0, &resume_value));
+  CASE_EXPECT_EQ(static_cast<size_t>(2), task_mgr->drain_remote_resume());
+  CASE_EXPECT_EQ(12, resume_sum);
+
+  // pending requests are dropped by reset
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->post_remote_resume(co_task->get_id(), &resume_value));
+  task_mgr->reset();
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_remote_resume_size());
+  CASE_EXPECT_TRUE(co_task->is_completed());
+  CASE_EXPECT_EQ(12, resume_sum);
+}
+
+CASE_TEST(coroutine_task_manager, remote_resume_mt) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager<cotask::task<> > mgr_t;
+  mgr_t::ptr_t task_mgr = mgr_t::create();
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->init_remote_resume_queue(64));
+
+  const int task_count = 4;
+  const int thread_count = 2;
+  const int resume_times = 1000;
+  int resume_sums[task_count] = {0};
+  int resume_value = 1;
+  std::vector<task_ptr_type> tasks;
+  for (int i = 0; i < task_count; ++i) {
+    tasks.push_back(cotask::task<>::create(
+        test_context_task_manager_action_remote_resume(thread_count * resume_times, &resume_sums[i]), 16 * 1024));
+    task_mgr->add_task(tasks.back());
+    task_mgr->start(tasks.back()->get_id());
+  }
+
+  // like completions of jobs in a thread pool, tasks are only resumed by this thread
+  std::unique_ptr<std::thread> thds[thread_count];
+  for (int i = 0; i < thread_count; ++i) {
+    thds[i].reset(new std::thread([&task_mgr, &tasks, &resume_value, resume_times]() {
+      for (int j = 0; j < resume_times; ++j) {
+        for (size_t k = 0; k < tasks.size(); ++k) {
+          while (copp::COPP_EC_QUEUE_FULL == task_mgr->post_remote_resume(tasks[k]->get_id(), &resume_value)) {
+            std::this_thread::yield();
+          }
+        }
+      }
+    }));
+  }
+
+  size_t drain_count = 0;
+  while (drain_count < static_cast<size_t>(task_count * thread_count * resume_times)) {
+    size_t count = task_mgr->drain_remote_resume();
+    if (0 == count) {
+      std::this_thread::yield();
+    }
+    drain_count += count;
+  }
+
+  for (int i = 0; i < thread_count; ++i) {
+    thds[i]->join();
+  }
+
+  CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+  for (int i = 0; i < task_count; ++i) {
+    CASE_EXPECT_TRUE(tasks[static_cast<size_t>(i)]->is_completed());
+    CASE_EXPECT_EQ(thread_count * resume_times, resume_sums[i]);
+  }
+}
+
 class test_context_task_manager_action_protect_this_task : public cotask::impl::task_action_impl {
  public:
   int operator()(void *) {
@@ -388,6 +912,98 @@ CASE_TEST(coroutine_task_manager, create_and_run_mt) {
                  g_test_coroutine_task_manager_atomic.load());
 }
 
+CASE_TEST(coroutine_task_manager, sharded) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  typedef cotask::task_manager_sharded<cotask::task<> > mgr_t;
+  mgr_t::ptr_type task_mgr = mgr_t::create(4);
+  CASE_EXPECT_EQ(static_cast<size_t>(4), task_mgr->get_shard_count());
+
+  g_test_coroutine_task_manager_status = 0;
+  std::vector<task_ptr_type> tasks;
+  for (int i = 0; i < 64; ++i) {
+    tasks.push_back(cotask::task<>::create(test_context_task_manager_action()));
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->add_task(tasks.back(), 5, 0));
+  }
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_EXIST, task_mgr->add_task(tasks[0]));
+  CASE_EXPECT_EQ(static_cast<size_t>(64), task_mgr->get_task_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(64), task_mgr->get_tick_checkpoint_size());
+
+  // tasks should be spread into all shards
+  for (size_t i = 0; i < task_mgr->get_shard_count(); ++i) {
+    CASE_EXPECT_GT(task_mgr->get_shard(i).get_task_size(), static_cast<size_t>(0));
+  }
+
+  CASE_EXPECT_EQ(tasks[1], task_mgr->find_task(tasks[1]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->start(tasks[1]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->resume(tasks[1]->get_id()));
+  CASE_EXPECT_EQ(2, g_test_coroutine_task_manager_status);
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->kill(tasks[2]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->remove_task(tasks[3]->get_id()));
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timeout(tasks[4]->get_id(), 10, 0));
+  CASE_EXPECT_EQ(static_cast<size_t>(61), task_mgr->get_task_size());
+
+  task_mgr->tick(10);
+  task_mgr->tick(15, 1);
+  CASE_EXPECT_EQ(15, static_cast<int>(task_mgr->get_last_tick_time().tv_sec));
+  CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_task_size());
+  CASE_EXPECT_EQ(cotask::EN_TS_TIMEOUT, tasks[0]->get_status());
+  CASE_EXPECT_EQ(cotask::EN_TS_KILLED, tasks[2]->get_status());
+  CASE_EXPECT_EQ(cotask::EN_TS_CREATED, tasks[4]->get_status());
+
+  task_mgr->tick(20, 1);
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_task_size());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_tick_checkpoint_size());
+  CASE_EXPECT_EQ(cotask::EN_TS_TIMEOUT, tasks[4]->get_status());
+
+  // timing wheel can be set for all shards when they are empty
+  CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+  CASE_EXPECT_TRUE(task_mgr->is_timer_wheel_enabled());
+}
+
+struct test_context_task_manager_sharded_mt_thread_runner {
+  typedef cotask::task_manager_sharded<cotask::task<> > mgr_t;
+  int run_count;
+  mgr_t::ptr_type task_mgr;
+  explicit test_context_task_manager_sharded_mt_thread_runner(mgr_t::ptr_type mgr) : run_count(0), task_mgr(mgr) {}
+
+  int operator()() {
+    typedef cotask::task<>::ptr_t task_ptr_type;
+
+    task_ptr_type co_task =
+        cotask::task<>::create(test_context_task_manager_action_mt_thread(), 16 * 1024);  // use 16KB for stack
+    cotask::task<>::id_t task_id = co_task->get_id();
+    task_mgr->add_task(co_task);
+
+    task_mgr->start(task_id, &run_count);
+
+    while (false == co_task->is_completed()) {
+      task_mgr->resume(task_id, &run_count);
+    }
+
+    CASE_EXPECT_EQ(test_context_task_manager_action_mt_run_times, run_count);
+    return 0;
+  }
+};
+
+CASE_TEST(coroutine_task_manager, sharded_create_and_run_mt) {
+  typedef cotask::task_manager_sharded<cotask::task<> > mgr_t;
+  mgr_t::ptr_type task_mgr = mgr_t::create(8);
+
+  g_test_coroutine_task_manager_atomic.store(0);
+
+  std::unique_ptr<std::thread> thds[64];
+  for (int i = 0; i < 64; ++i) {
+    thds[i].reset(new std::thread(test_context_task_manager_sharded_mt_thread_runner(task_mgr)));
+  }
+
+  for (int i = 0; i < 64; ++i) {
+    thds[i]->join();
+  }
+
+  CASE_EXPECT_EQ(test_context_task_manager_action_mt_run_times * 64, g_test_coroutine_task_manager_atomic.load());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_task_size());
+}
+
 #  if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
 CASE_TEST(coroutine_task_manager, auto_cleanup_for_manager) {
   typedef cotask::task<>::ptr_t task_ptr_type;
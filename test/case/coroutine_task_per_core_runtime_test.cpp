@@ -0,0 +1,235 @@
+// Copyright 2023 owent
+
+#include <libcotask/task.h>
+#include <libcotask/task_per_core_runtime.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "frame/test_macros.h"
+
+#if defined(LIBCOTASK_MACRO_ENABLED) && LIBCOTASK_MACRO_ENABLE_TASK_PER_CORE_RUNTIME
+
+using test_task_per_core_runtime_type = cotask::task_per_core_runtime<>;
+
+CASE_TEST(coroutine_task_per_core_runtime, bounded_mailbox_st) {
+  cotask::detail::task_bounded_mailbox<int> mailbox(5);
+  CASE_EXPECT_EQ(static_cast<size_t>(8), mailbox.capacity());
+  CASE_EXPECT_TRUE(mailbox.empty());
+
+  int value = 0;
+  CASE_EXPECT_FALSE(mailbox.try_pop(value));
+  for (int i = 0; i < 8; ++i) {
+    CASE_EXPECT_TRUE(mailbox.try_push(static_cast<int>(i)));
+  }
+  CASE_EXPECT_FALSE(mailbox.try_push(8));
+  CASE_EXPECT_EQ(static_cast<size_t>(8), mailbox.size());
+
+  // FIFO, and slots are reused after pop
+  for (int i = 0; i < 4; ++i) {
+    CASE_EXPECT_TRUE(mailbox.try_pop(value));
+    CASE_EXPECT_EQ(i, value);
+  }
+  for (int i = 8; i < 12; ++i) {
+    CASE_EXPECT_TRUE(mailbox.try_push(static_cast<int>(i)));
+  }
+  for (int i = 4; i < 12; ++i) {
+    CASE_EXPECT_TRUE(mailbox.try_pop(value));
+    CASE_EXPECT_EQ(i, value);
+  }
+  CASE_EXPECT_FALSE(mailbox.try_pop(value));
+}
+
+CASE_TEST(coroutine_task_per_core_runtime, bounded_mailbox_mpsc) {
+  cotask::detail::task_bounded_mailbox<size_t> mailbox(64);
+  const size_t producer_count = 3;
+  const size_t value_count = 30000;
+  std::vector<int> received;
+  received.resize(producer_count * value_count, 0);
+
+  std::unique_ptr<std::thread> producers[producer_count];
+  for (size_t i = 0; i < producer_count; ++i) {
+    producers[i].reset(new std::thread([&mailbox, i, value_count]() {
+      for (size_t j = 0; j < value_count; ++j) {
+        while (!mailbox.try_push(i * value_count + j)) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+
+  size_t value = 0;
+  size_t received_count = 0;
+  while (received_count < producer_count * value_count) {
+    if (mailbox.try_pop(value)) {
+      ++received[value];
+      ++received_count;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for (size_t i = 0; i < producer_count; ++i) {
+    producers[i]->join();
+  }
+
+  size_t bad_count = 0;
+  for (size_t i = 0; i < received.size(); ++i) {
+    if (1 != received[i]) {
+      ++bad_count;
+    }
+  }
+  CASE_EXPECT_EQ(static_cast<size_t>(0), bad_count);
+}
+
+namespace {
+struct test_task_per_core_runtime_context {
+  std::atomic<int> ready_count;
+  std::atomic<int> finished_count;
+  std::atomic<int> error_count;
+  std::atomic<int> ping_count;
+  std::atomic<int> pong_count;
+  test_task_per_core_runtime_type::id_type ping_id;
+  test_task_per_core_runtime_type::id_type pong_id;
+
+  test_task_per_core_runtime_context()
+      : ready_count(0), finished_count(0), error_count(0), ping_count(0), pong_count(0), ping_id(0), pong_id(0) {}
+};
+
+static void test_task_per_core_runtime_wait(std::atomic<int> &counter, int expect) {
+  for (int i = 0; i < 100000 && counter.load() < expect; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+}  // namespace
+
+CASE_TEST(coroutine_task_per_core_runtime, ping_pong) {
+  test_task_per_core_runtime_type::ptr_type runtime = test_task_per_core_runtime_type::create(2, 16);
+  CASE_EXPECT_EQ(static_cast<size_t>(2), runtime->get_core_count());
+  CASE_EXPECT_TRUE(nullptr == test_task_per_core_runtime_type::this_core());
+  CASE_EXPECT_EQ(0, runtime->start());
+  CASE_EXPECT_EQ(copp::COPP_EC_ALREADY_INITED, runtime->start());
+
+  test_task_per_core_runtime_context context;
+  const int round_count = 1000;
+
+  // pong task on core 1 waits first
+  CASE_EXPECT_TRUE(runtime->try_post(1, [&context, round_count](test_task_per_core_runtime_type::core_type &core) {
+    if (test_task_per_core_runtime_type::this_core() != &core || 1 != core.get_index()) {
+      ++context.error_count;
+    }
+
+    test_task_per_core_runtime_type::task_ptr_type task_inst = core.create_task(
+        [&context, &core, round_count](void *) {
+          for (int i = 0; i < round_count; ++i) {
+            cotask::this_task::get_task()->yield();
+            if (test_task_per_core_runtime_type::this_core() != &core) {
+              ++context.error_count;
+            }
+            ++context.pong_count;
+            if (!core.get_runtime().try_post_resume(0, context.ping_id)) {
+              ++context.error_count;
+            }
+          }
+          ++context.finished_count;
+          return 0;
+        },
+        16 * 1024);
+    context.pong_id = task_inst->get_id();
+    // stack is allocated from the pool of this core
+    if (1 != core.get_stack_pool()->get_limit().used_stack_number) {
+      ++context.error_count;
+    }
+    core.get_task_manager().add_task(task_inst);
+    core.get_task_manager().start(task_inst->get_id());
+    ++context.ready_count;
+  }));
+  test_task_per_core_runtime_wait(context.ready_count, 1);
+  CASE_EXPECT_EQ(1, context.ready_count.load());
+
+  // ping task on core 0
+  CASE_EXPECT_TRUE(runtime->try_post(0, [&context, round_count](test_task_per_core_runtime_type::core_type &core) {
+    test_task_per_core_runtime_type::task_ptr_type task_inst = core.create_task(
+        [&context, &core, round_count](void *) {
+          for (int i = 0; i < round_count; ++i) {
+            ++context.ping_count;
+            if (!core.get_runtime().try_post_resume(1, context.pong_id)) {
+              ++context.error_count;
+            }
+            cotask::this_task::get_task()->yield();
+          }
+          ++context.finished_count;
+          return 0;
+        },
+        16 * 1024);
+    context.ping_id = task_inst->get_id();
+    // stack is allocated from the pool of this core
+    if (1 != core.get_stack_pool()->get_limit().used_stack_number) {
+      ++context.error_count;
+    }
+    core.get_task_manager().add_task(task_inst);
+    core.get_task_manager().start(task_inst->get_id());
+  }));
+
+  test_task_per_core_runtime_wait(context.finished_count, 2);
+  CASE_EXPECT_EQ(2, context.finished_count.load());
+  CASE_EXPECT_EQ(round_count, context.ping_count.load());
+  CASE_EXPECT_EQ(round_count, context.pong_count.load());
+  CASE_EXPECT_EQ(0, context.error_count.load());
+
+  CASE_EXPECT_FALSE(runtime->try_post(2, [](test_task_per_core_runtime_type::core_type &) {}));
+  CASE_EXPECT_FALSE(runtime->try_post_resume(2, context.ping_id));
+
+  runtime->stop();
+  CASE_EXPECT_FALSE(runtime->is_running());
+}
+
+CASE_TEST(coroutine_task_per_core_runtime, timeout) {
+  test_task_per_core_runtime_type::ptr_type runtime = test_task_per_core_runtime_type::create(1);
+  test_task_per_core_runtime_context context;
+
+  // messages posted before start are handled after start
+  CASE_EXPECT_TRUE(runtime->try_post(0, [&context](test_task_per_core_runtime_type::core_type &core) {
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    test_task_per_core_runtime_type::task_ptr_type task_inst = core.create_task(
+        [&context, start_time](void *) {
+          cotask::this_task::get_task()->yield();
+          // timeout is 1ms after the task is added
+          if (cotask::this_task::get_task()->is_timeout() &&
+              std::chrono::steady_clock::now() - start_time >= std::chrono::microseconds(500)) {
+            ++context.finished_count;
+          }
+          return 0;
+        },
+        16 * 1024);
+    core.get_task_manager().add_task(task_inst, 0, 1000000);
+    core.get_task_manager().start(task_inst->get_id());
+    ++context.ready_count;
+  }));
+  CASE_EXPECT_EQ(0, runtime->start(false));
+  CASE_EXPECT_FALSE(runtime->get_core(0).is_pinned());
+
+  test_task_per_core_runtime_wait(context.ready_count, 1);
+  CASE_EXPECT_EQ(1, context.ready_count.load());
+
+  // task_manager can only be accessed by its core
+  context.pong_count.store(1);
+  for (int i = 1; i <= 1000 && context.pong_count.load() > 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CASE_EXPECT_TRUE(runtime->try_post(0, [&context](test_task_per_core_runtime_type::core_type &core) {
+      context.pong_count.store(static_cast<int>(core.get_task_manager().get_task_size()));
+      ++context.ping_count;
+    }));
+    test_task_per_core_runtime_wait(context.ping_count, i);
+  }
+  CASE_EXPECT_EQ(0, context.pong_count.load());
+  CASE_EXPECT_EQ(1, context.finished_count.load());
+}
+
+#endif
@@ -7,8 +7,10 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <list>
 #include <memory>
 #include <set>
+#include <stdexcept>
 #include <vector>
 
 #include "frame/test_macros.h"
@@ -369,6 +371,185 @@ CASE_TEST(coroutine_task, next) {
   }
 }
 
+CASE_TEST(coroutine_task, next_multiple_continuations) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  std::vector<int> run_order;
+  int priv_data[5] = {0, 1, 2, 3, 4};
+
+  task_ptr_type co_task = cotask::task<>::create([](void *) {
+    cotask::this_task::get_task()->yield();
+    return 0;
+  });
+
+  // the first continuation is stored inline, others are spilled
+  std::vector<task_ptr_type> next_tasks;
+  for (int i = 0; i < 5; ++i) {
+    next_tasks.push_back(cotask::task<>::create([&run_order](void *priv) {
+      run_order.push_back(*reinterpret_cast<int *>(priv));
+      return 0;
+    }));
+    CASE_EXPECT_EQ(next_tasks.back(), co_task->next(next_tasks.back(), &priv_data[i]));
+  }
+
+  CASE_EXPECT_EQ(0, co_task->start());
+  CASE_EXPECT_TRUE(run_order.empty());
+  CASE_EXPECT_EQ(0, co_task->resume());
+  CASE_EXPECT_TRUE(co_task->is_completed());
+
+  // continuations run in the order they were added
+  CASE_EXPECT_EQ(static_cast<size_t>(5), run_order.size());
+  for (size_t i = 0; i < run_order.size(); ++i) {
+    CASE_EXPECT_EQ(static_cast<int>(i), run_order[i]);
+    CASE_EXPECT_TRUE(next_tasks[i]->is_completed());
+  }
+
+  // continuations of released task which is not started are also triggered
+  run_order.clear();
+  co_task = cotask::task<>::create([](void *) { return 0; });
+  for (int i = 0; i < 3; ++i) {
+    task_ptr_type next_task = cotask::task<>::create([&run_order](void *priv) {
+      run_order.push_back(*reinterpret_cast<int *>(priv));
+      return 0;
+    });
+    co_task->next(next_task, &priv_data[i]);
+  }
+  co_task.reset();
+  CASE_EXPECT_EQ(static_cast<size_t>(3), run_order.size());
+}
+
+#  if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+static void test_context_task_finish_callback_order(void *callback_data, cotask::task<> &,
+                                                    cotask::unhandled_exception_list &) {
+#  else
+static void test_context_task_finish_callback_order(void *callback_data, cotask::task<> &) {
+#  endif
+  reinterpret_cast<std::vector<int> *>(callback_data)->push_back(-1);
+}
+
+CASE_TEST(coroutine_task, finish_callback_order) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  std::vector<int> run_order;
+  int priv_data[2] = {0, 1};
+
+  task_ptr_type co_task = cotask::task<>::create([](void *) {
+    cotask::this_task::get_task()->yield();
+    return 0;
+  });
+
+  // the callback is added first, next tasks added later must not run before it
+  CASE_EXPECT_EQ(0, co_task->add_finish_callback(test_context_task_finish_callback_order, &run_order));
+  for (int i = 0; i < 2; ++i) {
+    task_ptr_type next_task = cotask::task<>::create([&run_order](void *priv) {
+      run_order.push_back(*reinterpret_cast<int *>(priv));
+      return 0;
+    });
+    co_task->next(next_task, &priv_data[i]);
+  }
+
+  CASE_EXPECT_EQ(0, co_task->start());
+  CASE_EXPECT_EQ(0, co_task->resume());
+  CASE_EXPECT_TRUE(co_task->is_completed());
+
+  CASE_EXPECT_EQ(static_cast<size_t>(3), run_order.size());
+  if (run_order.size() == 3) {
+    CASE_EXPECT_EQ(-1, run_order[0]);
+    CASE_EXPECT_EQ(0, run_order[1]);
+    CASE_EXPECT_EQ(1, run_order[2]);
+  }
+}
+
+#  if defined(LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR) && LIBCOPP_MACRO_ENABLE_STD_EXCEPTION_PTR
+CASE_TEST(coroutine_task, unhandled_exception_list) {
+  cotask::unhandled_exception_list eptrs;
+  CASE_EXPECT_TRUE(eptrs.empty());
+  CASE_EXPECT_TRUE(eptrs.begin() == eptrs.end());
+
+  // empty exception_ptr is ignored
+  eptrs.push_back(std::exception_ptr());
+  CASE_EXPECT_EQ(static_cast<size_t>(0), eptrs.size());
+
+  for (int i = 0; i < 3; ++i) {
+    eptrs.push_back(std::make_exception_ptr(i));
+    CASE_EXPECT_EQ(static_cast<size_t>(i + 1), eptrs.size());
+  }
+
+  int expect_value = 0;
+  for (cotask::unhandled_exception_list::iterator iter = eptrs.begin(); iter != eptrs.end(); ++iter) {
+    try {
+      std::rethrow_exception(*iter);
+    } catch (int value) {
+      CASE_EXPECT_EQ(expect_value, value);
+    }
+    ++expect_value;
+  }
+  CASE_EXPECT_EQ(3, expect_value);
+
+  cotask::unhandled_exception_list other;
+  other.push_back(std::make_exception_ptr(3));
+  eptrs.append(other);
+  CASE_EXPECT_TRUE(other.empty());
+  CASE_EXPECT_EQ(static_cast<size_t>(4), eptrs.size());
+
+  other.swap(eptrs);
+  CASE_EXPECT_TRUE(eptrs.empty());
+  CASE_EXPECT_EQ(static_cast<size_t>(4), other.size());
+  other.clear();
+  CASE_EXPECT_TRUE(other.empty());
+}
+
+CASE_TEST(coroutine_task, collect_unhandled_exception) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  task_ptr_type co_task = cotask::task<>::create([](void *) -> int { throw std::runtime_error("task failed"); });
+
+  // exceptions of the task and its continuation are collected
+  task_ptr_type next_task = cotask::task<>::create([](void *) -> int { throw std::logic_error("next failed"); });
+  co_task->next(next_task);
+
+  cotask::unhandled_exception_list eptrs;
+  co_task->start(eptrs, nullptr);
+  CASE_EXPECT_TRUE(co_task->is_completed());
+  CASE_EXPECT_TRUE(next_task->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(2), eptrs.size());
+
+  bool has_runtime_error = false;
+  bool has_logic_error = false;
+  for (cotask::unhandled_exception_list::iterator iter = eptrs.begin(); iter != eptrs.end(); ++iter) {
+    try {
+      std::rethrow_exception(*iter);
+    } catch (const std::runtime_error &) {
+      has_runtime_error = true;
+    } catch (const std::logic_error &) {
+      has_logic_error = true;
+    }
+  }
+  CASE_EXPECT_TRUE(has_runtime_error);
+  CASE_EXPECT_TRUE(has_logic_error);
+}
+
+CASE_TEST(coroutine_task, collect_unhandled_exception_by_std_list) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  task_ptr_type co_task = cotask::task<>::create([](void *) -> int {
+    cotask::this_task::get_task()->yield();
+    throw std::runtime_error("task failed");
+  });
+
+  // APIs of old versions with std::list are still available
+  std::list<std::exception_ptr> eptrs;
+  CASE_EXPECT_EQ(0, co_task->start(eptrs, nullptr));
+  CASE_EXPECT_TRUE(eptrs.empty());
+  co_task->resume(eptrs, nullptr);
+  CASE_EXPECT_TRUE(co_task->is_completed());
+  CASE_EXPECT_EQ(static_cast<size_t>(1), eptrs.size());
+  bool has_runtime_error = false;
+  try {
+    cotask::task<>::maybe_rethrow(eptrs);
+  } catch (const std::runtime_error &) {
+    has_runtime_error = true;
+  }
+  CASE_EXPECT_TRUE(has_runtime_error);
+}
+#  endif
+
 struct test_context_task_functor_drived : public cotask::impl::task_action_impl {
  public:
   int a_;
@@ -416,6 +597,90 @@ CASE_TEST(coroutine_task, priavte_buffer) {
   CASE_EXPECT_EQ(0, co_task->start());
 }
 
+namespace {
+struct alignas(64) test_context_task_private_data {
+  int value;
+  int *destroy_count;
+
+  test_context_task_private_data(int v, int *c) : value(v), destroy_count(c) {}
+  ~test_context_task_private_data() { ++(*destroy_count); }
+};
+}  // namespace
+
+CASE_TEST(coroutine_task, private_data) {
+  int destroy_count = 0;
+  int value = 0;
+  {
+    cotask::task<>::ptr_t co_task = cotask::task<>::create_with_private_data<test_context_task_private_data>(
+        [&value](void *) {
+          CASE_EXPECT_TRUE(nullptr == cotask::this_task::get_private_data<char[4096]>());
+          test_context_task_private_data *private_data =
+              cotask::this_task::get_private_data<test_context_task_private_data>();
+          CASE_EXPECT_TRUE(nullptr != private_data);
+          if (nullptr != private_data) {
+            value = private_data->value;
+          }
+          return 0;
+        },
+        16384, 123, &destroy_count);
+    CASE_EXPECT_TRUE(!!co_task);
+
+    test_context_task_private_data *private_data = co_task->get_private_data<test_context_task_private_data>();
+    CASE_EXPECT_TRUE(nullptr != private_data);
+    CASE_EXPECT_EQ(0, reinterpret_cast<uintptr_t>(private_data) % 64);
+    CASE_EXPECT_EQ(0, co_task->start());
+    CASE_EXPECT_EQ(123, value);
+    CASE_EXPECT_EQ(0, destroy_count);
+  }
+
+  CASE_EXPECT_TRUE(nullptr == cotask::this_task::get_private_data<test_context_task_private_data>());
+  CASE_EXPECT_EQ(1, destroy_count);
+}
+
+static int test_context_task_resume_batch(void *) {
+  ++g_test_coroutine_task_status;
+  cotask::task<>::this_task()->yield();
+  ++g_test_coroutine_task_status;
+  return 0;
+}
+
+CASE_TEST(coroutine_task, resume_batch) {
+  typedef cotask::task<>::ptr_t task_ptr_type;
+  g_test_coroutine_task_status = 0;
+
+  std::vector<task_ptr_type> tasks;
+  std::vector<cotask::task<> *> batch;
+  for (int i = 0; i < 8; ++i) {
+    tasks.push_back(cotask::task<>::create(test_context_task_resume_batch, 16384));
+    batch.push_back(tasks.back().get());
+  }
+  std::vector<int> ret_codes;
+  ret_codes.resize(batch.size(), 0);
+
+  // created tasks will be started
+  CASE_EXPECT_EQ(batch.size(), cotask::task<>::resume_batch(batch, ret_codes));
+  CASE_EXPECT_EQ(8, g_test_coroutine_task_status);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    CASE_EXPECT_EQ(0, ret_codes[i]);
+    CASE_EXPECT_EQ(cotask::EN_TS_WAITING, tasks[i]->get_status());
+  }
+
+  tasks[3]->kill();
+  CASE_EXPECT_EQ(9, g_test_coroutine_task_status);
+
+  CASE_EXPECT_EQ(batch.size() - 1, cotask::task<>::resume_batch(batch, ret_codes));
+  CASE_EXPECT_EQ(16, g_test_coroutine_task_status);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (3 == i) {
+      CASE_EXPECT_EQ(LIBCOPP_COPP_NAMESPACE_ID::COPP_EC_ALREADY_FINISHED, ret_codes[i]);
+      CASE_EXPECT_EQ(cotask::EN_TS_KILLED, tasks[i]->get_status());
+    } else {
+      CASE_EXPECT_EQ(0, ret_codes[i]);
+      CASE_EXPECT_EQ(cotask::EN_TS_DONE, tasks[i]->get_status());
+    }
+  }
+}
+
 static int test_context_task_timeout(void *) {
   cotask::task<>::this_task()->yield();
 
@@ -11,6 +11,7 @@
 #include "frame/test_macros.h"
 
 #include "libcopp/utils/uint64_id_allocator.h"
+#include "libcopp/utils/uint64_slot_id_allocator.h"
 
 CASE_TEST(coroutine_task, id_allocator_st) {
   copp::util::uint64_id_allocator alloc;
@@ -59,3 +60,87 @@ CASE_TEST(coroutine_task, id_allocator_mt) {
 
   CASE_EXPECT_EQ(id_num, s[0].size());
 }
+
+CASE_TEST(coroutine_task, slot_id_allocator) {
+  using alloc_type = copp::util::uint64_slot_id_allocator;
+  size_t id_num = 3 * (1 << 8) + 100;
+  std::set<uint64_t> s;
+  std::set<uint32_t> indexes;
+
+  for (size_t i = 0; i < id_num; ++i) {
+    uint64_t id = alloc_type::allocate();
+    CASE_EXPECT_NE(static_cast<uint64_t>(0), id);
+    CASE_EXPECT_TRUE(s.find(id) == s.end());
+    s.insert(id);
+    indexes.insert(alloc_type::get_index(id));
+  }
+  CASE_EXPECT_EQ(id_num, indexes.size());
+  CASE_EXPECT_TRUE(alloc_type::get_capacity() >= id_num);
+
+  // index is reused and generation is changed
+  uint64_t last_id = *s.rbegin();
+  alloc_type::deallocate(last_id);
+  uint64_t reuse_id = alloc_type::allocate();
+  CASE_EXPECT_NE(last_id, reuse_id);
+  CASE_EXPECT_EQ(alloc_type::get_index(last_id), alloc_type::get_index(reuse_id));
+  CASE_EXPECT_EQ(alloc_type::get_generation(last_id) + 1, alloc_type::get_generation(reuse_id));
+
+  // deallocate a expired id should do nothing
+  alloc_type::deallocate(last_id);
+  s.erase(last_id);
+  s.insert(reuse_id);
+
+  size_t capacity = alloc_type::get_capacity();
+  for (uint64_t id : s) {
+    alloc_type::deallocate(id);
+  }
+  for (size_t i = 0; i < id_num; ++i) {
+    alloc_type::allocate();
+  }
+  CASE_EXPECT_EQ(capacity, alloc_type::get_capacity());
+}
+
+CASE_TEST(coroutine_task, slot_id_allocator_mt) {
+  using alloc_type = copp::util::uint64_slot_id_allocator;
+
+  // every thread allocates and releases ids repeatedly, and keeps the last round of ids
+  std::unique_ptr<std::thread> thds[8];
+  std::set<uint64_t> s[8];
+  for (int i = 0; i < 8; ++i) {
+    std::set<uint64_t> *sp = &s[i];
+    thds[i].reset(new std::thread([sp]() {
+      size_t id_num = 1000;
+      for (int round = 0; round < 20; ++round) {
+        for (uint64_t id : *sp) {
+          alloc_type::deallocate(id);
+        }
+        sp->clear();
+
+        for (size_t j = 0; j < id_num; ++j) {
+          uint64_t id = alloc_type::allocate();
+          CASE_EXPECT_NE(static_cast<uint64_t>(0), id);
+          sp->insert(id);
+        }
+      }
+    }));
+  }
+
+  std::set<uint32_t> indexes;
+  size_t id_num = 0;
+  for (int i = 0; i < 8; ++i) {
+    thds[i]->join();
+    id_num += s[i].size();
+    for (uint64_t id : s[i]) {
+      indexes.insert(alloc_type::get_index(id));
+    }
+  }
+
+  // living ids never share a slot index
+  CASE_EXPECT_EQ(id_num, indexes.size());
+
+  for (int i = 0; i < 8; ++i) {
+    for (uint64_t id : s[i]) {
+      alloc_type::deallocate(id);
+    }
+  }
+}
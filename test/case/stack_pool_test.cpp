@@ -99,6 +99,56 @@ CASE_TEST(stack_pool_test, full_number) {
   global_stack_pool.reset();
 }
 
+namespace {
+struct stack_pool_test_counter_action {
+  int *counter;
+  size_t index;
+
+  int operator()(void *) {
+    *counter += static_cast<int>(index);
+    return 0;
+  }
+};
+}  // namespace
+
+CASE_TEST(stack_pool_test, create_many) {
+  global_stack_pool = stack_pool_t::create();
+  const size_t task_arr_sz = 64;
+  global_stack_pool->set_max_stack_number(task_arr_sz);
+  global_stack_pool->set_auto_gc(false);
+
+  int counter = 0;
+  copp::allocator::stack_allocator_pool<stack_pool_t> alloc(global_stack_pool);
+  std::vector<stack_pool_test_task_t::ptr_t> task_arr = stack_pool_test_task_t::create_many(
+      task_arr_sz + 16, [&counter](size_t index) { return stack_pool_test_counter_action{&counter, index}; }, alloc);
+
+  // stacks are limited by pool
+  CASE_EXPECT_EQ(task_arr_sz, task_arr.size());
+  CASE_EXPECT_EQ(task_arr_sz, global_stack_pool->get_limit().used_stack_number);
+  CASE_EXPECT_EQ(0, global_stack_pool->get_limit().free_stack_number);
+
+  for (size_t i = 0; i < task_arr.size(); ++i) {
+    CASE_EXPECT_TRUE(!!task_arr[i]);
+    CASE_EXPECT_EQ(0, task_arr[i]->start());
+    CASE_EXPECT_TRUE(task_arr[i]->is_completed());
+  }
+  CASE_EXPECT_EQ(static_cast<int>(task_arr_sz * (task_arr_sz - 1) / 2), counter);
+
+  // stacks are recycled and reused by next batch
+  task_arr.clear();
+  CASE_EXPECT_EQ(0, global_stack_pool->get_limit().used_stack_number);
+  CASE_EXPECT_EQ(task_arr_sz, global_stack_pool->get_limit().free_stack_number);
+
+  task_arr = stack_pool_test_task_t::create_many(
+      task_arr_sz / 2, [&counter](size_t index) { return stack_pool_test_counter_action{&counter, index}; }, alloc);
+  CASE_EXPECT_EQ(task_arr_sz / 2, task_arr.size());
+  CASE_EXPECT_EQ(task_arr_sz / 2, global_stack_pool->get_limit().used_stack_number);
+  CASE_EXPECT_EQ(task_arr_sz / 2, global_stack_pool->get_limit().free_stack_number);
+
+  task_arr.clear();
+  global_stack_pool.reset();
+}
+
 CASE_TEST(stack_pool_test, custom_gc) {
   global_stack_pool = stack_pool_t::create();
   std::vector<stack_pool_test_task_t::ptr_t> task_arr;
@@ -199,4 +249,53 @@ CASE_TEST(stack_pool_test, full_size) {
   CASE_EXPECT_TRUE(!tp2);
 
   global_stack_pool.reset();
-}
\ No newline at end of file
+}
+CASE_TEST(stack_pool_test, reuse_last_released) {
+  stack_pool_t::ptr_t pool = stack_pool_t::create();
+  pool->set_auto_gc(false);
+
+  copp::stack_context stacks[3];
+  for (size_t i = 0; i < 3; ++i) {
+    pool->allocate(stacks[i]);
+    CASE_EXPECT_TRUE(nullptr != stacks[i].sp);
+  }
+  void *first_sp = stacks[0].sp;
+  void *last_sp = stacks[2].sp;
+
+  // free list is stored in the free stacks, the stack context passed in is kept
+  for (size_t i = 0; i < 3; ++i) {
+    pool->deallocate(stacks[i]);
+    CASE_EXPECT_TRUE(nullptr != stacks[i].sp);
+  }
+  CASE_EXPECT_EQ(3, pool->get_limit().free_stack_number);
+  CASE_EXPECT_EQ(0, pool->get_limit().used_stack_number);
+
+  // the most recently released stack is reused first
+  copp::stack_context ctx;
+  pool->allocate(ctx);
+  CASE_EXPECT_EQ(last_sp, ctx.sp);
+  CASE_EXPECT_EQ(2, pool->get_limit().free_stack_number);
+
+  // the oldest stacks are released by gc first
+  pool->set_gc_once_number(1);
+  CASE_EXPECT_EQ(1, pool->gc());
+  CASE_EXPECT_EQ(1, pool->get_limit().free_stack_number);
+
+  copp::stack_context left;
+  pool->allocate(left);
+  CASE_EXPECT_NE(first_sp, left.sp);
+  CASE_EXPECT_EQ(stacks[1].sp, left.sp);
+  CASE_EXPECT_EQ(0, pool->get_limit().free_stack_number);
+
+  pool->deallocate(left);
+  pool->deallocate(ctx);
+  CASE_EXPECT_EQ(2, pool->get_limit().free_stack_number);
+
+  // free list is emptied by clear, so the pool can be used again
+  pool->clear();
+  CASE_EXPECT_EQ(0, pool->get_limit().free_stack_number);
+  pool->allocate(ctx);
+  CASE_EXPECT_TRUE(nullptr != ctx.sp);
+  CASE_EXPECT_EQ(1, pool->get_limit().used_stack_number);
+  pool->deallocate(ctx);
+}
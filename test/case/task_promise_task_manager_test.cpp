@@ -2,12 +2,14 @@
 
 #include <libcopp/coroutine/generator_promise.h>
 #include <libcotask/task_manager.h>
+#include <libcotask/task_manager_sharded.h>
 #include <libcotask/task_promise.h>
 
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "frame/test_macros.h"
 
@@ -395,6 +397,45 @@ CASE_TEST(task_promise_task_manager, kill) {
   task_manager_resume_pending_contexts({});
 }
 
+CASE_TEST(task_promise_task_manager, deferred_reclaim) {
+  {
+    using mgr_t = cotask::task_manager<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create();
+    task_mgr->set_deferred_reclaim(3);
+    CASE_EXPECT_EQ(3, task_mgr->get_deferred_reclaim_backlog());
+
+    std::vector<task_future_int_type> tasks;
+    for (int i = 0; i < 4; ++i) {
+      tasks.push_back(task_func_await_int());
+      CASE_EXPECT_EQ(0, task_mgr->add_task(tasks.back()));
+      CASE_EXPECT_EQ(0, task_mgr->start(tasks.back().get_id()));
+    }
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_EQ(0, task_mgr->kill(tasks[i].get_id()));
+    }
+
+    // the last one is released immediately because the reclaim queue is full
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(3, (int)task_mgr->get_reclaim_size());
+    long use_count = tasks[0].get_context().use_count();
+    CASE_EXPECT_EQ(use_count, tasks[3].get_context().use_count() + 1);
+
+    std::vector<task_future_int_type> detached;
+    CASE_EXPECT_EQ(1, (int)task_mgr->detach_reclaim_batch(detached, 1));
+    CASE_EXPECT_EQ(2, (int)task_mgr->get_reclaim_size());
+    detached.clear();
+
+    CASE_EXPECT_EQ(2, (int)task_mgr->reclaim());
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_reclaim_size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_EQ(use_count - 1, tasks[i].get_context().use_count());
+    }
+  }
+
+  task_manager_resume_pending_contexts({});
+}
+
 CASE_TEST(task_promise_task_manager, duplicated_checkpoints) {
   {
     size_t old_resume_generator_count = g_task_manager_future_resume_generator_count;
@@ -467,6 +508,197 @@ CASE_TEST(task_promise_task_manager, update_timeout) {
   task_manager_resume_pending_contexts({});
 }
 
+CASE_TEST(task_promise_task_manager, timer_wheel) {
+  {
+    size_t old_resume_generator_count = g_task_manager_future_resume_generator_count;
+    size_t old_suspend_generator_count = g_task_manager_future_suspend_generator_count;
+    using mgr_t = cotask::task_manager<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create();
+    task_mgr->tick(4);
+
+    // tick is already started, the timing wheel starts from last tick time
+    CASE_EXPECT_EQ(copp::COPP_EC_ARGS_ERROR, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config(1000, 8, 0)));
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config(1000, 4, 3)));
+    CASE_EXPECT_TRUE(task_mgr->is_timer_wheel_enabled());
+
+    task_future_int_type co_task = task_func_await_int();
+    task_future_int_type co_another_task = task_func_await_int();
+    co_task.start();
+    co_another_task.start();
+
+    task_mgr->add_task(co_task, 10, 0);
+    task_mgr->add_task(co_another_task, 10, 0);
+    CASE_EXPECT_EQ(copp::COPP_EC_IS_RUNNING, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+    CASE_EXPECT_EQ(2, (int)task_mgr->get_tick_checkpoint_size());
+
+    task_mgr->tick(5);
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timeout(co_task.get_id(), 20, 0));
+    CASE_EXPECT_EQ(2, (int)task_mgr->get_tick_checkpoint_size());
+
+    task_mgr->tick(14, 1000);
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_tick_checkpoint_size());
+    CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kTimeout == co_another_task.get_status());
+
+    task_mgr->tick(24, 1000);
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+
+    task_mgr->tick(25, 1000);
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_tick_checkpoint_size());
+    CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kTimeout == co_task.get_status());
+
+    CASE_EXPECT_EQ(old_resume_generator_count + 2, g_task_manager_future_resume_generator_count);
+    CASE_EXPECT_EQ(old_suspend_generator_count + 2, g_task_manager_future_suspend_generator_count);
+  }
+  task_manager_resume_pending_contexts({});
+}
+
+CASE_TEST(task_promise_task_manager, timeout_batch) {
+  {
+    using mgr_t = cotask::task_manager<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create();
+    task_mgr->tick(5);
+
+    // more than one batch
+    std::vector<task_future_int_type> tasks;
+    for (int i = 0; i < 1000; ++i) {
+      tasks.push_back(task_func_await_int());
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->add_task(tasks.back(), 1 + (i & 1), 0));
+    }
+
+    size_t pending_count = 0;
+    task_mgr->tick(7, 0, 300, &pending_count);
+    CASE_EXPECT_EQ(700, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(200), pending_count);
+
+    task_mgr->tick(7);
+    CASE_EXPECT_EQ(500, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(500, (int)task_mgr->get_tick_checkpoint_size());
+
+    task_mgr->tick(8);
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_tick_checkpoint_size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kTimeout == tasks[i].get_status());
+    }
+  }
+  task_manager_resume_pending_contexts({});
+}
+
+CASE_TEST(task_promise_task_manager, ready_queue) {
+  {
+    size_t old_resume_generator_count = g_task_manager_future_resume_generator_count;
+    size_t old_suspend_generator_count = g_task_manager_future_suspend_generator_count;
+    using mgr_t = cotask::task_manager_sharded<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create(2);
+
+    std::vector<task_future_int_type> tasks;
+    for (int i = 0; i < 8; ++i) {
+      tasks.push_back(task_func_await_int());
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->add_task(tasks.back()));
+    }
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[i].get_id()));
+    }
+    CASE_EXPECT_EQ(static_cast<size_t>(8), task_mgr->get_ready_size());
+
+    CASE_EXPECT_EQ(static_cast<size_t>(3), task_mgr->run_ready(3));
+    CASE_EXPECT_EQ(static_cast<size_t>(5), task_mgr->get_ready_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(1), task_mgr->get_ready_class_count());
+    CASE_EXPECT_EQ(3, (int)task_mgr->get_ready_class_stats(0).run_count);
+    CASE_EXPECT_EQ(8, (int)task_mgr->get_ready_class_stats(0).mark_count);
+    CASE_EXPECT_EQ(old_suspend_generator_count + 3, g_task_manager_future_suspend_generator_count);
+
+    // started tasks are skipped
+    CASE_EXPECT_EQ(static_cast<size_t>(5), task_mgr->run_ready());
+    CASE_EXPECT_EQ(static_cast<size_t>(0), task_mgr->get_ready_size());
+    CASE_EXPECT_EQ(old_suspend_generator_count + 8, g_task_manager_future_suspend_generator_count);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->mark_ready(tasks[i].get_id()));
+    }
+    CASE_EXPECT_EQ(static_cast<size_t>(8), task_mgr->run_ready());
+    CASE_EXPECT_EQ(old_suspend_generator_count + 8, g_task_manager_future_suspend_generator_count);
+
+    task_manager_resume_pending_contexts({});
+    CASE_EXPECT_EQ(old_resume_generator_count + 8, g_task_manager_future_resume_generator_count);
+#    if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+#    endif
+  }
+  task_manager_resume_pending_contexts({});
+}
+
+CASE_TEST(task_promise_task_manager, sharded) {
+  {
+    size_t old_resume_generator_count = g_task_manager_future_resume_generator_count;
+    size_t old_suspend_generator_count = g_task_manager_future_suspend_generator_count;
+    using mgr_t = cotask::task_manager_sharded<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create(4);
+
+    std::vector<task_future_int_type> tasks;
+    for (int i = 0; i < 16; ++i) {
+      tasks.push_back(task_func_await_int());
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->add_task(tasks.back(), 10, 0));
+    }
+    CASE_EXPECT_EQ(16, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(16, (int)task_mgr->get_tick_checkpoint_size());
+
+    CASE_EXPECT_TRUE(nullptr != task_mgr->find_task(tasks[0].get_id()));
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->start(tasks[0].get_id()));
+    CASE_EXPECT_EQ(16, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->cancel(tasks[1].get_id()));
+    CASE_EXPECT_EQ(15, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->kill(tasks[2].get_id()));
+    CASE_EXPECT_EQ(14, (int)task_mgr->get_task_size());
+
+    task_mgr->tick(5);
+    task_mgr->tick(15, 1);
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_tick_checkpoint_size());
+    CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kTimeout == tasks[0].get_status());
+    CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kCancle == tasks[1].get_status());
+    CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kKilled == tasks[2].get_status());
+
+    CASE_EXPECT_EQ(old_resume_generator_count + 1, g_task_manager_future_resume_generator_count);
+    CASE_EXPECT_EQ(old_suspend_generator_count + 1, g_task_manager_future_suspend_generator_count);
+  }
+  task_manager_resume_pending_contexts({});
+}
+
+CASE_TEST(task_promise_task_manager, sharded_tick_with_max_expire) {
+  {
+    using mgr_t = cotask::task_manager_sharded<task_future_int_type>;
+    mgr_t::ptr_type task_mgr = mgr_t::create(4);
+    CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->set_timer_wheel(cotask::task_timer_wheel_config()));
+
+    std::vector<task_future_int_type> tasks;
+    for (int i = 0; i < 16; ++i) {
+      tasks.push_back(task_func_await_int());
+      CASE_EXPECT_EQ(copp::COPP_EC_SUCCESS, task_mgr->add_task(tasks.back(), 10, 0));
+    }
+    task_mgr->tick(5);
+
+    // budget is shared by all shards
+    size_t pending_count = 0;
+    task_mgr->tick(15, 1000000, 5, &pending_count);
+    CASE_EXPECT_EQ(11, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(11), pending_count);
+
+    task_mgr->tick(15, 1000000, 10, &pending_count);
+    CASE_EXPECT_EQ(1, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(1), pending_count);
+
+    task_mgr->tick(15, 1000000, 10, &pending_count);
+    CASE_EXPECT_EQ(0, (int)task_mgr->get_task_size());
+    CASE_EXPECT_EQ(static_cast<size_t>(0), pending_count);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      CASE_EXPECT_TRUE(task_future_int_type::task_status_type::kTimeout == tasks[i].get_status());
+    }
+  }
+  task_manager_resume_pending_contexts({});
+}
+
 // TODO: thread safety check
 
 #    if defined(LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER) && LIBCOTASK_MACRO_AUTO_CLEANUP_MANAGER